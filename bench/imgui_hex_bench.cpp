@@ -0,0 +1,313 @@
+// Headless benchmark of BeginHexEditor(). Runs without a backend, window or GPU: the font atlas is built, frames go
+// through NewFrame()/Render() and the draw data is never presented.
+//
+// Build from the repository root with Dear ImGui (1.90 or later) checked out next to it:
+//   I=../imgui
+//   c++ -std=c++11 -O2 -I. -I$I bench/imgui_hex_bench.cpp imgui_hex.cpp $I/imgui.cpp $I/imgui_draw.cpp $I/imgui_tables.cpp $I/imgui_widgets.cpp -pthread -o imgui_hex_bench
+//   ./imgui_hex_bench [frames] [scenario name filter]
+//
+// Add -DIMGUI_HEX_EDITOR_ENABLE_STATS to both files to also print the time spent in every phase of the editor.
+
+#include "imgui_hex.h"
+#include <imgui.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+static const ImS64 BenchBytesSize = 256 * 1024 * 1024;
+static unsigned char* BenchBytes = nullptr;
+static ImS64 BenchAllocations = 0;
+
+static void* BenchAlloc(size_t size, void* user_data)
+{
+	IM_UNUSED(user_data);
+	BenchAllocations++;
+	return malloc(size);
+}
+
+static void BenchFree(void* ptr, void* user_data)
+{
+	IM_UNUSED(user_data);
+	free(ptr);
+}
+
+static double GetBenchTime()
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static ImS64 ReadBenchBytes(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size)
+{
+	IM_UNUSED(state);
+	if (size > BenchBytesSize - offset)
+		size = BenchBytesSize - offset;
+
+	memcpy(buf, BenchBytes + offset, (size_t)size);
+	return size;
+}
+
+// Stands in for ReadProcessMemory() and similar calls which take a few microseconds each
+static ImS64 ReadBenchBytesSlow(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size)
+{
+	const double end = GetBenchTime() + 20000.0;
+	while (GetBenchTime() < end)
+	{
+	}
+
+	return ReadBenchBytes(state, offset, buf, size);
+}
+
+static ImGuiHexEditorHighlightFlags BenchSingleHighlight(ImGuiHexEditorState* state, ImS64 offset, ImColor* color, ImColor* text_color, ImColor* border_color)
+{
+	IM_UNUSED(state);
+	IM_UNUSED(text_color);
+	IM_UNUSED(border_color);
+
+	if ((offset / 7) % 3 != 0)
+		return ImGuiHexEditorHighlightFlags_None;
+
+	*color = ImColor(0.2f, 0.6f, 0.9f);
+	return ImGuiHexEditorHighlightFlags_Apply | ImGuiHexEditorHighlightFlags_TextAutomaticContrast | ImGuiHexEditorHighlightFlags_Ascii
+		| ImGuiHexEditorHighlightFlags_Border | ImGuiHexEditorHighlightFlags_BorderAutomaticContrast;
+}
+
+// Same bytes as BenchSingleHighlight(), as one range per run of 7 bytes
+static void BenchHighlightRanges(ImGuiHexEditorState* state, ImS64 display_start, ImS64 display_end, ImVector<ImGuiHexEditorHighlightRange>* out_ranges)
+{
+	IM_UNUSED(state);
+
+	ImGuiHexEditorHighlightRange range;
+	range.Color = ImColor(0.2f, 0.6f, 0.9f);
+	range.BorderColor = ImColor(0.f, 0.f, 0.f, 0.f);
+	range.Flags = ImGuiHexEditorHighlightFlags_Apply | ImGuiHexEditorHighlightFlags_TextAutomaticContrast | ImGuiHexEditorHighlightFlags_Ascii
+		| ImGuiHexEditorHighlightFlags_Border | ImGuiHexEditorHighlightFlags_BorderAutomaticContrast;
+
+	for (ImS64 run = display_start / 21 * 21; run < display_end; run += 21)
+	{
+		range.From = run;
+		range.To = run + 6;
+		out_ranges->push_back(range);
+	}
+}
+
+static void SetupLargeBuffer(ImGuiHexEditorState* state)
+{
+	IM_UNUSED(state);
+}
+
+static void SetupHighlightRanges(ImGuiHexEditorState* state)
+{
+	ImU32 seed = 12345;
+	for (int i = 0; i != 10000; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+
+		ImGuiHexEditorHighlightRange range;
+		range.From = (ImS64)(seed % (BenchBytesSize / 16)) * 16;
+		range.To = range.From + (seed >> 24) % 96;
+		range.Color = ImColor((int)(seed & 0xff), (int)((seed >> 8) & 0xff), 160);
+		range.BorderColor = ImColor(255, 255, 255);
+		range.Flags = ImGuiHexEditorHighlightFlags_Apply | ImGuiHexEditorHighlightFlags_Ascii | ImGuiHexEditorHighlightFlags_Border
+			| ImGuiHexEditorHighlightFlags_TextAutomaticContrast;
+		state->HighlightRanges.push_back(range);
+	}
+
+	state->HighlightRangesVersion = 0;
+}
+
+static void SetupSingleHighlight(ImGuiHexEditorState* state)
+{
+	state->SingleHighlightCallback = BenchSingleHighlight;
+}
+
+static void SetupHighlightRangesCallback(ImGuiHexEditorState* state)
+{
+	state->HighlightRangesCallback = BenchHighlightRanges;
+}
+
+static void SetupBorderedSelection(ImGuiHexEditorState* state)
+{
+	state->SelectStartByte = 0x107;
+	state->SelectEndByte = BenchBytesSize - 0x107;
+	state->LastSelectedByte = state->SelectStartByte;
+	state->SelectionHighlightFlags |= ImGuiHexEditorHighlightFlags_Border;
+}
+
+static void SetupSlowReadCallback(ImGuiHexEditorState* state)
+{
+	state->ReadCallback = ReadBenchBytesSlow;
+}
+
+static void SetupWideLines(ImGuiHexEditorState* state)
+{
+	state->BytesPerLine = 256;
+	state->ReadCallback = ReadBenchBytes;
+}
+
+static void SetupRowCache(ImGuiHexEditorState* state)
+{
+	state->RowCache = ImGui::CreateHexEditorRowCache();
+	SetupHighlightRanges(state);
+}
+
+static void SetupTemplate(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorTemplate* tpl = ImGui::CreateHexEditorTemplate();
+	const ImGuiHexEditorFieldType record = ImGui::AddHexEditorTemplateStruct(tpl, "Record");
+	ImGui::AddHexEditorTemplateField(tpl, record, "id", ImGuiHexEditorFieldType_U32);
+	ImGui::AddHexEditorTemplateField(tpl, record, "flags", ImGuiHexEditorFieldType_U16, 1, ImGuiHexEditorFieldFlags_Hex);
+	ImGui::AddHexEditorTemplateField(tpl, record, "kind", ImGuiHexEditorFieldType_U16);
+	ImGui::AddHexEditorTemplateField(tpl, record, "weight", ImGuiHexEditorFieldType_Float);
+	ImGui::AddHexEditorTemplateField(tpl, record, "tag", ImGuiHexEditorFieldType_Char, 4);
+
+	// 16 bytes per record, 5 field instances each
+	ImGui::CompileHexEditorTemplate(tpl, state, record, 0, 200000);
+	state->Template = tpl;
+}
+
+static void SetupMinimap(ImGuiHexEditorState* state)
+{
+	ImGui::StartHexEditorMinimap(state);
+	SetupHighlightRanges(state);
+}
+
+struct BenchScenario
+{
+	const char* Name;
+	void(*Setup)(ImGuiHexEditorState* state);
+};
+
+static const BenchScenario BenchScenarios[] =
+{
+	{ "large buffer", SetupLargeBuffer },
+	{ "10k highlight ranges", SetupHighlightRanges },
+	{ "single highlight callback", SetupSingleHighlight },
+	{ "highlight ranges callback", SetupHighlightRangesCallback },
+	{ "bordered selection", SetupBorderedSelection },
+	{ "slow read callback", SetupSlowReadCallback },
+	{ "256 bytes per line", SetupWideLines },
+	{ "row cache", SetupRowCache },
+	{ "1M template fields", SetupTemplate },
+	{ "minimap", SetupMinimap },
+};
+
+static void RunBenchScenario(const BenchScenario& scenario, int frames)
+{
+	ImGuiHexEditorState state;
+	state.Bytes = BenchBytes;
+	state.MaxBytes = BenchBytesSize;
+	scenario.Setup(&state);
+
+	const int warmup_frames = 10;
+	double frame_time = 0.0;
+	double editor_time = 0.0;
+	ImS64 vertices = 0;
+	ImS64 indices = 0;
+	ImS64 allocations = 0;
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	ImGuiHexEditorStats stats_sum;
+#endif
+
+	for (int frame = 0; frame != warmup_frames + frames; frame++)
+	{
+		const bool measured = frame >= warmup_frames;
+		const ImS64 allocations_start = BenchAllocations;
+		const double frame_start = GetBenchTime();
+
+		ImGui::NewFrame();
+
+		const ImGuiIO& io = ImGui::GetIO();
+		ImGui::SetNextWindowPos({ 0.f, 0.f });
+		ImGui::SetNextWindowSize(io.DisplaySize);
+		ImGui::Begin("Bench", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+
+		const double editor_start = GetBenchTime();
+		if (state.Minimap)
+		{
+			ImGui::ShowHexEditorMinimap("##Minimap", &state);
+			ImGui::SameLine();
+		}
+
+		if (ImGui::BeginHexEditor("##HexEditor", &state))
+		{
+			// Scroll a few lines every frame so new rows are read and laid out
+			const float scroll_y = ImGui::GetScrollY() + ImGui::GetTextLineHeightWithSpacing() * 3.f;
+			ImGui::SetScrollY(scroll_y < ImGui::GetScrollMaxY() ? scroll_y : 0.f);
+		}
+		ImGui::EndHexEditor();
+		const double editor_end = GetBenchTime();
+
+		ImGui::End();
+		ImGui::Render();
+
+		const double frame_end = GetBenchTime();
+		if (!measured)
+			continue;
+
+		frame_time += frame_end - frame_start;
+		editor_time += editor_end - editor_start;
+		vertices += ImGui::GetDrawData()->TotalVtxCount;
+		indices += ImGui::GetDrawData()->TotalIdxCount;
+		allocations += BenchAllocations - allocations_start;
+
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+		stats_sum.InputTime += state.Stats.InputTime;
+		stats_sum.ReadTime += state.Stats.ReadTime;
+		stats_sum.DecorationTime += state.Stats.DecorationTime;
+		stats_sum.TextTime += state.Stats.TextTime;
+		stats_sum.SourceReads += state.Stats.SourceReads;
+#endif
+	}
+
+	ImGui::DestroyHexEditorRowCache(state.RowCache);
+	ImGui::DestroyHexEditorTemplate(state.Template);
+	ImGui::StopHexEditorMinimap(&state);
+
+	printf("%-28s %12.0f %12.0f %10lld %10lld %8.1f\n", scenario.Name, frame_time / frames, editor_time / frames,
+		(long long)(vertices / frames), (long long)(indices / frames), (double)allocations / frames);
+
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	printf("%-28s input %.4f ms, read %.4f ms (%d source reads), decoration %.4f ms, text %.4f ms\n", "",
+		stats_sum.InputTime / frames, stats_sum.ReadTime / frames, stats_sum.SourceReads / frames, stats_sum.DecorationTime / frames, stats_sum.TextTime / frames);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+	const int frames = argc > 1 ? atoi(argv[1]) : 500;
+	const char* filter = argc > 2 ? argv[2] : nullptr;
+
+	BenchBytes = (unsigned char*)malloc((size_t)BenchBytesSize);
+	ImU32 seed = 1;
+	for (ImS64 i = 0; i != BenchBytesSize; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		BenchBytes[i] = (i & 0x30) ? (unsigned char)(seed >> 24) : 0x00;
+	}
+
+	ImGui::SetAllocatorFunctions(BenchAlloc, BenchFree);
+	ImGui::CreateContext();
+
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize = { 1920.f, 1080.f };
+	io.DeltaTime = 1.f / 60.f;
+	io.IniFilename = nullptr;
+
+	unsigned char* pixels;
+	int width, height;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+	printf("%d frames at %.0fx%.0f\n", frames, io.DisplaySize.x, io.DisplaySize.y);
+	printf("%-28s %12s %12s %10s %10s %8s\n", "scenario", "ns/frame", "editor ns", "vertices", "indices", "allocs");
+
+	for (const BenchScenario& scenario : BenchScenarios)
+	{
+		if (!filter || strstr(scenario.Name, filter))
+			RunBenchScenario(scenario, frames);
+	}
+
+	ImGui::DestroyContext();
+	free(BenchBytes);
+	return 0;
+}
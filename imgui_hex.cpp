@@ -2,13 +2,55 @@
 #include <imgui.h>
 #include <imgui_internal.h>
 #include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#if !defined(IMGUI_HEX_EDITOR_SSE2) && !defined(IMGUI_HEX_EDITOR_DISABLE_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMGUI_HEX_EDITOR_SSE2
+#endif
+
+#ifdef IMGUI_HEX_EDITOR_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+// Stats of the editor being rendered, only set on the rendering thread while BeginHexEditor() runs
+static thread_local ImGuiHexEditorStats* GHexEditorStats = nullptr;
 
-static char HalfByteToPrintable(unsigned char half_byte, bool lower)
+static double GetStatsTime()
 {
-	IM_ASSERT(!(half_byte & 0xf0));
-	return half_byte <= 9 ? '0' + half_byte : (lower ? 'a' : 'A') + half_byte - 10;
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
+#define IMGUI_HEX_EDITOR_STAT(_EXPR) do { if (GHexEditorStats) GHexEditorStats->_EXPR; } while (0)
+#define IMGUI_HEX_EDITOR_STAT_TIME(_NAME) const double _NAME = GetStatsTime()
+#else
+#define IMGUI_HEX_EDITOR_STAT(_EXPR) do { } while (0)
+#define IMGUI_HEX_EDITOR_STAT_TIME(_NAME) do { } while (0)
+#endif
+
 static unsigned char KeyToHalfByte(ImGuiKey key)
 {
 	IM_ASSERT((key >= ImGuiKey_A && key <= ImGuiKey_F) || (key >= ImGuiKey_0 && key <= ImGuiKey_9));
@@ -20,17 +62,134 @@ static bool HasAsciiRepresentation(unsigned char byte)
 	return (byte >= '!' && byte <= '~');
 }
 
-static int CalcBytesPerLine(float bytes_avail_x, const ImVec2& byte_size, const ImVec2& spacing, bool show_ascii, const ImVec2& char_size, int separators)
+#ifdef IMGUI_HEX_EDITOR_SSE2
+// Hex digits of 16 bytes, high nibble first: pairs of the first 8 bytes in first, the rest in second
+static void ExpandHexNibbles(__m128i bytes, bool lowercase, __m128i* first, __m128i* second)
 {
-	const float byte_width = byte_size.x + spacing.x + (show_ascii ? char_size.x : 0.f);
-	int bytes_per_line = (int)(bytes_avail_x / byte_width);
-	bytes_per_line = bytes_per_line <= 0 ? 1 : bytes_per_line;
+	const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i letters = _mm_set1_epi8((char)((lowercase ? 'a' : 'A') - '0' - 10));
+
+	const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble_mask);
+	const __m128i low = _mm_and_si128(bytes, nibble_mask);
+	const __m128i high_digits = _mm_add_epi8(_mm_add_epi8(high, zero), _mm_and_si128(_mm_cmpgt_epi8(high, nine), letters));
+	const __m128i low_digits = _mm_add_epi8(_mm_add_epi8(low, zero), _mm_and_si128(_mm_cmpgt_epi8(low, nine), letters));
+
+	*first = _mm_unpacklo_epi8(high_digits, low_digits);
+	*second = _mm_unpackhi_epi8(high_digits, low_digits);
+}
+#endif
 
-	int actual_separators = separators > 0 ? (int)(bytes_per_line / separators) : 0;
-	if (actual_separators != 0 && separators > 0 && bytes_per_line > actual_separators && (bytes_per_line - 1) % actual_separators == 0)
-		--actual_separators;
-	
-	return separators > 0 ? CalcBytesPerLine(bytes_avail_x - (actual_separators * spacing.x), byte_size, spacing, show_ascii, char_size, 0) : bytes_per_line;
+// Text of a row of bytes, shared by rendering and export: the hex digits of size bytes, high nibble first, into out_hex
+// (2 * size characters) and their ascii column into out_ascii (size characters, '.' for bytes without an ascii
+// representation) unless it's nullptr. Nothing is terminated. 16 bytes at a time with SSE2
+static void FormatHexRow(const unsigned char* data, int size, bool lowercase, char* out_hex, char* out_ascii)
+{
+	int i = 0;
+#ifdef IMGUI_HEX_EDITOR_SSE2
+	// '!' to '~' are moved to the bottom of the signed range, so a single compare finds them
+	const __m128i printable_bias = _mm_set1_epi8((char)(0x80 - '!'));
+	const __m128i printable_end = _mm_set1_epi8((char)(0x80 - '!' + '~' + 1));
+	const __m128i dots = _mm_set1_epi8('.');
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+
+		__m128i first, second;
+		ExpandHexNibbles(bytes, lowercase, &first, &second);
+		_mm_storeu_si128((__m128i*)(out_hex + i * 2), first);
+		_mm_storeu_si128((__m128i*)(out_hex + i * 2 + 16), second);
+
+		if (out_ascii)
+		{
+			const __m128i printable = _mm_cmplt_epi8(_mm_add_epi8(bytes, printable_bias), printable_end);
+			_mm_storeu_si128((__m128i*)(out_ascii + i), _mm_or_si128(_mm_and_si128(printable, bytes), _mm_andnot_si128(printable, dots)));
+		}
+	}
+#endif
+
+	const char* digits = lowercase ? "0123456789abcdef" : "0123456789ABCDEF";
+	for (; i < size; i++)
+	{
+		const unsigned char byte = data[i];
+		out_hex[i * 2] = digits[byte >> 4];
+		out_hex[i * 2 + 1] = digits[byte & 0x0f];
+		if (out_ascii)
+			out_ascii[i] = HasAsciiRepresentation(byte) ? (char)byte : '.';
+	}
+}
+
+// Bytes between two separators, a multiple of the cell size so separators only fall between cells. 0 without separators
+static int CalcSeparatorBytes(int separators, int cell_bytes)
+{
+	if (separators <= 0)
+		return 0;
+
+	int separator_bytes = separators;
+	while (separator_bytes % cell_bytes != 0)
+		separator_bytes += separators;
+
+	return separator_bytes;
+}
+
+static int CalcBytesPerLine(float bytes_avail_x, const ImVec2& cell_size, int cell_bytes, const ImVec2& spacing, bool show_ascii, const ImVec2& char_size, int separator_bytes)
+{
+	const float cell_width = cell_size.x + spacing.x + (show_ascii ? char_size.x * cell_bytes : 0.f);
+	int cells_per_line = (int)(bytes_avail_x / cell_width);
+	cells_per_line = cells_per_line <= 0 ? 1 : cells_per_line;
+
+	// Separators between the cells take the room of some of them
+	while (cells_per_line > 1)
+	{
+		const int separators_count = separator_bytes > 0 ? (cells_per_line * cell_bytes - 1) / separator_bytes : 0;
+		if (cells_per_line * cell_width + separators_count * spacing.x <= bytes_avail_x)
+			break;
+
+		--cells_per_line;
+	}
+
+	return cells_per_line * cell_bytes;
+}
+
+// Offsets of every byte of a row relative to the first one, laid out like BeginHexEditor() advances its cursor. Bytes of
+// the same cell share its offset
+static void CalcByteOffsetsX(ImVector<float>& out, int bytes_per_line, int cell_bytes, float cell_width, float spacing, int separator_bytes)
+{
+	out.resize(bytes_per_line);
+
+	float x = 0.f;
+	for (int i = 0; i < bytes_per_line; i += cell_bytes)
+	{
+		for (int j = i; j != i + cell_bytes && j != bytes_per_line; j++)
+			out[j] = x;
+
+		x += cell_width + spacing;
+		if (separator_bytes > 0 && (i + cell_bytes) % separator_bytes == 0 && i + cell_bytes < bytes_per_line)
+			x += spacing;
+	}
+}
+
+// Returns the byte whose item rect (the cell and half of the spacing around it) contains x, the last one of multi-byte
+// cells, or -1
+static int FindByteColumn(const ImVector<float>& byte_offsets_x, float x, float cell_width, float spacing)
+{
+	int lo = 0;
+	int hi = byte_offsets_x.Size;
+	while (lo < hi)
+	{
+		const int mid = (lo + hi) / 2;
+		if (byte_offsets_x[mid] - spacing * 0.5f <= x)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	const int column = lo - 1;
+	if (column < 0 || x >= byte_offsets_x[column] + cell_width + spacing * 0.5f)
+		return -1;
+
+	return column;
 }
 
 static ImColor CalcContrastColor(ImColor color)
@@ -44,7 +203,7 @@ static ImColor CalcContrastColor(ImColor color)
 	return IM_COL32(c, c, c, 255);
 }
 
-static bool RangeRangeIntersection(int a_min, int a_max, int b_min, int b_max, int* out_min, int* out_max)
+static bool RangeRangeIntersection(ImS64 a_min, ImS64 a_max, ImS64 b_min, ImS64 b_max, ImS64* out_min, ImS64* out_max)
 {
 	if (a_max < b_min || b_max < a_min)
 		return false;
@@ -58,887 +217,8068 @@ static bool RangeRangeIntersection(int a_min, int a_max, int b_min, int b_max, i
 	return false;
 }
 
-static void RenderRectCornerCalcRounding(const ImVec2& ra, const ImVec2& rb, float& rounding)
+enum ImGuiHexEditorPageState_ : int
 {
-	rounding = ImMin(rounding, ImFabs(rb.x - ra.x) * 0.5f);
-	rounding = ImMin(rounding, ImFabs(rb.y - ra.y) * 0.5f);
-}
+	ImGuiHexEditorPageState_Free,
+	ImGuiHexEditorPageState_Queued,
+	ImGuiHexEditorPageState_Loading,
+	ImGuiHexEditorPageState_Ready,
+};
 
-static void RenderTopLeftCornerRect(ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, ImColor color, float rounding)
+struct ImGuiHexEditorPage
 {
-	const ImVec2 ra = { a.x + 0.5f, a.y + 0.5f };
-	const ImVec2 rb = { b.x, b.y };
-
-	RenderRectCornerCalcRounding(ra, rb, rounding);
-
-	draw_list->PathArcToFast({ ra.x, rb.y }, 0, 3, 6);
-	draw_list->PathArcToFast({ ra.x + rounding, ra.y + rounding }, rounding, 6, 9);
-	draw_list->PathArcToFast({ rb.x , ra.y }, 0, 9, 12);
+	ImS64 Index;
+	unsigned char* Data;
+	ImS64 Size; // Bytes actually read, shorter than the page size at the end of the source or on failed reads
+	int State;
+	bool Stale; // Written or invalidated while loading, reloaded once the current read finishes
+	int LastFrame;
+	ImU64 LastUse;
+};
+
+// Pages are claimed by the threads calling BeginHexEditor, the prefetch thread only reads into pages it pops from Queue
+// and job threads only copy ready pages. Everything but the data of loading pages is guarded by Mutex.
+struct ImGuiHexEditorPageCache
+{
+	ImGuiHexEditorPageCacheConfig Config;
+	int PageShift;
+	int RefCount = 1; // States and owners sharing the cache, see ImGui::SetHexEditorPageCache()
+	ImVector<ImGuiHexEditorPage> Pages; // Fixed amount of slots, never reallocated after creation
+	ImVector<ImGuiHexEditorPage*> Lookup; // Pages with a source index, sorted by index
+	ImVector<ImGuiHexEditorPage*> Queue; // Reserved to the slot count, so the prefetch thread never allocates. Back is served first
+	ImVector<ImGuiHexEditorPage*> ReadPages; // Adjacent pages loaded by the current read, reserved to MaxReadPages
+	unsigned char* ReadBuffer = nullptr; // Destination of reads of more than one page
+	int MaxReadPages;
+	ImU64 UseCounter = 0;
+
+	std::mutex Mutex;
+	std::condition_variable Cond;
+	std::thread Thread;
+	bool Quit = false;
+};
+
+static int FindPageLookupIndex(ImGuiHexEditorPageCache* cache, ImS64 index)
+{
+	int lo = 0;
+	int hi = cache->Lookup.Size;
+	while (lo < hi)
+	{
+		const int mid = (lo + hi) / 2;
+		if (cache->Lookup[mid]->Index < index)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
 
-	draw_list->PathStroke(color, ImDrawFlags_None, 1.f);
+	return lo;
 }
 
-static void RenderBottomRightCornerRect(ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, ImColor color, float rounding)
+static ImGuiHexEditorPage* FindPage(ImGuiHexEditorPageCache* cache, ImS64 index)
 {
-	const ImVec2 ra = { a.x, a.y + 0.5f };
-	const ImVec2 rb = { b.x - 0.5f, b.y + 0.5f };
-
-	RenderRectCornerCalcRounding(ra, rb, rounding);
-
-	draw_list->PathArcToFast({ rb.x, ra.y }, 0, 9, 12);
-	draw_list->PathArcToFast({ rb.x - rounding, rb.y - rounding }, rounding, 0, 3);
-	draw_list->PathArcToFast({ ra.x, rb.y }, 0, 3, 6);
+	const int i = FindPageLookupIndex(cache, index);
+	return i < cache->Lookup.Size && cache->Lookup[i]->Index == index ? cache->Lookup[i] : nullptr;
+}
 
-	draw_list->PathStroke(color, ImDrawFlags_None, 1.f);
+static void RemoveQueuedPage(ImGuiHexEditorPageCache* cache, ImGuiHexEditorPage* page)
+{
+	for (int i = 0; i != cache->Queue.Size; i++)
+	{
+		if (cache->Queue[i] == page)
+		{
+			cache->Queue.erase(cache->Queue.Data + i);
+			return;
+		}
+	}
 }
 
-static void RenderTopRightCornerRect(ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, ImColor color, float rounding)
+static void FreePage(ImGuiHexEditorPageCache* cache, ImGuiHexEditorPage* page)
 {
-	const ImVec2 ra = { a.x + 0.5f, a.y + 0.5f };
-	const ImVec2 rb = { b.x - 0.5f, b.y };
+	IM_ASSERT(page->State != ImGuiHexEditorPageState_Loading);
 
-	RenderRectCornerCalcRounding(ra, rb, rounding);
+	if (page->State == ImGuiHexEditorPageState_Queued)
+		RemoveQueuedPage(cache, page);
 
-	draw_list->PathArcToFast(ra, 0.f, 6, 9);
-	draw_list->PathArcToFast({ rb.x - rounding, ra.y + rounding }, rounding, 9, 12);
-	draw_list->PathArcToFast(rb, 0.f, 0, 3);
+	const int i = FindPageLookupIndex(cache, page->Index);
+	IM_ASSERT(i < cache->Lookup.Size && cache->Lookup[i] == page);
+	cache->Lookup.erase(cache->Lookup.Data + i);
 
-	draw_list->PathStroke(color, ImDrawFlags_None, 1.f);
+	page->State = ImGuiHexEditorPageState_Free;
+	page->Index = -1;
+	page->Size = 0;
 }
 
-static void RenderBottomLeftCornerRect(ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, ImColor color, float rounding)
+// Must be called with the mutex held. Pages used during the current frame are never reused, returns nullptr when
+// the budget is entirely taken by them. Prefetched pages don't count as used, so they can be reused in the same frame.
+static ImGuiHexEditorPage* ClaimPage(ImGuiHexEditorPageCache* cache, ImS64 index, int frame, bool prefetch)
 {
-	const ImVec2 ra = { a.x + 0.5f, a.y + 0.5f };
-	const ImVec2 rb = { b.x + 0.5f, b.y + 0.5f };
+	ImGuiHexEditorPage* victim = nullptr;
+	for (ImGuiHexEditorPage& page : cache->Pages)
+	{
+		if (page.State == ImGuiHexEditorPageState_Free)
+		{
+			victim = &page;
+			break;
+		}
 
-	RenderRectCornerCalcRounding(ra, rb, rounding);
+		if (page.State == ImGuiHexEditorPageState_Loading || page.LastFrame == frame)
+			continue;
 
-	draw_list->PathArcToFast({ rb.x, rb.y }, 0.f, 0, 3);
-	draw_list->PathArcToFast({ ra.x + rounding, rb.y - rounding }, rounding, 3, 6);
-	draw_list->PathArcToFast({ ra.x, ra.y }, 0.f, 9, 12);
-	
-	draw_list->PathStroke(color, ImDrawFlags_None, 1.f);
-}
+		if (!victim || page.LastUse < victim->LastUse)
+			victim = &page;
+	}
 
-static void RenderBottomCornerRect(ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, ImColor color, float rounding)
-{
+	if (!victim)
+		return nullptr;
 
-	const ImVec2 ra = { a.x + 0.5f, a.y + 0.5f };
-	const ImVec2 rb = { b.x + 0.5f, b.y + 0.5f };
+	if (victim->State != ImGuiHexEditorPageState_Free)
+		FreePage(cache, victim);
+
+	if (!victim->Data)
+	{
+		victim->Data = (unsigned char*)IM_ALLOC((size_t)cache->Config.PageSize);
+		if (!victim->Data)
+			return nullptr;
+	}
 
-	RenderRectCornerCalcRounding(ra, rb, rounding);
+	victim->Index = index;
+	victim->State = ImGuiHexEditorPageState_Queued;
+	victim->Stale = false;
+	victim->LastFrame = prefetch ? frame - 1 : frame;
+	victim->LastUse = ++cache->UseCounter;
 
-	draw_list->PathArcToFast({ rb.x, ra.y }, 0.f, 0, 3);
-	draw_list->PathArcToFast({ rb.x - rounding, rb.y - rounding }, rounding, 0, 3);
-	draw_list->PathArcToFast({ ra.x + rounding, rb.y - rounding }, rounding, 3, 6);
-	draw_list->PathArcToFast({ ra.x, ra.y }, 0.f, 9, 12);
-	
-	draw_list->PathStroke(color, ImDrawFlags_None, 1.f);
+	cache->Lookup.insert(cache->Lookup.Data + FindPageLookupIndex(cache, index), victim);
+	cache->Queue.push_back(victim);
+	return victim;
 }
 
-static void RenderTopCornerRect(ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, ImColor color, float rounding)
+// Must be called with the mutex held, moves a queued page to the back of the queue so it's loaded next
+static void PrioritizePage(ImGuiHexEditorPageCache* cache, ImGuiHexEditorPage* page)
 {
-	const ImVec2 ra = { a.x + 0.5f, a.y + 0.5f };
-	const ImVec2 rb = { b.x - 0.5f, b.y + 0.5f };
-
-	RenderRectCornerCalcRounding(ra, rb, rounding);
-
-	draw_list->PathArcToFast({ ra.x, rb.y }, 0.f, 3, 6);
-	draw_list->PathArcToFast({ ra.x + rounding, ra.y + rounding }, rounding, 6, 9);
-	draw_list->PathArcToFast({ rb.x - rounding, ra.y + rounding }, rounding, 9, 12);
-	draw_list->PathArcToFast({ rb.x , rb.y }, 0.f, 0, 3);
+	if (page->State != ImGuiHexEditorPageState_Queued || cache->Queue.back() == page)
+		return;
 
-	draw_list->PathStroke(color, ImDrawFlags_None, 1.f);
+	RemoveQueuedPage(cache, page);
+	cache->Queue.push_back(page);
 }
 
-static void RenderByteDecorations(ImDrawList* draw_list, const ImRect& bb, ImColor bg_color,
-	ImGuiHexEditorHighlightFlags flags, ImColor border_color, float rounding,
-	int offset, int range_min, int range_max, int bytes_per_line, int i, int line_base)
+static void PageCacheThread(ImGuiHexEditorPageCache* cache)
 {
-	const bool has_border = flags & ImGuiHexEditorHighlightFlags_Border;
+	std::unique_lock<std::mutex> lock(cache->Mutex);
 
-	if (!has_border) 
+	for (;;)
 	{
-		draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, 0.f);
-		return;
-	}
+		cache->Cond.wait(lock, [cache] { return cache->Quit || !cache->Queue.empty(); });
+		if (cache->Quit)
+			break;
+
+		// Queued neighbours of the next page, usually requested by the same or another view in the same frame, are
+		// loaded by the same read
+		ImVector<ImGuiHexEditorPage*>& pages = cache->ReadPages;
+		pages.resize(0);
+		pages.push_back(cache->Queue.back());
+		cache->Queue.pop_back();
+
+		while (pages.Size != cache->MaxReadPages)
+		{
+			ImGuiHexEditorPage* next = FindPage(cache, pages.back()->Index + 1);
+			if (!next || next->State != ImGuiHexEditorPageState_Queued)
+				break;
 
-	if (range_min == range_max)
-	{
-		draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding);
-		draw_list->AddRect(bb.Min, bb.Max, border_color, rounding);
-		return;
-	}
+			RemoveQueuedPage(cache, next);
+			pages.push_back(next);
+		}
 
-	const int start_line = range_min / bytes_per_line;
-	const int end_line = range_max / bytes_per_line;
-	const int current_line = line_base / bytes_per_line;
+		while (pages.Size != cache->MaxReadPages && pages[0]->Index > 0)
+		{
+			ImGuiHexEditorPage* prev = FindPage(cache, pages[0]->Index - 1);
+			if (!prev || prev->State != ImGuiHexEditorPageState_Queued)
+				break;
 
-	const bool is_start_line = start_line == (line_base / bytes_per_line);
-	const bool is_end_line = end_line == (line_base / bytes_per_line);
-	const bool is_last_byte = i == (bytes_per_line - 1);
+			RemoveQueuedPage(cache, prev);
+			pages.insert(pages.Data, prev);
+		}
 
-	bool rendered_bg = false;
+		for (ImGuiHexEditorPage* page : pages)
+			page->State = ImGuiHexEditorPageState_Loading;
 
-	if (offset == range_min) 
-	{
-		if (!is_last_byte)
-		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersTopLeft);
-			RenderTopLeftCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
+		const ImS64 page_size = cache->Config.PageSize;
+		const ImS64 offset = pages[0]->Index << cache->PageShift;
+		lock.unlock();
 
-			if (start_line == end_line)
-				draw_list->AddLine({ bb.Min.x, bb.Max.y }, { bb.Max.x, bb.Max.y }, border_color);
-		}
+		ImS64 read;
+		if (pages.Size == 1)
+			read = cache->Config.ReadCallback(cache->Config.UserData, offset, pages[0]->Data, page_size);
 		else
 		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersTop);
-			RenderTopCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
+			read = cache->Config.ReadCallback(cache->Config.UserData, offset, cache->ReadBuffer, page_size * pages.Size);
+			for (int i = 0; i != pages.Size; i++)
+			{
+				const ImS64 size = ImClamp(read - page_size * i, (ImS64)0, page_size);
+				if (size > 0)
+					memcpy(pages[i]->Data, cache->ReadBuffer + page_size * i, (size_t)size);
+			}
 		}
 
-		rendered_bg = true;
-	}
-	else if (i == 0) 
-	{
-		if (is_end_line)
+		lock.lock();
+		for (int i = pages.Size - 1; i >= 0; i--)
 		{
-			if (offset == range_max)
+			// Pages past a short read are read again on their own, so a failing range doesn't fail its neighbours
+			ImGuiHexEditorPage* page = pages[i];
+			if (page->Stale || (i != 0 && read <= page_size * i))
 			{
-				draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersBottom);
-				RenderBottomCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
+				page->Stale = false;
+				page->State = ImGuiHexEditorPageState_Queued;
+				cache->Queue.push_back(page);
 			}
 			else
 			{
-				draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersBottomLeft);
-				RenderBottomLeftCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
+				page->Size = ImClamp(read - page_size * i, (ImS64)0, page_size);
+				page->State = ImGuiHexEditorPageState_Ready;
 			}
-		
-			rendered_bg = true;
-		}
-		else if (current_line == start_line + 1 && (range_min % bytes_per_line) != 0)
-		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersTopLeft);
-			RenderTopLeftCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
-			rendered_bg = true;
 		}
-		else
+	}
+}
+
+// Never waits for the source: returns the amount of leading bytes that are resident and queues the first missing page
+static ImS64 ReadPageCache(ImGuiHexEditorPageCache* cache, ImS64 offset, void* buf, ImS64 size)
+{
+	const ImS64 page_mask = cache->Config.PageSize - 1;
+	const int frame = ImGui::GetFrameCount();
+
+	bool queued = false;
+	ImS64 done = 0;
+	{
+		std::lock_guard<std::mutex> lock(cache->Mutex);
+
+		while (done < size)
 		{
-			if (!rendered_bg)
+			const ImS64 page_index = (offset + done) >> cache->PageShift;
+			const ImS64 page_offset = (offset + done) & page_mask;
+
+			ImGuiHexEditorPage* page = FindPage(cache, page_index);
+			if (!page)
+			{
+				queued = ClaimPage(cache, page_index, frame, false) != nullptr;
+				break;
+			}
+
+			page->LastFrame = frame;
+			page->LastUse = ++cache->UseCounter;
+
+			if (page->State != ImGuiHexEditorPageState_Ready)
 			{
-				draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, 0.f);
-				rendered_bg = true;
+				PrioritizePage(cache, page);
+				break;
 			}
 
-			draw_list->AddLine({ bb.Min.x, bb.Min.y }, { bb.Min.x, bb.Max.y }, border_color);
+			const ImS64 count = ImMin(page->Size - page_offset, size - done);
+			if (count <= 0)
+				break;
+
+			memcpy((char*)buf + done, page->Data + page_offset, (size_t)count);
+			done += count;
+
+			if (page->Size != cache->Config.PageSize)
+				break;
 		}
 	}
 
-	if (i != 0 && offset == range_max) 
+	if (queued)
+		cache->Cond.notify_one();
+
+	return done;
+}
+
+// Blocking read of jobs and clipboard copies: resident pages are copied, runs of missing pages are read from the source
+// with a single call and aren't loaded into the cache, so long scans don't evict the visible pages
+static ImS64 ReadPageCacheBlocking(ImGuiHexEditorPageCache* cache, ImS64 offset, void* buf, ImS64 size)
+{
+	const ImS64 page_size = cache->Config.PageSize;
+	const ImS64 page_mask = page_size - 1;
+
+	ImS64 done = 0;
+	while (done < size)
 	{
-		if (start_line == end_line)
+		const ImS64 at = offset + done;
+		ImS64 count;
+		bool resident = false;
+		bool end = false;
 		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersTopRight);
-			RenderTopRightCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
-			draw_list->AddLine({ bb.Min.x, bb.Max.y }, { bb.Max.x, bb.Max.y }, border_color);
+			std::lock_guard<std::mutex> lock(cache->Mutex);
+
+			ImGuiHexEditorPage* page = FindPage(cache, at >> cache->PageShift);
+			if (page && page->State == ImGuiHexEditorPageState_Ready)
+			{
+				resident = true;
+				count = ImMin(page->Size - (at & page_mask), size - done);
+				if (count > 0)
+					memcpy((char*)buf + done, page->Data + (at & page_mask), (size_t)count);
+				end = page->Size != page_size;
+			}
+			else
+			{
+				count = page_size - (at & page_mask);
+				while (done + count < size)
+				{
+					ImGuiHexEditorPage* next = FindPage(cache, (at + count) >> cache->PageShift);
+					if (next && next->State == ImGuiHexEditorPageState_Ready)
+						break;
+
+					count += page_size;
+				}
+				count = ImMin(count, size - done);
+			}
 		}
-		else
+
+		if (resident)
 		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersBottomRight);
-			RenderBottomRightCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
+			if (count <= 0)
+				break;
+
+			done += count;
+			if (end)
+				break;
+
+			continue;
 		}
 
-		rendered_bg = true;
+		const ImS64 read = cache->Config.ReadCallback(cache->Config.UserData, at, (char*)buf + done, count);
+		if (read <= 0)
+			break;
+
+		done += read;
+		if (read < count)
+			break;
 	}
-	else if (is_last_byte && offset != range_min)
+
+	return done;
+}
+
+// Requests every page of [from, to) and the configured amount of pages around it. Pages closest to the start of the
+// range are loaded first, prefetched pages last.
+static void RequestPageCacheRange(ImGuiHexEditorPageCache* cache, ImS64 from, ImS64 to, ImS64 limit)
+{
+	if (from >= to)
+		return;
+
+	const int frame = ImGui::GetFrameCount();
+	const ImS64 first_page = from >> cache->PageShift;
+	const ImS64 last_page = (to - 1) >> cache->PageShift;
+	const ImS64 limit_page = limit > 0 ? (limit - 1) >> cache->PageShift : 0;
+
+	const ImS64 prefetch_first = ImMax((ImS64)0, first_page - cache->Config.PrefetchPages);
+	const ImS64 prefetch_last = ImMin(limit_page, last_page + cache->Config.PrefetchPages);
+
+	bool queued = false;
 	{
-		if (is_start_line)
-		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersTopRight);
-			RenderTopRightCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
-			rendered_bg = true;
-		}
-		else if (current_line == end_line - 1 && (range_max % bytes_per_line) != bytes_per_line - 1)
+		std::lock_guard<std::mutex> lock(cache->Mutex);
+
+		// Protect resident visible pages first, so prefetching can't reuse them
+		for (ImS64 i = first_page; i <= last_page; i++)
 		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, rounding, ImDrawFlags_RoundCornersBottomRight);
-			RenderBottomRightCornerRect(draw_list, bb.Min, bb.Max, border_color, rounding);
-			rendered_bg = true;
+			if (ImGuiHexEditorPage* page = FindPage(cache, i))
+				page->LastFrame = frame;
 		}
-		else
+
+		// Pushed in reverse priority order, the prefetch thread serves the back of the queue first
+		for (ImS64 i = prefetch_first; i <= prefetch_last; i++)
 		{
-			if (!rendered_bg)
-			{
-				draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, 0.f);
-				rendered_bg = true;
-			}
+			if (i >= first_page && i <= last_page)
+				continue;
 
-			draw_list->AddLine({ bb.Max.x - 1.f, bb.Min.y }, { bb.Max.x - 1.f, bb.Max.y }, border_color);
+			if (!FindPage(cache, i))
+				queued |= ClaimPage(cache, i, frame, true) != nullptr;
 		}
-	}
 
-	if ((is_start_line && offset != range_min && !is_last_byte && offset != range_max)
-		|| (current_line == start_line + 1 && (i < (range_min % bytes_per_line) && i != 0)))
-	{
-		if (!rendered_bg)
+		for (ImS64 i = last_page; i >= first_page; i--)
 		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, 0.f);
-			rendered_bg = true;
+			if (ImGuiHexEditorPage* page = FindPage(cache, i))
+				PrioritizePage(cache, page);
+			else
+				queued |= ClaimPage(cache, i, frame, false) != nullptr;
 		}
-
-		draw_list->AddLine({ bb.Min.x, bb.Min.y }, { bb.Max.x, bb.Min.y }, border_color);
 	}
 
-	if ((is_end_line && offset != range_max && i != 0)
-		|| (current_line == end_line - 1 && (i > (range_max % bytes_per_line) && !is_last_byte)))
+	if (queued)
+		cache->Cond.notify_one();
+}
+
+// Keeps resident pages in sync with bytes written through the editor
+static void UpdatePageCache(ImGuiHexEditorPageCache* cache, ImS64 offset, const void* buf, ImS64 size)
+{
+	const ImS64 page_mask = cache->Config.PageSize - 1;
+
+	std::lock_guard<std::mutex> lock(cache->Mutex);
+
+	for (ImS64 done = 0; done < size;)
 	{
-		if (!rendered_bg)
+		const ImS64 page_offset = (offset + done) & page_mask;
+		const ImS64 count = ImMin(cache->Config.PageSize - page_offset, size - done);
+
+		if (ImGuiHexEditorPage* page = FindPage(cache, (offset + done) >> cache->PageShift))
 		{
-			draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, 0.f);
-			rendered_bg = true;
+			if (page->State == ImGuiHexEditorPageState_Ready)
+			{
+				if (page_offset < page->Size)
+					memcpy(page->Data + page_offset, (const char*)buf + done, (size_t)ImMin(count, page->Size - page_offset));
+			}
+			else if (page->State == ImGuiHexEditorPageState_Loading)
+				page->Stale = true;
 		}
 
-		draw_list->AddLine({ bb.Min.x, bb.Max.y }, { bb.Max.x, bb.Max.y }, border_color);
+		done += count;
 	}
-
-	if (!rendered_bg)
-		draw_list->AddRectFilled(bb.Min, bb.Max, bg_color, 0.f);
 }
 
-bool ImGui::BeginHexEditor(const char* str_id, ImGuiHexEditorState* state, const ImVec2& size, ImGuiChildFlags child_flags, ImGuiWindowFlags window_flags)
+struct ImGuiHexEditorFileView
 {
-	if (!ImGui::BeginChild(str_id, size, child_flags, window_flags))
-		return false;
+	ImS64 Index;
+	unsigned char* Data;
+	ImS64 Size;
+	bool Dirty; // Holds copy-on-write changes, never unmapped before the file is closed
+	int LastFrame;
+	ImU64 LastUse;
+};
+
+struct ImGuiHexEditorFile
+{
+	ImGuiHexEditorFileFlags Flags;
+	ImS64 Size;
+	ImS64 WindowSize;
+	int MaxViews = 4; // Views without changes kept mapped at once
+#ifdef _WIN32
+	HANDLE Handle = INVALID_HANDLE_VALUE;
+	HANDLE Mapping = nullptr;
+#else
+	int Fd = -1;
+	ImS64 AdviseFrom = -1;
+	ImS64 AdviseTo = -1;
+#endif
+	ImVector<ImGuiHexEditorFileView> Views;
+	ImU64 UseCounter = 0;
+	int Frame = -1; // Last frame rendered from the file, its views stay mapped so returned pointers remain valid
+	std::mutex Mutex;
+};
 
-	const ImVec2 char_size = ImGui::CalcTextSize("0");
-	const ImVec2 byte_size = { char_size.x * 2.f, char_size.y };
+static void UnmapFileView(ImGuiHexEditorFileView* view)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(view->Data);
+#else
+	munmap(view->Data, (size_t)view->Size);
+#endif
+}
 
-	const ImGuiStyle& style = ImGui::GetStyle();
-	const ImVec2 spacing = style.ItemSpacing;
+// Must be called with the mutex held
+static ImGuiHexEditorFileView* MapFileView(ImGuiHexEditorFile* file, ImS64 index)
+{
+	for (ImGuiHexEditorFileView& view : file->Views)
+	{
+		if (view.Index == index)
+		{
+			view.LastUse = ++file->UseCounter;
+			return &view;
+		}
+	}
 
-	ImVec2 content_avail = ImGui::GetContentRegionAvail();
+	const ImS64 offset = index * file->WindowSize;
+	if (offset < 0 || offset >= file->Size)
+		return nullptr;
 
-	float address_max_size;
-	int address_max_chars;
-	if (state->ShowAddress)
+	int clean_views = 0;
+	int victim = -1;
+	for (int i = 0; i != file->Views.Size; i++)
 	{
-		int address_chars = state->AddressChars;
-		if (address_chars == -1)
-			address_chars = ImFormatString(nullptr, 0, "%zX", (size_t)state->MaxBytes) + 1;
+		const ImGuiHexEditorFileView& view = file->Views[i];
+		if (view.Dirty)
+			continue;
 
-		address_max_chars = address_chars + 1;
-		address_max_size = char_size.x * address_max_chars + spacing.x * 0.5f;
+		++clean_views;
+		if (view.LastFrame != file->Frame && (victim == -1 || view.LastUse < file->Views[victim].LastUse))
+			victim = i;
 	}
-	else
+
+	if (clean_views >= file->MaxViews && victim != -1)
 	{
-		address_max_size = 0.f;
-		address_max_chars = 0;
+		UnmapFileView(&file->Views[victim]);
+		file->Views.erase(file->Views.Data + victim);
 	}
 
-	float bytes_avail_x = content_avail.x - address_max_size;
-	if (ImGui::GetScrollMaxY() > 0.f)
-		bytes_avail_x -= style.ScrollbarSize;
+	const bool copy_on_write = file->Flags & ImGuiHexEditorFileFlags_CopyOnWrite;
 
-	const bool show_ascii = state->ShowAscii;
+	ImGuiHexEditorFileView view;
+	view.Index = index;
+	view.Size = ImMin(file->WindowSize, file->Size - offset);
+	view.Dirty = false;
+	view.LastFrame = -1;
+	view.LastUse = ++file->UseCounter;
 
-	if (show_ascii)
-		bytes_avail_x -= char_size.x * 0.5f;
+#ifdef _WIN32
+	view.Data = (unsigned char*)MapViewOfFile(file->Mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ,
+		(DWORD)((ImU64)offset >> 32), (DWORD)((ImU64)offset & 0xffffffff), (SIZE_T)view.Size);
+	if (!view.Data)
+		return nullptr;
+#else
+	void* data = mmap(nullptr, (size_t)view.Size, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, file->Fd, (off_t)offset);
+	if (data == MAP_FAILED)
+		return nullptr;
 
-	bytes_avail_x = bytes_avail_x < 0.f ? 0.f : bytes_avail_x;
+	view.Data = (unsigned char*)data;
+#endif
 
-	int bytes_per_line;
+	file->Views.push_back(view);
+	return &file->Views.back();
+}
 
-	if (state->BytesPerLine == -1)
+static ImS64 ReadFileBytes(ImGuiHexEditorFile* file, ImS64 offset, void* buf, ImS64 size)
+{
+	std::lock_guard<std::mutex> lock(file->Mutex);
+
+	ImS64 done = 0;
+	size = ImMin(size, file->Size - offset);
+	while (done < size)
 	{
-		bytes_per_line = CalcBytesPerLine(bytes_avail_x, byte_size, spacing, show_ascii, char_size, state->Separators);
+		ImGuiHexEditorFileView* view = MapFileView(file, (offset + done) / file->WindowSize);
+		if (!view)
+			break;
+
+		const ImS64 view_offset = offset + done - view->Index * file->WindowSize;
+		const ImS64 count = ImMin(view->Size - view_offset, size - done);
+		memcpy((char*)buf + done, view->Data + view_offset, (size_t)count);
+		done += count;
 	}
-	else
+
+	return done;
+}
+
+static ImS64 WriteFileBytes(ImGuiHexEditorFile* file, ImS64 offset, const void* buf, ImS64 size)
+{
+	if (!(file->Flags & ImGuiHexEditorFileFlags_CopyOnWrite))
+		return 0;
+
+	std::lock_guard<std::mutex> lock(file->Mutex);
+
+	ImS64 done = 0;
+	size = ImMin(size, file->Size - offset);
+	while (done < size)
 	{
-		bytes_per_line = state->BytesPerLine;
+		ImGuiHexEditorFileView* view = MapFileView(file, (offset + done) / file->WindowSize);
+		if (!view)
+			break;
+
+		const ImS64 view_offset = offset + done - view->Index * file->WindowSize;
+		const ImS64 count = ImMin(view->Size - view_offset, size - done);
+		memcpy(view->Data + view_offset, (const char*)buf + done, (size_t)count);
+		view->Dirty = true;
+		done += count;
 	}
 
-	int actual_separators = (int)(bytes_per_line / state->Separators);
-	if (bytes_per_line % state->Separators == 0)
-		--actual_separators;
-	
-	int lines_count;
-	if (bytes_per_line != 0)
+	return done;
+}
+
+// Returns a pointer straight into the mapping, rows crossing two views are copied into scratch instead.
+// The pointer stays valid until the next frame.
+static const unsigned char* AccessFileBytes(ImGuiHexEditorFile* file, ImS64 offset, int size, unsigned char* scratch, int* out_size)
+{
 	{
-		lines_count = state->MaxBytes / bytes_per_line;
-		if (lines_count * bytes_per_line < state->MaxBytes)
+		std::lock_guard<std::mutex> lock(file->Mutex);
+		file->Frame = ImGui::GetFrameCount();
+
+		ImGuiHexEditorFileView* view = MapFileView(file, offset / file->WindowSize);
+		if (!view)
 		{
-			++lines_count;
+			*out_size = 0;
+			return scratch;
 		}
-	}
-	else
-		lines_count = 0;
 
-	ImDrawList* draw_list = ImGui::GetWindowDrawList();
-	ImGuiIO& io = ImGui::GetIO();
+		view->LastFrame = file->Frame;
 
-	const ImColor text_color = ImGui::GetColorU32(ImGuiCol_Text);
-	const ImColor text_disabled_color = ImGui::GetColorU32(ImGuiCol_TextDisabled);
-	const ImColor text_selected_bg_color = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
-	const ImColor separator_color = ImGui::GetColorU32(ImGuiCol_Separator);
-	const ImColor border_color = ImGui::GetColorU32(ImGuiCol_FrameBgActive);
+		const ImS64 view_offset = offset - view->Index * file->WindowSize;
+		if (view_offset + size <= view->Size)
+		{
+			*out_size = size;
+			return view->Data + view_offset;
+		}
+	}
 
-	const bool lowercase_bytes = state->LowercaseBytes;
+	*out_size = (int)ReadFileBytes(file, offset, scratch, size);
+	return scratch;
+}
 
-	const int select_start_byte = state->SelectStartByte;
-	const int select_start_subbyte = state->SelectStartSubByte;
-	const int select_end_byte = state->SelectEndByte;
-	const int select_end_subbyte = state->SelectEndSubByte;
-	const int last_selected_byte = state->LastSelectedByte;
-	const int select_drag_byte = state->SelectDragByte;
-	const int select_drag_subbyte = state->SelectDragSubByte;
+// Hints the kernel to read ahead the visible range and a screen around it
+static void AdviseFileRange(ImGuiHexEditorFile* file, ImS64 from, ImS64 to)
+{
+#ifdef _WIN32
+	IM_UNUSED(file);
+	IM_UNUSED(from);
+	IM_UNUSED(to);
+#else
+	const ImS64 span = to - from;
+	from = ImMax((ImS64)0, from - span);
+	to = ImMin(file->Size, to + span);
 
-	int next_select_start_byte = select_start_byte;
-	int next_select_start_subbyte = select_start_subbyte;
-	int next_select_end_byte = select_end_byte;
-	int next_select_end_subbyte = select_end_subbyte;
-	int next_last_selected_byte = last_selected_byte;
-	int next_select_drag_byte = select_drag_byte;
-	int next_select_drag_subbyte = select_drag_subbyte;
+	if (from >= file->AdviseFrom && to <= file->AdviseTo)
+		return;
 
-	ImGuiKey hex_key_pressed = ImGuiKey_None;
+	file->AdviseFrom = from;
+	file->AdviseTo = to;
+
+	const ImS64 page_mask = (ImS64)sysconf(_SC_PAGESIZE) - 1;
 
-	if (state->EnableClipboard && ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_C))
+	std::lock_guard<std::mutex> lock(file->Mutex);
+	for (const ImGuiHexEditorFileView& view : file->Views)
 	{
-		if (state->SelectStartByte != -1)
-		{
-			const int bytes_count = (state->SelectEndByte + 1) - state->SelectStartByte;
+		const ImS64 view_from = view.Index * file->WindowSize;
+		const ImS64 advise_from = ImMax(from, view_from) - view_from;
+		const ImS64 advise_to = ImMin(to, view_from + view.Size) - view_from;
+		if (advise_from >= advise_to)
+			continue;
+
+		const ImS64 aligned_from = advise_from & ~page_mask;
+		madvise(view.Data + aligned_from, (size_t)(advise_to - aligned_from), MADV_WILLNEED);
+	}
+#endif
+}
 
-			char* bytes = (char*)ImGui::MemAlloc((size_t)bytes_count);
-			if (bytes)
-			{
-				int read_bytes;
+static ImS64 ReadSourceBytesEx(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size)
+{
+	if (state->PageCache)
+		return ReadPageCacheBlocking(state->PageCache, offset, buf, size);
 
-				if (state->ReadCallback)
-					read_bytes = state->ReadCallback(state, state->SelectStartByte, bytes, bytes_count);
-				else
-				{
-					memcpy(bytes, (char*)state->Bytes + state->SelectStartByte, bytes_count);
-					read_bytes = bytes_count;
-				}
+	if (state->File)
+		return ReadFileBytes(state->File, offset, buf, size);
 
-				if (read_bytes > 0)
-				{
-					ImGuiHexEditorClipboardFlags flags = state->ClipboardFlags;
+	if (state->ReadCallback)
+		return state->ReadCallback(state, offset, buf, size);
+
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	if (state->ReadCallbackInt)
+	{
+		if (offset > INT_MAX)
+			return 0;
 
-					const int text_byte_size = 3;
+		return state->ReadCallbackInt(state, (int)offset, buf, (int)ImMin(size, (ImS64)INT_MAX - offset));
+	}
+#endif
 
-					ImGui::LogToClipboard();
+	memcpy(buf, (char*)state->Bytes + offset, (size_t)size);
+	return size;
+}
 
-					for (int i = 0, abs_i = state->SelectStartByte; i < bytes_count; i++, abs_i++)
-					{
-						const char byte = bytes[i];
+// Write queue, defined with the other threads below
+static const unsigned char* ApplyWriteQueue(ImGuiHexEditorWriteQueue* queue, ImS64 offset, const unsigned char* data, ImS64 size, unsigned char* scratch);
+static ImS64 QueueWrite(ImGuiHexEditorWriteQueue* queue, ImS64 offset, const unsigned char* data, ImS64 size);
 
-						char text[3];
-						text[0] = HalfByteToPrintable((byte & 0xf0) >> 4, lowercase_bytes);
-						text[1] = HalfByteToPrintable(byte & 0x0f, lowercase_bytes);
-						text[2] = '\0';
+static ImS64 ReadSourceBytes(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size)
+{
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	const double start = GHexEditorStats ? GetStatsTime() : 0.0;
+#endif
 
-						ImGui::LogText("%s", text);
+	const ImS64 read = ReadSourceBytesEx(state, offset, buf, size);
 
-						if (bytes_per_line != 0 && ((abs_i % bytes_per_line) == bytes_per_line - 1) && abs_i != 0)
-						{
-							ImGui::LogText(IM_NEWLINE);
-						}
-						else
-						{
-							ImGui::LogText(" ");
-						}
-					}
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	if (ImGuiHexEditorStats* stats = GHexEditorStats)
+	{
+		stats->SourceReads++;
+		stats->SourceReadBytes += ImMax((ImS64)0, read);
+		stats->SourceReadTime += (float)(GetStatsTime() - start);
+	}
+#endif
 
-					ImGui::LogFinish();
-				}
+	if (state->WriteQueue && read > 0)
+		ApplyWriteQueue(state->WriteQueue, offset, (const unsigned char*)buf, read, (unsigned char*)buf);
 
-				ImGui::MemFree(bytes);
-			}
-		}
+	return read;
+}
+
+static ImS64 WriteSourceBytesEx(ImGuiHexEditorState* state, ImS64 offset, const void* buf, ImS64 size)
+{
+	if (state->File)
+		return WriteFileBytes(state->File, offset, buf, size);
+
+	if (state->WriteCallback)
+		return state->WriteCallback(state, offset, (void*)buf, size);
+
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	if (state->WriteCallbackInt)
+	{
+		if (offset > INT_MAX)
+			return 0;
+
+		return state->WriteCallbackInt(state, (int)offset, (void*)buf, (int)ImMin(size, (ImS64)INT_MAX - offset));
+	}
+#endif
+
+	memcpy((char*)state->Bytes + offset, buf, (size_t)size);
+	return size;
+}
+
+// Resident pages only receive the bytes that were written, the rest is read again
+static ImS64 WriteSourceBytes(ImGuiHexEditorState* state, ImS64 offset, const void* buf, ImS64 size)
+{
+	const ImS64 written = ImClamp(WriteSourceBytesEx(state, offset, buf, size), (ImS64)0, size);
+
+	if (state->PageCache)
+	{
+		UpdatePageCache(state->PageCache, offset, buf, written);
+		if (written < size)
+			ImGui::InvalidateHexEditorPageCache(state->PageCache, offset + written, size - written);
+	}
+
+	return written;
+}
+
+static bool HasReadCallback(ImGuiHexEditorState* state)
+{
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	if (state->ReadCallbackInt)
+		return true;
+#endif
+
+	return state->ReadCallback != nullptr;
+}
+
+static bool HasWriteCallback(ImGuiHexEditorState* state)
+{
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	if (state->WriteCallbackInt)
+		return true;
+#endif
+
+	return state->WriteCallback != nullptr;
+}
+
+// Read path used for rendering, never blocks when a page cache is attached. Memory backed sources are returned
+// in place, everything else is read into scratch.
+static const unsigned char* AccessSourceBytesEx(ImGuiHexEditorState* state, ImS64 offset, int size, unsigned char* scratch, int* out_size)
+{
+	if (state->PageCache)
+	{
+		*out_size = (int)ReadPageCache(state->PageCache, offset, scratch, size);
+		return scratch;
+	}
+
+	if (state->File)
+		return AccessFileBytes(state->File, offset, size, scratch, out_size);
+
+	if (!HasReadCallback(state))
+	{
+		*out_size = size;
+		return (const unsigned char*)state->Bytes + offset;
+	}
+
+	*out_size = (int)ReadSourceBytes(state, offset, scratch, size);
+	return scratch;
+}
+
+// Rows holding queued writes are copied into scratch
+static const unsigned char* AccessSourceBytes(ImGuiHexEditorState* state, ImS64 offset, int size, unsigned char* scratch, int* out_size)
+{
+	const unsigned char* data = AccessSourceBytesEx(state, offset, size, scratch, out_size);
+	if (state->WriteQueue && *out_size > 0)
+		data = ApplyWriteQueue(state->WriteQueue, offset, data, *out_size, scratch);
+
+	return data;
+}
+
+static ImS64 ReadVisibleSourceBytes(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size)
+{
+	if (state->PageCache)
+	{
+		const ImS64 read = ReadPageCache(state->PageCache, offset, buf, size);
+		if (state->WriteQueue && read > 0)
+			ApplyWriteQueue(state->WriteQueue, offset, (const unsigned char*)buf, read, (unsigned char*)buf);
+
+		return read;
+	}
+
+	return ReadSourceBytes(state, offset, buf, size);
+}
+
+// The edit buffer is a piece table stored as a persistent treap ordered by position: edits copy the O(log n) nodes
+// on their path instead of modifying them, so every history entry is just the root of its version.
+
+struct ImGuiHexEditorPiece
+{
+	ImS64 Start; // Offset in the source, or in the add block
+	ImS64 Length;
+	ImS64 TreeLength; // Length of the piece and both of its subtrees
+	int Left;
+	int Right;
+	int Block; // -1 for the original source, otherwise index into AddBlocks
+	ImU32 Priority;
+};
+
+struct ImGuiHexEditorEditBuffer
+{
+	ImS64 OriginalSize;
+	ImVector<ImGuiHexEditorPiece> Nodes;
+	ImVector<unsigned char*> AddBlocks;
+	ImS64 AddBlockUsed = 0;
+	ImS64 AddBlockCapacity = 0;
+	ImU32 Seed = 0x9E3779B9;
+
+	int Root = -1;
+	ImVector<int> History; // Roots of every undo step, History[HistoryIndex] is the current one
+	int HistoryIndex = 0;
+	int GroupDepth = 0;
+
+	std::mutex Mutex; // Held while nodes or add blocks are added, and by the search thread while reading them
+};
+
+static ImS64 GetPieceTreeLength(ImGuiHexEditorEditBuffer* buffer, int node)
+{
+	return node == -1 ? 0 : buffer->Nodes[node].TreeLength;
+}
+
+static int NewPiece(ImGuiHexEditorEditBuffer* buffer, ImS64 start, ImS64 length, int block, ImU32 priority, int left, int right)
+{
+	ImGuiHexEditorPiece piece;
+	piece.Start = start;
+	piece.Length = length;
+	piece.TreeLength = length + GetPieceTreeLength(buffer, left) + GetPieceTreeLength(buffer, right);
+	piece.Left = left;
+	piece.Right = right;
+	piece.Block = block;
+	piece.Priority = priority;
+
+	buffer->Nodes.push_back(piece);
+	return buffer->Nodes.Size - 1;
+}
+
+static int ClonePiece(ImGuiHexEditorEditBuffer* buffer, int node, int left, int right)
+{
+	const ImGuiHexEditorPiece piece = buffer->Nodes[node];
+	return NewPiece(buffer, piece.Start, piece.Length, piece.Block, piece.Priority, left, right);
+}
+
+static ImU32 NextPiecePriority(ImGuiHexEditorEditBuffer* buffer)
+{
+	ImU32 x = buffer->Seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	buffer->Seed = x;
+	return x;
+}
+
+// Splits the tree into the first pos bytes and the rest, cutting the piece containing pos in two if needed
+static void SplitPieces(ImGuiHexEditorEditBuffer* buffer, int node, ImS64 pos, int* out_left, int* out_right)
+{
+	if (node == -1)
+	{
+		*out_left = -1;
+		*out_right = -1;
+		return;
+	}
+
+	const ImGuiHexEditorPiece piece = buffer->Nodes[node];
+	const ImS64 left_length = GetPieceTreeLength(buffer, piece.Left);
+
+	if (pos <= left_length)
+	{
+		int right;
+		SplitPieces(buffer, piece.Left, pos, out_left, &right);
+		*out_right = ClonePiece(buffer, node, right, piece.Right);
+	}
+	else if (pos >= left_length + piece.Length)
+	{
+		int left;
+		SplitPieces(buffer, piece.Right, pos - left_length - piece.Length, &left, out_right);
+		*out_left = ClonePiece(buffer, node, piece.Left, left);
 	}
 	else
 	{
+		const ImS64 cut = pos - left_length;
+		*out_left = NewPiece(buffer, piece.Start, cut, piece.Block, piece.Priority, piece.Left, -1);
+		*out_right = NewPiece(buffer, piece.Start + cut, piece.Length - cut, piece.Block, piece.Priority, -1, piece.Right);
+	}
+}
 
-		if (last_selected_byte != -1)
-		{
-			bool any_pressed = false;
-			if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow))
-			{
-				if (!select_start_subbyte)
-				{
-					if (last_selected_byte == 0)
-					{
-						next_last_selected_byte = 0;
-					}
-					else
-					{
-						next_last_selected_byte = last_selected_byte - 1;
-						next_select_start_subbyte = 1;
-					}
-				}
-				else
-					next_select_start_subbyte = 0;
+static int MergePieces(ImGuiHexEditorEditBuffer* buffer, int left, int right)
+{
+	if (left == -1)
+		return right;
 
-				any_pressed = true;
-			}
-			else if (ImGui::IsKeyPressed(ImGuiKey_RightArrow))
-			{
-				if (select_start_subbyte)
-				{
-					if (last_selected_byte >= state->MaxBytes - 1)
-					{
-						next_last_selected_byte = state->MaxBytes - 1;
-					}
-					else
-					{
-						next_last_selected_byte = last_selected_byte + 1;
-						next_select_start_subbyte = 0;
-					}
-				}
-				else
-					next_select_start_subbyte = 1;
+	if (right == -1)
+		return left;
 
-				any_pressed = true;
-			}
-			else if (bytes_per_line != 0)
-			{
-				if (ImGui::IsKeyPressed(ImGuiKey_UpArrow))
-				{
-					if (last_selected_byte >= bytes_per_line)
-					{
-						next_last_selected_byte = last_selected_byte - bytes_per_line;
-					}
+	if (buffer->Nodes[left].Priority > buffer->Nodes[right].Priority)
+		return ClonePiece(buffer, left, buffer->Nodes[left].Left, MergePieces(buffer, buffer->Nodes[left].Right, right));
 
-					any_pressed = true;
-				}
-				else if (ImGui::IsKeyPressed(ImGuiKey_DownArrow))
-				{
-					if (last_selected_byte < state->MaxBytes - bytes_per_line)
-					{
-						next_last_selected_byte = last_selected_byte + bytes_per_line;
-					}
+	return ClonePiece(buffer, right, MergePieces(buffer, left, buffer->Nodes[right].Left), buffer->Nodes[right].Right);
+}
 
-					any_pressed = true;
-				}
-			}
+static int AddPieceData(ImGuiHexEditorEditBuffer* buffer, const void* data, ImS64 size)
+{
+	if (buffer->AddBlocks.empty() || buffer->AddBlockUsed + size > buffer->AddBlockCapacity)
+	{
+		buffer->AddBlockCapacity = ImMax((ImS64)64 * 1024, size);
+		buffer->AddBlockUsed = 0;
+		buffer->AddBlocks.push_back((unsigned char*)IM_ALLOC((size_t)buffer->AddBlockCapacity));
+	}
 
-			if (any_pressed)
-			{
-				next_select_start_byte = next_last_selected_byte;
-				next_select_end_byte = next_last_selected_byte;
-			}
+	const ImS64 start = buffer->AddBlockUsed;
+	memcpy(buffer->AddBlocks.back() + start, data, (size_t)size);
+	buffer->AddBlockUsed += size;
+
+	return NewPiece(buffer, start, size, buffer->AddBlocks.Size - 1, NextPiecePriority(buffer), -1, -1);
+}
+
+static void PushEditHistory(ImGuiHexEditorEditBuffer* buffer)
+{
+	if (buffer->GroupDepth > 0 || buffer->History[buffer->HistoryIndex] == buffer->Root)
+		return;
+
+	buffer->History.resize(buffer->HistoryIndex + 1);
+	buffer->History.push_back(buffer->Root);
+	buffer->HistoryIndex++;
+}
+
+static void ResetEditBuffer(ImGuiHexEditorEditBuffer* buffer, ImS64 original_size)
+{
+	for (unsigned char* block : buffer->AddBlocks)
+		IM_FREE(block);
+
+	buffer->OriginalSize = original_size;
+	buffer->Nodes.resize(0);
+	buffer->AddBlocks.resize(0);
+	buffer->AddBlockUsed = 0;
+	buffer->AddBlockCapacity = 0;
+	buffer->Root = original_size > 0 ? NewPiece(buffer, 0, original_size, -1, NextPiecePriority(buffer), -1, -1) : -1;
+	buffer->History.resize(0);
+	buffer->History.push_back(buffer->Root);
+	buffer->HistoryIndex = 0;
+}
+
+// Finds the piece containing pos, out_piece_pos receives the position of its first byte
+static int FindPiece(ImGuiHexEditorEditBuffer* buffer, ImS64 pos, ImS64* out_piece_pos)
+{
+	int node = buffer->Root;
+	ImS64 base = 0;
+	while (node != -1)
+	{
+		const ImGuiHexEditorPiece& piece = buffer->Nodes[node];
+		const ImS64 left_length = GetPieceTreeLength(buffer, piece.Left);
+
+		if (pos < base + left_length)
+			node = piece.Left;
+		else if (pos < base + left_length + piece.Length)
+		{
+			*out_piece_pos = base + left_length;
+			return node;
 		}
+		else
+		{
+			base += left_length + piece.Length;
+			node = piece.Right;
+		}
+	}
+
+	return -1;
+}
+
+// Reads [from, to) of the subtree starting at position base, returns false once the source returns less than asked
+static bool ReadPieces(ImGuiHexEditorState* state, int node, ImS64 base, ImS64 from, ImS64 to, unsigned char* buf, bool visible, ImS64* done)
+{
+	ImGuiHexEditorEditBuffer* buffer = state->EditBuffer;
+	if (node == -1 || from >= base + buffer->Nodes[node].TreeLength || to <= base)
+		return true;
+
+	const ImGuiHexEditorPiece piece = buffer->Nodes[node];
+	const ImS64 left_length = GetPieceTreeLength(buffer, piece.Left);
+
+	if (!ReadPieces(state, piece.Left, base, from, to, buf, visible, done))
+		return false;
 
-		for (ImGuiKey key = ImGuiKey_A; key != ImGuiKey_G; key = (ImGuiKey)((int)key + 1))
+	const ImS64 piece_pos = base + left_length;
+	const ImS64 piece_from = ImMax(from, piece_pos);
+	const ImS64 piece_to = ImMin(to, piece_pos + piece.Length);
+	if (piece_from < piece_to)
+	{
+		const ImS64 size = piece_to - piece_from;
+		const ImS64 start = piece.Start + piece_from - piece_pos;
+		unsigned char* dst = buf + (piece_from - from);
+
+		if (piece.Block != -1)
+			memcpy(dst, buffer->AddBlocks[piece.Block] + start, (size_t)size);
+		else
 		{
-			if (ImGui::IsKeyPressed(key))
+			const ImS64 read = visible ? ReadVisibleSourceBytes(state, start, dst, size) : ReadSourceBytes(state, start, dst, size);
+			if (read != size)
 			{
-				hex_key_pressed = key;
-				break;
+				*done += ImMax((ImS64)0, read);
+				return false;
 			}
 		}
 
-		if (hex_key_pressed == ImGuiKey_None)
+		*done += size;
+	}
+
+	return ReadPieces(state, piece.Right, piece_pos + piece.Length, from, to, buf, visible, done);
+}
+
+static ImS64 ReadEditBuffer(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size, bool visible)
+{
+	ImGuiHexEditorEditBuffer* buffer = state->EditBuffer;
+	size = ImMin(size, GetPieceTreeLength(buffer, buffer->Root) - offset);
+
+	ImS64 done = 0;
+	if (size > 0)
+		ReadPieces(state, buffer->Root, 0, offset, offset + size, (unsigned char*)buf, visible, &done);
+
+	return done;
+}
+
+static ImS64 ReadBytes(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size)
+{
+	if (state->EditBuffer)
+		return ReadEditBuffer(state, offset, buf, size, false);
+
+	return ReadSourceBytes(state, offset, buf, size);
+}
+
+// Caches of the bytes of the source, for bytes changed without WriteBytes()
+static void InvalidateSourceViews(ImGuiHexEditorState* state, ImS64 offset, ImS64 size)
+{
+	if (state->PageCache)
+		ImGui::InvalidateHexEditorPageCache(state->PageCache, offset, size);
+
+	if (state->RowCache)
+		ImGui::InvalidateHexEditorRowCache(state->RowCache, offset, size);
+
+	if (state->DataInspector)
+		ImGui::InvalidateHexEditorDataInspector(state->DataInspector);
+
+	if (state->Minimap)
+		ImGui::InvalidateHexEditorMinimap(state, offset, size);
+}
+
+static ImS64 WriteBytes(ImGuiHexEditorState* state, ImS64 offset, const void* buf, ImS64 size)
+{
+	if (state->RowCache)
+		ImGui::InvalidateHexEditorRowCache(state->RowCache, offset, size);
+
+	if (state->DataInspector)
+		ImGui::InvalidateHexEditorDataInspector(state->DataInspector);
+
+	// Bytes and mapped files are read in place while rendering, so they're written here rather than by the flush thread
+	ImS64 written = size;
+	if (state->EditBuffer)
+		ImGui::OverwriteHexEditorBytes(state->EditBuffer, offset, buf, size);
+	else if (state->WriteQueue && !state->File && HasWriteCallback(state))
+		written = QueueWrite(state->WriteQueue, offset, (const unsigned char*)buf, size);
+	else
+		written = WriteSourceBytes(state, offset, buf, size);
+
+	// After writing, so the new version of the edit buffer isn't taken for a change made outside of the editor
+	if (state->Minimap)
+		ImGui::InvalidateHexEditorMinimap(state, offset, size);
+
+	return written;
+}
+
+// Rows lying in a single unmodified piece of the source are still rendered in place
+static const unsigned char* AccessVisibleBytes(ImGuiHexEditorState* state, ImS64 offset, int size, unsigned char* scratch, int* out_size)
+{
+	ImGuiHexEditorEditBuffer* buffer = state->EditBuffer;
+	if (!buffer)
+		return AccessSourceBytes(state, offset, size, scratch, out_size);
+
+	ImS64 piece_pos;
+	const int node = FindPiece(buffer, offset, &piece_pos);
+	if (node != -1)
+	{
+		const ImGuiHexEditorPiece& piece = buffer->Nodes[node];
+		if (offset + size <= piece_pos + piece.Length)
 		{
-			for (ImGuiKey key = ImGuiKey_0; key != ImGuiKey_A; key = (ImGuiKey)((int)key + 1))
-			{
-				if (ImGui::IsKeyPressed(key))
-				{
-					hex_key_pressed = key;
-					break;
-				}
-			}
+			const ImS64 start = piece.Start + offset - piece_pos;
+			if (piece.Block == -1)
+				return AccessSourceBytes(state, start, size, scratch, out_size);
+
+			*out_size = size;
+			return buffer->AddBlocks[piece.Block] + start;
 		}
 	}
 
-	unsigned char stack_line_buf[128];
-	unsigned char* line_buf = bytes_per_line <= sizeof(stack_line_buf) ? stack_line_buf : (unsigned char*)ImGui::MemAlloc(bytes_per_line);
-	if (!line_buf)
-		return true;
+	*out_size = (int)ReadEditBuffer(state, offset, scratch, size, true);
+	return scratch;
+}
+
+static bool GetAddressName(ImGuiHexEditorState* state, ImS64 offset, char* buf, int size)
+{
+	if (state->GetAddressNameCallback)
+	{
+		if (state->GetAddressNameCallback(state, offset, buf, size))
+			return true;
+	}
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	else if (state->GetAddressNameCallbackInt && offset <= INT_MAX)
+	{
+		if (state->GetAddressNameCallbackInt(state, (int)offset, buf, size))
+			return true;
+	}
+#endif
+
+	// Field paths rarely fit into the address column, their innermost part at the end is kept
+	char path[256];
+	if (!state->Template || size <= 0 || !ImGui::GetHexEditorTemplateFieldName(state->Template, offset, path, sizeof(path)))
+		return false;
+
+	const int length = (int)strlen(path);
+	const int kept = ImMin(length, size - 1);
+	memcpy(buf, path + length - kept, (size_t)kept);
+	buf[kept] = '\0';
+	return true;
+}
+
+static bool HasSingleHighlightCallback(ImGuiHexEditorState* state)
+{
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	if (state->SingleHighlightCallbackInt)
+		return true;
+#endif
+
+	return state->SingleHighlightCallback != nullptr;
+}
+
+static ImGuiHexEditorHighlightFlags GetSingleHighlight(ImGuiHexEditorState* state, ImS64 offset, ImColor* color, ImColor* text_color, ImColor* border_color)
+{
+	if (state->SingleHighlightCallback)
+		return state->SingleHighlightCallback(state, offset, color, text_color, border_color);
+
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	if (state->SingleHighlightCallbackInt && offset <= INT_MAX)
+		return state->SingleHighlightCallbackInt(state, (int)offset, color, text_color, border_color);
+#endif
+
+	return ImGuiHexEditorHighlightFlags_None;
+}
+
+static ImU64 HashHighlightRanges(const ImVector<ImGuiHexEditorHighlightRange>& ranges)
+{
+	ImU64 hash = 0xcbf29ce484222325ull ^ (ImU64)ranges.Size;
+	for (const ImGuiHexEditorHighlightRange& range : ranges)
+	{
+		hash = (hash ^ (ImU64)range.From) * 0x100000001b3ull;
+		hash = (hash ^ (ImU64)range.To) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+struct ImGuiHexEditorHighlightKey
+{
+	ImS64 From;
+	int Index;
+};
+
+static int CompareHighlightKeys(const void* a, const void* b)
+{
+	const ImGuiHexEditorHighlightKey* ka = (const ImGuiHexEditorHighlightKey*)a;
+	const ImGuiHexEditorHighlightKey* kb = (const ImGuiHexEditorHighlightKey*)b;
+
+	if (ka->From != kb->From)
+		return ka->From < kb->From ? -1 : 1;
+
+	return ka->Index - kb->Index;
+}
+
+static ImS64 BuildHighlightRangesIndex(ImGuiHexEditorState* state, int lo, int hi)
+{
+	if (lo >= hi)
+		return LLONG_MIN;
+
+	const int mid = (lo + hi) / 2;
+	const ImS64 left_max = BuildHighlightRangesIndex(state, lo, mid);
+	const ImS64 right_max = BuildHighlightRangesIndex(state, mid + 1, hi);
+
+	const ImS64 max_to = ImMax(state->HighlightRanges[state->HighlightRangesOrder[mid]].To, ImMax(left_max, right_max));
+	state->HighlightRangesMaxTo[mid] = max_to;
+	return max_to;
+}
+
+static void UpdateHighlightRangesIndex(ImGuiHexEditorState* state)
+{
+	ImVector<ImGuiHexEditorHighlightRange>& ranges = state->HighlightRanges;
+
+	if (state->HighlightRangesVersion != -1)
+	{
+		if (state->HighlightRangesVersion == state->HighlightRangesIndexedVersion && state->HighlightRangesOrder.Size == ranges.Size)
+			return;
+	}
+	else
+	{
+		const ImU64 hash = HashHighlightRanges(ranges);
+		if (hash == state->HighlightRangesHash && state->HighlightRangesOrder.Size == ranges.Size)
+			return;
+
+		state->HighlightRangesHash = hash;
+	}
+
+	state->HighlightRangesIndexedVersion = state->HighlightRangesVersion;
+
+	ImVector<ImGuiHexEditorHighlightKey> keys;
+	keys.resize(ranges.Size);
+	for (int i = 0; i != ranges.Size; i++)
+	{
+		keys[i].From = ranges[i].From;
+		keys[i].Index = i;
+	}
+
+	ImQsort(keys.Data, (size_t)keys.Size, sizeof(ImGuiHexEditorHighlightKey), CompareHighlightKeys);
+
+	ImVector<int>& order = state->HighlightRangesOrder;
+	order.resize(ranges.Size);
+	for (int i = 0; i != keys.Size; i++)
+		order[i] = keys[i].Index;
+
+	state->HighlightRangesMaxTo.resize(ranges.Size);
+	BuildHighlightRangesIndex(state, 0, order.Size);
+}
+
+// Collects every range overlapping [from, to] in O(log n + k)
+static void QueryHighlightRanges(ImGuiHexEditorState* state, int lo, int hi, ImS64 from, ImS64 to, ImVector<int>& out)
+{
+	if (lo >= hi)
+		return;
+
+	const int mid = (lo + hi) / 2;
+	if (state->HighlightRangesMaxTo[mid] < from)
+		return;
+
+	QueryHighlightRanges(state, lo, mid, from, to, out);
+
+	const ImGuiHexEditorHighlightRange& range = state->HighlightRanges[state->HighlightRangesOrder[mid]];
+	if (range.From > to)
+		return;
+
+	if (range.To >= from)
+		out.push_back(state->HighlightRangesOrder[mid]);
+
+	QueryHighlightRanges(state, mid + 1, hi, from, to, out);
+}
+
+static int CompareInts(const void* a, const void* b)
+{
+	return *(const int*)a - *(const int*)b;
+}
+
+// Collects the highlight ranges of the lines [first_line, first_line + lines) of a clipper step: the HighlightRanges
+// overlapping them in their order, then the ranges HighlightRangesCallback returns for the whole step. The indices of the
+// ranges overlapping line i of the step are line_ranges[line_starts[i], line_starts[i + 1]), still in that order
+static void CollectStepHighlightRanges(ImGuiHexEditorState* state, ImS64 first_line, int lines, int bytes_per_line, ImVector<ImGuiHexEditorHighlightRange>& ranges,
+	ImVector<ImGuiHexEditorHighlightRange>& callback_ranges, ImVector<int>& line_starts, ImVector<int>& line_ranges, ImVector<int>& scratch)
+{
+	const ImS64 from = first_line * bytes_per_line;
+	const ImS64 to = ImMin((first_line + lines) * bytes_per_line, state->MaxBytes);
+
+	scratch.resize(0);
+	ranges.resize(0);
+	if (from < to)
+	{
+		QueryHighlightRanges(state, 0, state->HighlightRangesOrder.Size, from, to - 1, scratch);
+		if (scratch.Size > 1)
+			ImQsort(scratch.Data, (size_t)scratch.Size, sizeof(int), CompareInts);
+
+		ranges.resize(scratch.Size);
+		for (int i = 0; i != scratch.Size; i++)
+			ranges[i] = state->HighlightRanges[scratch[i]];
+
+		if (state->HighlightRangesCallback)
+		{
+			callback_ranges.resize(0);
+			state->HighlightRangesCallback(state, from, to, &callback_ranges);
+			IMGUI_HEX_EDITOR_STAT(HighlightRangesCalls++);
+			for (const ImGuiHexEditorHighlightRange& range : callback_ranges)
+				ranges.push_back(range);
+		}
+	}
+
+	// Counting sort by line, a range is listed on every line it overlaps
+	line_starts.resize(lines + 1);
+	memset(line_starts.Data, 0, sizeof(int) * (size_t)line_starts.Size);
+	for (const ImGuiHexEditorHighlightRange& range : ranges)
+	{
+		if (range.From > range.To || range.To < from || range.From >= to)
+			continue;
+
+		const int last = (int)(ImMin(range.To, to - 1) / bytes_per_line - first_line);
+		for (int line = (int)(ImMax(range.From, from) / bytes_per_line - first_line); line <= last; line++)
+			line_starts[line + 1]++;
+	}
+
+	for (int line = 0; line != lines; line++)
+		line_starts[line + 1] += line_starts[line];
+
+	line_ranges.resize(line_starts[lines]);
+	scratch.resize(lines);
+	memcpy(scratch.Data, line_starts.Data, sizeof(int) * (size_t)lines);
+	for (int i = 0; i != ranges.Size; i++)
+	{
+		const ImGuiHexEditorHighlightRange& range = ranges[i];
+		if (range.From > range.To || range.To < from || range.From >= to)
+			continue;
+
+		const int last = (int)(ImMin(range.To, to - 1) / bytes_per_line - first_line);
+		for (int line = (int)(ImMax(range.From, from) / bytes_per_line - first_line); line <= last; line++)
+			line_ranges[scratch[line]++] = i;
+	}
+}
+
+// Jobs, chunked passes over the source run by a pool of threads. Every worker starts on its own contiguous share of the
+// chunks, so each one reads sequentially, and steals chunks from the end of the others' shares once it runs out.
+
+template<typename T>
+struct ImGuiHexEditorThreadVector // Allocated with malloc, ImGui's allocator is only used from the main thread
+{
+	T* Data = nullptr;
+	int Size = 0;
+	int Capacity = 0;
+
+	bool push_back(const T& value)
+	{
+		if (Size == Capacity)
+		{
+			const int capacity = Capacity ? Capacity * 2 : 256;
+			T* data = (T*)realloc(Data, sizeof(T) * (size_t)capacity);
+			if (!data)
+				return false;
+
+			Data = data;
+			Capacity = capacity;
+		}
+
+		Data[Size++] = value;
+		return true;
+	}
+
+	bool resize(int size)
+	{
+		if (size > Capacity)
+		{
+			T* data = (T*)realloc(Data, sizeof(T) * (size_t)size);
+			if (!data)
+				return false;
+
+			Data = data;
+			Capacity = size;
+		}
+
+		Size = size;
+		return true;
+	}
+
+	void clear()
+	{
+		free(Data);
+		Data = nullptr;
+		Size = Capacity = 0;
+	}
+};
+
+struct ImGuiHexEditorPieceSpan
+{
+	ImS64 Start;
+	ImS64 Length;
+	const unsigned char* Data; // Add block bytes, nullptr for bytes of the original source starting at Start
+};
+
+struct ImGuiHexEditorJobWorker
+{
+	std::thread Thread;
+	std::atomic<ImU64> Chunks; // Next chunk in the low 32 bits, end of the share in the high 32 bits
+	unsigned char* Buffer = nullptr;
+	ImGuiHexEditorThreadVector<ImGuiHexEditorPieceSpan> Spans;
+};
+
+struct ImGuiHexEditorJob;
+typedef bool(*ImGuiHexEditorJobCallback)(ImGuiHexEditorJob* job, int chunk, ImS64 offset, const unsigned char* data, ImS64 size, ImS64 chunk_size);
+
+struct ImGuiHexEditorJob
+{
+	ImGuiHexEditorState* State;
+	ImS64 From;
+	ImS64 To;
+	ImS64 ChunkSize;
+	ImS64 Overlap; // Bytes read past the end of every chunk, for matches crossing into the next one
+	int ChunksCount;
+	int Root; // Version of the edit buffer being read, persistent so edits made meanwhile don't affect it
+	bool InPlace; // Plain Bytes are processed where they are instead of being copied
+	ImGuiHexEditorJobCallback Callback; // Returns false to stop the job
+	void* UserData;
+
+	ImGuiHexEditorJobWorker* Workers;
+	int WorkersCount;
+	std::atomic<bool> Cancel;
+	std::atomic<int> ChunksDone;
+	std::atomic<int> WorkersRunning;
+};
+
+static ImS64 GetSourceSize(ImGuiHexEditorState* state)
+{
+	if (state->EditBuffer)
+		return ImGui::GetHexEditorEditBufferSize(state->EditBuffer);
+
+	return state->File ? state->File->Size : state->MaxBytes;
+}
+
+// Must be called with the edit buffer mutex held
+static bool CollectPieceSpans(ImGuiHexEditorEditBuffer* buffer, int node, ImS64 base, ImS64 from, ImS64 to, ImGuiHexEditorThreadVector<ImGuiHexEditorPieceSpan>* out)
+{
+	if (node == -1 || from >= base + buffer->Nodes[node].TreeLength || to <= base)
+		return true;
+
+	const ImGuiHexEditorPiece piece = buffer->Nodes[node];
+	const ImS64 left_length = GetPieceTreeLength(buffer, piece.Left);
+
+	if (!CollectPieceSpans(buffer, piece.Left, base, from, to, out))
+		return false;
+
+	const ImS64 piece_pos = base + left_length;
+	const ImS64 piece_from = ImMax(from, piece_pos);
+	const ImS64 piece_to = ImMin(to, piece_pos + piece.Length);
+	if (piece_from < piece_to)
+	{
+		ImGuiHexEditorPieceSpan span;
+		span.Start = piece.Start + piece_from - piece_pos;
+		span.Length = piece_to - piece_from;
+		span.Data = piece.Block != -1 ? buffer->AddBlocks[piece.Block] + span.Start : nullptr;
+		if (!out->push_back(span))
+			return false;
+	}
+
+	return CollectPieceSpans(buffer, piece.Right, piece_pos + piece.Length, from, to, out);
+}
+
+// Same read path as the editor. The edit buffer is only locked while its pieces are looked up, add blocks never move
+// and the source is read without holding it so workers don't wait on each other.
+static ImS64 ReadJobBytes(ImGuiHexEditorJob* job, ImGuiHexEditorJobWorker* worker, ImS64 offset, ImS64 size, const unsigned char** out_data)
+{
+	ImGuiHexEditorState* state = job->State;
+	if (job->InPlace)
+	{
+		*out_data = (const unsigned char*)state->Bytes + offset;
+		return size;
+	}
+
+	*out_data = worker->Buffer;
+
+	ImGuiHexEditorEditBuffer* buffer = state->EditBuffer;
+	if (!buffer)
+		return ReadSourceBytes(state, offset, worker->Buffer, size);
+
+	worker->Spans.Size = 0;
+	{
+		std::lock_guard<std::mutex> lock(buffer->Mutex);
+		if (!CollectPieceSpans(buffer, job->Root, 0, offset, offset + size, &worker->Spans))
+			return 0;
+	}
+
+	ImS64 done = 0;
+	for (int i = 0; i != worker->Spans.Size; i++)
+	{
+		const ImGuiHexEditorPieceSpan& span = worker->Spans.Data[i];
+		if (span.Data)
+			memcpy(worker->Buffer + done, span.Data, (size_t)span.Length);
+		else
+		{
+			const ImS64 read = ReadSourceBytes(state, span.Start, worker->Buffer + done, span.Length);
+			if (read != span.Length)
+				return done + ImMax((ImS64)0, read);
+		}
+
+		done += span.Length;
+	}
+
+	return done;
+}
+
+static bool PopJobChunk(ImGuiHexEditorJob* job, int worker_index, int* out_chunk)
+{
+	for (int i = 0; i != job->WorkersCount; i++)
+	{
+		const bool own = i == 0;
+		std::atomic<ImU64>& chunks = job->Workers[(worker_index + i) % job->WorkersCount].Chunks;
+
+		ImU64 range = chunks.load();
+		for (;;)
+		{
+			const ImU32 front = (ImU32)range;
+			const ImU32 back = (ImU32)(range >> 32);
+			if (front >= back)
+				break;
+
+			const ImU64 next = own ? ((ImU64)back << 32) | (front + 1) : ((ImU64)(back - 1) << 32) | front;
+			if (chunks.compare_exchange_weak(range, next))
+			{
+				*out_chunk = (int)(own ? front : back - 1);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static void JobThread(ImGuiHexEditorJob* job, int worker_index)
+{
+	ImGuiHexEditorJobWorker* worker = &job->Workers[worker_index];
+
+	int chunk;
+	while (!job->Cancel && PopJobChunk(job, worker_index, &chunk))
+	{
+		const ImS64 offset = job->From + chunk * job->ChunkSize;
+		const ImS64 chunk_size = ImMin(job->ChunkSize, job->To - offset);
+		const ImS64 read_size = ImMin(chunk_size + job->Overlap, job->To - offset);
+
+		const unsigned char* data;
+		const ImS64 read = ReadJobBytes(job, worker, offset, read_size, &data);
+
+		if (!job->Callback(job, chunk, offset, data, ImMax((ImS64)0, read), chunk_size))
+			job->Cancel = true;
+
+		job->ChunksDone++;
+	}
+
+	job->WorkersRunning--;
+}
+
+static void InitJob(ImGuiHexEditorJob* job, ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImS64 overlap, ImGuiHexEditorJobCallback callback, void* user_data)
+{
+	const ImS64 size = GetSourceSize(state);
+
+	job->State = state;
+	job->From = ImClamp(from, (ImS64)0, size);
+	job->To = to == -1 ? size : ImClamp(to, job->From, size);
+	job->ChunkSize = 1024 * 1024;
+	job->Overlap = overlap;
+	job->ChunksCount = (int)((job->To - job->From + job->ChunkSize - 1) / job->ChunkSize);
+	job->Root = state->EditBuffer ? state->EditBuffer->Root : -1;
+	job->InPlace = !state->EditBuffer && !state->PageCache && !state->File && !HasReadCallback(state);
+	job->Callback = callback;
+	job->UserData = user_data;
+	job->Cancel = false;
+	job->ChunksDone = 0;
+	job->Workers = nullptr;
+	job->WorkersCount = 0;
+	job->WorkersRunning = 0;
+}
+
+static void StartJob(ImGuiHexEditorJob* job)
+{
+	ImGuiHexEditorState* state = job->State;
+	int workers_count = state->JobThreads > 0 ? state->JobThreads : (int)std::thread::hardware_concurrency();
+	workers_count = ImClamp(workers_count, 1, ImMax(job->ChunksCount, 1));
+
+	job->Workers = (ImGuiHexEditorJobWorker*)IM_ALLOC(sizeof(ImGuiHexEditorJobWorker) * (size_t)workers_count);
+	job->WorkersCount = workers_count;
+	job->WorkersRunning = workers_count;
+
+	for (int i = 0; i != workers_count; i++)
+	{
+		ImGuiHexEditorJobWorker* worker = IM_PLACEMENT_NEW(&job->Workers[i]) ImGuiHexEditorJobWorker();
+
+		const ImU64 front = (ImU64)job->ChunksCount * i / workers_count;
+		const ImU64 back = (ImU64)job->ChunksCount * (i + 1) / workers_count;
+		worker->Chunks = (back << 32) | front;
+
+		if (!job->InPlace)
+			worker->Buffer = (unsigned char*)IM_ALLOC((size_t)(job->ChunkSize + job->Overlap));
+	}
+
+	for (int i = 0; i != workers_count; i++)
+		job->Workers[i].Thread = std::thread(JobThread, job, i);
+}
+
+static void CancelJob(ImGuiHexEditorJob* job)
+{
+	job->Cancel = true;
+	for (int i = 0; i != job->WorkersCount; i++)
+	{
+		if (job->Workers[i].Thread.joinable())
+			job->Workers[i].Thread.join();
+	}
+}
+
+static void DestroyJob(ImGuiHexEditorJob* job)
+{
+	CancelJob(job);
+	for (int i = 0; i != job->WorkersCount; i++)
+	{
+		ImGuiHexEditorJobWorker* worker = &job->Workers[i];
+		IM_FREE(worker->Buffer);
+		worker->Spans.clear();
+		worker->~ImGuiHexEditorJobWorker();
+	}
+
+	IM_FREE(job->Workers);
+}
+
+static float GetJobProgress(ImGuiHexEditorJob* job)
+{
+	if (job->WorkersRunning == 0 || job->ChunksCount == 0)
+		return 1.f;
+
+	return (float)job->ChunksDone / (float)job->ChunksCount;
+}
+
+// Search
+
+struct ImGuiHexEditorSearch
+{
+	ImGuiHexEditorJob Job;
+	ImGuiHexEditorSearchPattern Pattern;
+	int FirstAnchor; // First and last fully compared bytes of the pattern, -1 if every byte has a wildcard
+	int LastAnchor;
+	int MaxResults;
+
+	// Chunks finish out of order, their matches are only published once every chunk before them is done
+	std::mutex Mutex;
+	ImGuiHexEditorThreadVector<ImS64>* ChunkMatches;
+	bool* ChunkDone;
+	int MergedChunks;
+	int Found;
+	ImGuiHexEditorThreadVector<ImS64> Pending; // Published but not yet moved to SearchResults
+};
+
+static inline int FindLowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static inline bool MatchSearchPattern(const ImGuiHexEditorSearchPattern& pattern, const unsigned char* data)
+{
+	for (int i = 0; i != pattern.Bytes.Size; i++)
+	{
+		if ((data[i] & pattern.Mask[i]) != pattern.Bytes[i])
+			return false;
+	}
+
+	return true;
+}
+
+// Finds the matches starting in [0, limit) of data holding size bytes. Candidates are filtered on the first and last fully
+// compared bytes 16 positions at a time with SSE2, or with memchr() on the first one, before comparing the whole pattern.
+static bool ScanSearchChunk(const ImGuiHexEditorSearch* search, const unsigned char* data, ImS64 size, ImS64 limit, ImS64 base, ImGuiHexEditorThreadVector<ImS64>* out)
+{
+	const ImGuiHexEditorSearchPattern& pattern = search->Pattern;
+	const ImS64 end = ImMin(limit, size - pattern.Bytes.Size + 1);
+	const int first = search->FirstAnchor;
+	const int last = search->LastAnchor;
+
+	ImS64 pos = 0;
+	if (first == -1)
+	{
+		for (; pos < end; pos++)
+		{
+			if (MatchSearchPattern(pattern, data + pos) && !out->push_back(base + pos))
+				return false;
+		}
+
+		return true;
+	}
+
+#ifdef IMGUI_HEX_EDITOR_SSE2
+	const __m128i first_byte = _mm_set1_epi8((char)pattern.Bytes[first]);
+	const __m128i last_byte = _mm_set1_epi8((char)pattern.Bytes[last]);
+	for (; pos + 16 <= end; pos += 16)
+	{
+		const __m128i first_block = _mm_loadu_si128((const __m128i*)(data + pos + first));
+		const __m128i last_block = _mm_loadu_si128((const __m128i*)(data + pos + last));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first_block, first_byte), _mm_cmpeq_epi8(last_block, last_byte)));
+
+		while (mask)
+		{
+			const ImS64 candidate = pos + FindLowestBit(mask);
+			if (MatchSearchPattern(pattern, data + candidate) && !out->push_back(base + candidate))
+				return false;
+
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	while (pos < end)
+	{
+		const unsigned char* hit = (const unsigned char*)memchr(data + pos + first, pattern.Bytes[first], (size_t)(end - pos));
+		if (!hit)
+			break;
+
+		pos = (hit - data) - first;
+		if (data[pos + last] == pattern.Bytes[last] && MatchSearchPattern(pattern, data + pos) && !out->push_back(base + pos))
+			return false;
+
+		pos++;
+	}
+
+	return true;
+}
+
+static bool ProcessSearchChunk(ImGuiHexEditorJob* job, int chunk, ImS64 offset, const unsigned char* data, ImS64 size, ImS64 chunk_size)
+{
+	ImGuiHexEditorSearch* search = (ImGuiHexEditorSearch*)job->UserData;
+
+	ImGuiHexEditorThreadVector<ImS64> matches;
+	const bool ok = ScanSearchChunk(search, data, size, chunk_size, offset, &matches);
+
+	std::lock_guard<std::mutex> lock(search->Mutex);
+	search->ChunkMatches[chunk] = matches;
+	search->ChunkDone[chunk] = true;
+
+	while (search->MergedChunks < job->ChunksCount && search->ChunkDone[search->MergedChunks])
+	{
+		ImGuiHexEditorThreadVector<ImS64>& merged = search->ChunkMatches[search->MergedChunks++];
+		const int count = ImMin(merged.Size, search->MaxResults - search->Found);
+		for (int i = 0; i != count; i++)
+			search->Pending.push_back(merged.Data[i]);
+
+		search->Found += count;
+		merged.clear();
+
+		if (search->Found >= search->MaxResults)
+			job->Cancel = true;
+	}
+
+	return ok;
+}
+
+// Moves the published matches to SearchResults
+static void UpdateHexEditorSearch(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorSearch* search = state->Search;
+	if (!search)
+		return;
+
+	std::lock_guard<std::mutex> lock(search->Mutex);
+	if (search->Pending.Size == 0)
+		return;
+
+	const int size = state->SearchResults.Size;
+	state->SearchResults.resize(size + search->Pending.Size);
+	memcpy(state->SearchResults.Data + size, search->Pending.Data, sizeof(ImS64) * (size_t)search->Pending.Size);
+	search->Pending.Size = 0;
+}
+
+static int FindFirstSearchResult(const ImVector<ImS64>& results, ImS64 offset)
+{
+	int lo = 0;
+	int hi = results.Size;
+	while (lo < hi)
+	{
+		const int mid = lo + (hi - lo) / 2;
+		if (results[mid] < offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+// Collects the matches overlapping [from, to] merged into disjoint ranges, as pairs of first and last byte
+static void QuerySearchResults(ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImVector<ImS64>& out)
+{
+	if (!state->Search)
+		return;
+
+	const ImVector<ImS64>& results = state->SearchResults;
+	const int pattern_size = state->Search->Pattern.Bytes.Size;
+	for (int i = FindFirstSearchResult(results, from - pattern_size + 1); i != results.Size && results[i] <= to; i++)
+	{
+		const ImS64 last = results[i] + pattern_size - 1;
+		if (out.Size > 0 && results[i] <= out.back() + 1)
+			out.back() = ImMax(out.back(), last);
+		else
+		{
+			out.push_back(results[i]);
+			out.push_back(last);
+		}
+	}
+}
+
+// Statistics
+
+struct ImGuiHexEditorStatistics
+{
+	ImGuiHexEditorJob Job;
+	std::mutex Mutex;
+	ImU64 Histogram[256];
+};
+
+// Separate tables for interleaved bytes avoid stalling on consecutive increments of the same counter. Bytes are loaded
+// 8 at a time, the order they're counted in doesn't matter
+static void CountByteValues(const unsigned char* data, ImS64 size, ImU32 counts[4][256])
+{
+	ImS64 i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		ImU64 word;
+		memcpy(&word, data + i, sizeof(word));
+		counts[0][word & 0xff]++;
+		counts[1][(word >> 8) & 0xff]++;
+		counts[2][(word >> 16) & 0xff]++;
+		counts[3][(word >> 24) & 0xff]++;
+		counts[0][(word >> 32) & 0xff]++;
+		counts[1][(word >> 40) & 0xff]++;
+		counts[2][(word >> 48) & 0xff]++;
+		counts[3][word >> 56]++;
+	}
+
+	for (; i < size; i++)
+		counts[0][data[i]]++;
+}
+
+static bool ProcessStatisticsChunk(ImGuiHexEditorJob* job, int chunk, ImS64 offset, const unsigned char* data, ImS64 size, ImS64 chunk_size)
+{
+	IM_UNUSED(chunk);
+	IM_UNUSED(offset);
+	ImGuiHexEditorStatistics* statistics = (ImGuiHexEditorStatistics*)job->UserData;
+
+	ImU32 counts[4][256];
+	memset(counts, 0, sizeof(counts));
+	CountByteValues(data, ImMin(size, chunk_size), counts);
+
+	std::lock_guard<std::mutex> lock(statistics->Mutex);
+	for (int value = 0; value != 256; value++)
+		statistics->Histogram[value] += (ImU64)counts[0][value] + counts[1][value] + counts[2][value] + counts[3][value];
+
+	return true;
+}
+
+// Watch
+
+struct ImGuiHexEditorWatchRange
+{
+	ImS64 From; // Requested by the main thread
+	ImS64 Size;
+	ImU32 Generation; // Changes with From and Size, polls started before are dropped
+	ImS64 DataFrom; // Polled copy, DataSize is -1 before the first poll
+	ImS64 DataSize;
+	ImGuiHexEditorThreadVector<unsigned char> Data;
+	ImGuiHexEditorThreadVector<float> ChangeTimes; // Watch time of the last change of every byte
+};
+
+struct ImGuiHexEditorWatchRead
+{
+	ImU32 Generation;
+	ImS64 From;
+	ImS64 Size;
+	ImS64 BufferOffset;
+};
+
+struct ImGuiHexEditorWatch
+{
+	ImGuiHexEditorWatchConfig Config;
+	ImGuiHexEditorState* State;
+	std::chrono::steady_clock::time_point StartTime;
+
+	std::mutex Mutex;
+	std::condition_variable Cond;
+	std::thread Thread;
+	bool Quit = false;
+	ImU32 Generation = 0;
+	ImGuiHexEditorThreadVector<ImGuiHexEditorWatchRange> Ranges; // The first one follows the visible lines
+
+	// Only used by the watch thread
+	ImGuiHexEditorThreadVector<ImGuiHexEditorWatchRead> Reads;
+	ImGuiHexEditorThreadVector<unsigned char> ReadBuffer;
+	ImGuiHexEditorThreadVector<unsigned char> ScratchData;
+	ImGuiHexEditorThreadVector<float> ScratchTimes;
+};
+
+static float GetWatchTime(const ImGuiHexEditorWatch* watch)
+{
+	return std::chrono::duration<float>(std::chrono::steady_clock::now() - watch->StartTime).count();
+}
+
+// Stamps the bytes of new_data which differ from data and copies them over
+static void UpdateWatchBytes(unsigned char* data, const unsigned char* new_data, ImS64 size, float* change_times, float now)
+{
+	ImS64 i = 0;
+#ifdef IMGUI_HEX_EDITOR_SSE2
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i old_bytes = _mm_loadu_si128((const __m128i*)(data + i));
+		const __m128i new_bytes = _mm_loadu_si128((const __m128i*)(new_data + i));
+		unsigned int changed = ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(old_bytes, new_bytes)) & 0xffff;
+		if (!changed)
+			continue;
+
+		_mm_storeu_si128((__m128i*)(data + i), new_bytes);
+		while (changed)
+		{
+			change_times[i + FindLowestBit(changed)] = now;
+			changed &= changed - 1;
+		}
+	}
+#endif
+
+	for (; i < size; i++)
+	{
+		if (data[i] != new_data[i])
+		{
+			data[i] = new_data[i];
+			change_times[i] = now;
+		}
+	}
+}
+
+// Must be called with the watch mutex held. Bytes which were already polled at their offset keep their change times
+static bool ApplyWatchRead(ImGuiHexEditorWatch* watch, ImGuiHexEditorWatchRange* range, ImS64 from, const unsigned char* data, ImS64 size, float now)
+{
+	if (range->DataFrom == from && range->DataSize == size)
+	{
+		UpdateWatchBytes(range->Data.Data, data, size, range->ChangeTimes.Data, now);
+		return true;
+	}
+
+	if (!watch->ScratchData.resize((int)size) || !watch->ScratchTimes.resize((int)size))
+		return false;
+
+	memcpy(watch->ScratchData.Data, data, (size_t)size);
+	for (ImS64 i = 0; i != size; i++)
+		watch->ScratchTimes.Data[i] = -FLT_MAX;
+
+	if (range->DataSize > 0)
+	{
+		const ImS64 overlap_from = ImMax(from, range->DataFrom);
+		const ImS64 overlap_to = ImMin(from + size, range->DataFrom + range->DataSize);
+		if (overlap_from < overlap_to)
+		{
+			unsigned char* old_data = range->Data.Data + (overlap_from - range->DataFrom);
+			float* times = watch->ScratchTimes.Data + (overlap_from - from);
+			memcpy(times, range->ChangeTimes.Data + (overlap_from - range->DataFrom), sizeof(float) * (size_t)(overlap_to - overlap_from));
+			UpdateWatchBytes(old_data, data + (overlap_from - from), overlap_to - overlap_from, times, now);
+		}
+	}
+
+	ImSwap(range->Data, watch->ScratchData);
+	ImSwap(range->ChangeTimes, watch->ScratchTimes);
+	range->DataFrom = from;
+	range->DataSize = size;
+	return true;
+}
+
+// Every poll reads all ranges without holding the mutex, in reads of up to MaxReadSize bytes, then compares them at once
+static void WatchThread(ImGuiHexEditorWatch* watch)
+{
+	const std::chrono::duration<float> interval(ImMax(watch->Config.PollInterval, 0.f));
+	const ImS64 max_read_size = ImMax(watch->Config.MaxReadSize, (ImS64)1);
+
+	std::unique_lock<std::mutex> lock(watch->Mutex);
+	while (!watch->Quit)
+	{
+		watch->Reads.Size = 0;
+		ImS64 total_size = 0;
+		for (int i = 0; i != watch->Ranges.Size; i++)
+		{
+			const ImGuiHexEditorWatchRange& range = watch->Ranges.Data[i];
+			if (range.Size <= 0)
+				continue;
+
+			ImGuiHexEditorWatchRead read;
+			read.Generation = range.Generation;
+			read.From = range.From;
+			read.Size = range.Size;
+			read.BufferOffset = total_size;
+			if (!watch->Reads.push_back(read))
+				break;
+
+			total_size += range.Size;
+		}
+
+		lock.unlock();
+
+		bool ok = total_size <= INT_MAX && watch->ReadBuffer.resize((int)total_size);
+		for (int i = 0; ok && i != watch->Reads.Size; i++)
+		{
+			ImGuiHexEditorWatchRead& read = watch->Reads.Data[i];
+			for (ImS64 done = 0; done < read.Size;)
+			{
+				const ImS64 size = ImMin(max_read_size, read.Size - done);
+				const ImS64 got = ReadSourceBytes(watch->State, read.From + done, watch->ReadBuffer.Data + read.BufferOffset + done, size);
+				done += ImMax((ImS64)0, got);
+				if (got != size)
+				{
+					read.Size = done;
+					break;
+				}
+			}
+		}
+
+		lock.lock();
+
+		const float now = GetWatchTime(watch);
+		for (int i = 0; ok && i != watch->Reads.Size; i++)
+		{
+			const ImGuiHexEditorWatchRead& read = watch->Reads.Data[i];
+			for (int j = 0; j != watch->Ranges.Size; j++)
+			{
+				ImGuiHexEditorWatchRange* range = &watch->Ranges.Data[j];
+				if (range->Generation == read.Generation)
+				{
+					ApplyWatchRead(watch, range, read.From, watch->ReadBuffer.Data + read.BufferOffset, read.Size, now);
+					break;
+				}
+			}
+		}
+
+		watch->Cond.wait_for(lock, interval, [watch]() { return watch->Quit; });
+	}
+}
+
+// Copies the polled bytes of [offset, offset + size) with their change times, returns false if no range covers them
+static bool ReadWatchBytes(ImGuiHexEditorWatch* watch, ImS64 offset, int size, unsigned char* out_data, float* out_change_times)
+{
+	std::lock_guard<std::mutex> lock(watch->Mutex);
+	for (int i = 0; i != watch->Ranges.Size; i++)
+	{
+		const ImGuiHexEditorWatchRange& range = watch->Ranges.Data[i];
+		if (range.DataSize <= 0 || offset < range.DataFrom || offset + size > range.DataFrom + range.DataSize)
+			continue;
+
+		memcpy(out_data, range.Data.Data + (offset - range.DataFrom), (size_t)size);
+		memcpy(out_change_times, range.ChangeTimes.Data + (offset - range.DataFrom), sizeof(float) * (size_t)size);
+		return true;
+	}
+
+	return false;
+}
+
+static void SetWatchRange(ImGuiHexEditorWatch* watch, int index, ImS64 from, ImS64 size)
+{
+	ImGuiHexEditorWatchRange& range = watch->Ranges.Data[index];
+	if (range.From == from && range.Size == size)
+		return;
+
+	range.From = from;
+	range.Size = size;
+	range.Generation = ++watch->Generation;
+}
+
+static bool AddWatchRange(ImGuiHexEditorWatch* watch, ImS64 from, ImS64 size)
+{
+	ImGuiHexEditorWatchRange range;
+	memset((void*)&range, 0, sizeof(range));
+	range.From = from;
+	range.Size = size;
+	range.Generation = ++watch->Generation;
+	range.DataSize = -1;
+	return watch->Ranges.push_back(range);
+}
+
+// Write queue
+
+struct ImGuiHexEditorQueuedWrite
+{
+	ImS64 From;
+	ImS64 Written; // Set by the write thread while flushing
+	int Attempts; // Failed flushes
+	ImGuiHexEditorThreadVector<unsigned char> Data;
+};
+
+typedef ImGuiHexEditorThreadVector<ImGuiHexEditorQueuedWrite> ImGuiHexEditorQueuedWrites;
+
+enum ImGuiHexEditorWriteState_ : unsigned char
+{
+	ImGuiHexEditorWriteState_None,
+	ImGuiHexEditorWriteState_Pending,
+	ImGuiHexEditorWriteState_Failed,
+};
+
+// Every list is sorted and disjoint. Bytes of Pending are the newest, then Flushing, then Failed
+struct ImGuiHexEditorWriteQueue
+{
+	ImGuiHexEditorWriteQueueConfig Config;
+	ImGuiHexEditorState* State;
+
+	std::mutex Mutex;
+	std::condition_variable Cond;
+	std::condition_variable FlushedCond;
+	std::thread Thread;
+	bool Quit = false;
+	bool FlushRequested = false; // Flushes until Pending is empty, retrying failed ranges right away
+	ImGuiHexEditorQueuedWrites Pending;
+	ImGuiHexEditorQueuedWrites Flushing; // Swapped with Pending by the write thread, only it changes them
+	ImGuiHexEditorQueuedWrites Failed;
+};
+
+static ImS64 GetQueuedWriteEnd(const ImGuiHexEditorQueuedWrite& write)
+{
+	return write.From + write.Data.Size;
+}
+
+static void ClearQueuedWrites(ImGuiHexEditorQueuedWrites* writes)
+{
+	for (int i = 0; i != writes->Size; i++)
+		writes->Data[i].Data.clear();
+
+	writes->Size = 0;
+}
+
+// Writes the bytes over the ones already queued, touching ranges are merged into one
+static bool AddQueuedWrite(ImGuiHexEditorQueuedWrites* writes, ImS64 from, const unsigned char* data, ImS64 size, int attempts)
+{
+	const ImS64 to = from + size;
+	int first = 0;
+	while (first != writes->Size && GetQueuedWriteEnd(writes->Data[first]) < from)
+		first++;
+
+	int last = first;
+	while (last != writes->Size && writes->Data[last].From <= to)
+		last++;
+
+	ImGuiHexEditorQueuedWrite write;
+	memset((void*)&write, 0, sizeof(write));
+	write.From = from;
+	write.Attempts = attempts;
+
+	ImS64 merged_to = to;
+	if (first != last)
+	{
+		write.From = ImMin(from, writes->Data[first].From);
+		merged_to = ImMax(to, GetQueuedWriteEnd(writes->Data[last - 1]));
+	}
+
+	IM_ASSERT(merged_to - write.From <= INT_MAX && "Queued ranges are limited to 2 GiB");
+	if (!write.Data.resize((int)(merged_to - write.From)))
+		return false;
+
+	for (int i = first; i != last; i++)
+	{
+		ImGuiHexEditorQueuedWrite& old = writes->Data[i];
+		memcpy(write.Data.Data + (old.From - write.From), old.Data.Data, (size_t)old.Data.Size);
+		write.Attempts = ImMin(write.Attempts, old.Attempts);
+	}
+	memcpy(write.Data.Data + (from - write.From), data, (size_t)size);
+
+	if (first == last)
+	{
+		if (!writes->push_back(write))
+		{
+			write.Data.clear();
+			return false;
+		}
+
+		memmove((void*)(writes->Data + first + 1), (const void*)(writes->Data + first), sizeof(write) * (size_t)(writes->Size - 1 - first));
+		writes->Data[first] = write;
+		return true;
+	}
+
+	for (int i = first; i != last; i++)
+		writes->Data[i].Data.clear();
+
+	writes->Data[first] = write;
+	memmove((void*)(writes->Data + first + 1), (const void*)(writes->Data + last), sizeof(write) * (size_t)(writes->Size - last));
+	writes->Size -= last - first - 1;
+	return true;
+}
+
+// Drops the bytes [from, from + size) from the ranges, splitting the ones they're in the middle of
+static void RemoveQueuedWrites(ImGuiHexEditorQueuedWrites* writes, ImS64 from, ImS64 size)
+{
+	const ImS64 to = from + size;
+	for (int i = 0; i != writes->Size;)
+	{
+		ImGuiHexEditorQueuedWrite& write = writes->Data[i];
+		const ImS64 write_to = GetQueuedWriteEnd(write);
+		if (write_to <= from || write.From >= to)
+		{
+			i++;
+			continue;
+		}
+
+		if (write.From < from && write_to > to)
+		{
+			// The tail is copied into its own range from past the end of the cut head, its buffer doesn't move
+			const unsigned char* tail = write.Data.Data + (to - write.From);
+			write.Data.Size = (int)(from - write.From);
+			AddQueuedWrite(writes, to, tail, write_to - to, write.Attempts);
+			return;
+		}
+
+		if (write.From >= from && write_to <= to)
+		{
+			write.Data.clear();
+			memmove((void*)(writes->Data + i), (const void*)(writes->Data + i + 1), sizeof(write) * (size_t)(writes->Size - i - 1));
+			writes->Size--;
+			continue;
+		}
+
+		if (write.From < from)
+			write.Data.Size = (int)(from - write.From);
+		else
+		{
+			const int cut = (int)(to - write.From);
+			memmove(write.Data.Data, write.Data.Data + cut, (size_t)(write.Data.Size - cut));
+			write.Data.Size -= cut;
+			write.From = to;
+		}
+		i++;
+	}
+}
+
+// Adds the bytes of [from, from + size) which none of the ranges of newer covers. The gaps are collected first as
+// writes may be newer itself
+static void AddQueuedWriteUnder(ImGuiHexEditorQueuedWrites* writes, const ImGuiHexEditorQueuedWrites* newer, ImS64 from, const unsigned char* data, ImS64 size, int attempts)
+{
+	ImGuiHexEditorThreadVector<ImS64> gaps; // Pairs of first byte and end
+	const ImS64 to = from + size;
+	ImS64 at = from;
+	for (int i = 0; i != newer->Size && at < to; i++)
+	{
+		const ImGuiHexEditorQueuedWrite& write = newer->Data[i];
+		if (write.From >= to)
+			break;
+
+		if (write.From > at)
+		{
+			gaps.push_back(at);
+			gaps.push_back(write.From);
+		}
+		at = ImMax(at, GetQueuedWriteEnd(write));
+	}
+
+	if (at < to)
+	{
+		gaps.push_back(at);
+		gaps.push_back(to);
+	}
+
+	for (int i = 0; i + 1 < gaps.Size; i += 2)
+		AddQueuedWrite(writes, gaps.Data[i], data + (gaps.Data[i] - from), gaps.Data[i + 1] - gaps.Data[i], attempts);
+
+	gaps.clear();
+}
+
+static void ApplyQueuedWrites(const ImGuiHexEditorQueuedWrites* writes, ImS64 offset, unsigned char* buf, ImS64 size, unsigned char* out_states, unsigned char write_state)
+{
+	for (int i = 0; i != writes->Size; i++)
+	{
+		const ImGuiHexEditorQueuedWrite& write = writes->Data[i];
+		const ImS64 from = ImMax(offset, write.From);
+		const ImS64 to = ImMin(offset + size, GetQueuedWriteEnd(write));
+		if (write.From >= offset + size)
+			break;
+
+		if (from >= to)
+			continue;
+
+		if (buf)
+			memcpy(buf + (from - offset), write.Data.Data + (from - write.From), (size_t)(to - from));
+		if (out_states)
+			memset(out_states + (from - offset), write_state, (size_t)(to - from));
+	}
+}
+
+static bool OverlapsQueuedWrites(const ImGuiHexEditorQueuedWrites* writes, ImS64 offset, ImS64 size)
+{
+	for (int i = 0; i != writes->Size; i++)
+	{
+		if (writes->Data[i].From >= offset + size)
+			break;
+
+		if (GetQueuedWriteEnd(writes->Data[i]) > offset)
+			return true;
+	}
+
+	return false;
+}
+
+// Copies data into scratch when queued bytes overlap it, then writes them over it
+static const unsigned char* ApplyWriteQueue(ImGuiHexEditorWriteQueue* queue, ImS64 offset, const unsigned char* data, ImS64 size, unsigned char* scratch)
+{
+	std::lock_guard<std::mutex> lock(queue->Mutex);
+	if (!OverlapsQueuedWrites(&queue->Pending, offset, size) && !OverlapsQueuedWrites(&queue->Flushing, offset, size) && !OverlapsQueuedWrites(&queue->Failed, offset, size))
+		return data;
+
+	if (data != scratch)
+		memcpy(scratch, data, (size_t)size);
+
+	ApplyQueuedWrites(&queue->Failed, offset, scratch, size, nullptr, 0);
+	ApplyQueuedWrites(&queue->Flushing, offset, scratch, size, nullptr, 0);
+	ApplyQueuedWrites(&queue->Pending, offset, scratch, size, nullptr, 0);
+	return scratch;
+}
+
+// Fills out_states with the ImGuiHexEditorWriteState_ of every byte, returns false if none is queued
+static bool QueryWriteStates(ImGuiHexEditorWriteQueue* queue, ImS64 offset, int size, unsigned char* out_states)
+{
+	std::lock_guard<std::mutex> lock(queue->Mutex);
+	if (!OverlapsQueuedWrites(&queue->Pending, offset, size) && !OverlapsQueuedWrites(&queue->Flushing, offset, size) && !OverlapsQueuedWrites(&queue->Failed, offset, size))
+		return false;
+
+	memset(out_states, ImGuiHexEditorWriteState_None, (size_t)size);
+	ApplyQueuedWrites(&queue->Failed, offset, nullptr, size, out_states, ImGuiHexEditorWriteState_Failed);
+	ApplyQueuedWrites(&queue->Flushing, offset, nullptr, size, out_states, ImGuiHexEditorWriteState_Pending);
+	ApplyQueuedWrites(&queue->Pending, offset, nullptr, size, out_states, ImGuiHexEditorWriteState_Pending);
+	return true;
+}
+
+static ImS64 QueueWrite(ImGuiHexEditorWriteQueue* queue, ImS64 offset, const unsigned char* data, ImS64 size)
+{
+	{
+		std::lock_guard<std::mutex> lock(queue->Mutex);
+		if (!AddQueuedWrite(&queue->Pending, offset, data, size, 0))
+			return 0;
+
+		// Failed bytes written again are superseded
+		RemoveQueuedWrites(&queue->Failed, offset, size);
+	}
+
+	if (queue->Config.FlushInterval == 0.f)
+		queue->Cond.notify_one();
+
+	return size;
+}
+
+// Every flush writes the pending ranges without holding the mutex. Unwritten bytes go back under the newer pending
+// bytes until they failed MaxRetries times, then to Failed
+static void WriteQueueThread(ImGuiHexEditorWriteQueue* queue)
+{
+	const float flush_interval = queue->Config.FlushInterval;
+	const std::chrono::duration<float> interval(ImMax(flush_interval, 0.f));
+	const ImS64 max_write_size = ImMax(queue->Config.MaxWriteSize, (ImS64)1);
+
+	std::unique_lock<std::mutex> lock(queue->Mutex);
+	for (;;)
+	{
+		if (queue->Pending.Size == 0)
+		{
+			if (queue->FlushRequested)
+			{
+				queue->FlushRequested = false;
+				queue->FlushedCond.notify_all();
+			}
+
+			if (queue->Quit)
+				break;
+		}
+
+		if (!queue->Quit && !queue->FlushRequested)
+		{
+			if (flush_interval > 0.f)
+				queue->Cond.wait_for(lock, interval, [queue]() { return queue->Quit || queue->FlushRequested; });
+			else
+				queue->Cond.wait(lock, [queue, flush_interval]() { return queue->Quit || queue->FlushRequested || (flush_interval == 0.f && queue->Pending.Size != 0); });
+		}
+
+		if (queue->Pending.Size == 0)
+			continue;
+
+		ImSwap(queue->Pending, queue->Flushing);
+		lock.unlock();
+
+		for (int i = 0; i != queue->Flushing.Size; i++)
+		{
+			ImGuiHexEditorQueuedWrite& write = queue->Flushing.Data[i];
+			write.Written = 0;
+			while (write.Written < write.Data.Size)
+			{
+				const ImS64 size = ImMin(max_write_size, write.Data.Size - write.Written);
+				const ImS64 written = WriteSourceBytes(queue->State, write.From + write.Written, write.Data.Data + write.Written, size);
+				write.Written += ImClamp(written, (ImS64)0, size);
+				if (written != size)
+					break;
+			}
+		}
+
+		lock.lock();
+		for (int i = 0; i != queue->Flushing.Size; i++)
+		{
+			const ImGuiHexEditorQueuedWrite& write = queue->Flushing.Data[i];
+			if (write.Written == write.Data.Size)
+				continue;
+
+			const ImS64 from = write.From + write.Written;
+			const ImS64 size = write.Data.Size - write.Written;
+			const unsigned char* data = write.Data.Data + write.Written;
+			if (write.Attempts < queue->Config.MaxRetries)
+				AddQueuedWriteUnder(&queue->Pending, &queue->Pending, from, data, size, write.Attempts + 1);
+			else
+				AddQueuedWriteUnder(&queue->Failed, &queue->Pending, from, data, size, write.Attempts + 1);
+		}
+		ClearQueuedWrites(&queue->Flushing);
+	}
+}
+
+// Diff
+
+// Bytes of one source around the compared position, only moving forward
+struct ImGuiHexEditorDiffWindow
+{
+	ImGuiHexEditorThreadVector<unsigned char> Data;
+	ImS64 From;
+};
+
+struct ImGuiHexEditorDiffBlock
+{
+	ImU32 Hash;
+	ImS64 Offset; // -1 for empty slots
+};
+
+struct ImGuiHexEditorDiff
+{
+	ImGuiHexEditorState* States[2];
+	ImGuiHexEditorDiffFlags Flags;
+	int BlockSize;
+	ImS64 Lookahead;
+	ImS64 Sizes[2];
+	int Leader = 0; // Pane whose scrolling the other one follows
+
+	std::thread Thread;
+	std::atomic<bool> Cancel;
+	std::atomic<bool> Running;
+	std::atomic<ImS64> Progress; // Bytes of the first source compared so far
+
+	std::mutex Mutex;
+	ImGuiHexEditorThreadVector<ImGuiHexEditorDiffHunk> Pending; // Found but not yet moved to Hunks
+	ImVector<ImGuiHexEditorDiffHunk> Hunks;
+
+	// Only used by the diff thread
+	ImGuiHexEditorDiffWindow Windows[2];
+	ImGuiHexEditorThreadVector<ImGuiHexEditorDiffBlock> Blocks;
+	ImGuiHexEditorDiffHunk Current; // Extended while the following differences touch it
+	bool HasCurrent = false;
+};
+
+// Makes [offset, offset + size) of a source available, reading ahead by a few lookaheads at once. Returns the number of
+// bytes available, less than size at the end of the source or when reading failed
+static ImS64 LoadDiffBytes(ImGuiHexEditorDiff* diff, int side, ImS64 offset, ImS64 size, const unsigned char** out_data)
+{
+	ImGuiHexEditorDiffWindow& window = diff->Windows[side];
+	size = ImMin(size, diff->Sizes[side] - offset);
+
+	if (offset < window.From || offset + size > window.From + window.Data.Size)
+	{
+		const ImS64 read_size = ImMin(ImMax(size, diff->Lookahead * 4), diff->Sizes[side] - offset);
+		window.From = offset;
+		if (read_size > INT_MAX || !window.Data.resize((int)read_size))
+		{
+			window.Data.Size = 0;
+			return 0;
+		}
+
+		window.Data.Size = (int)ImMax((ImS64)0, ReadSourceBytes(diff->States[side], offset, window.Data.Data, read_size));
+	}
+
+	*out_data = window.Data.Data + (offset - window.From);
+	return ImMax((ImS64)0, ImMin(size, window.From + window.Data.Size - offset));
+}
+
+static ImS64 CountEqualBytes(const unsigned char* a, const unsigned char* b, ImS64 size)
+{
+	ImS64 i = 0;
+#ifdef IMGUI_HEX_EDITOR_SSE2
+	for (; i + 16 <= size; i += 16)
+	{
+		const unsigned int equal = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i))));
+		if (equal != 0xffff)
+			return i + FindLowestBit(~equal);
+	}
+#endif
+
+	while (i < size && a[i] == b[i])
+		i++;
+
+	return i;
+}
+
+// rsync's weak checksum, cheap to roll one byte forward
+static inline ImU32 CalcDiffBlockHash(const unsigned char* data, int size, ImU32* out_a, ImU32* out_b)
+{
+	ImU32 a = 0;
+	ImU32 b = 0;
+	for (int i = 0; i != size; i++)
+	{
+		a += data[i];
+		b += (ImU32)(size - i) * data[i];
+	}
+
+	*out_a = a & 0xffff;
+	*out_b = b & 0xffff;
+	return *out_a | (*out_b << 16);
+}
+
+static inline ImU32 GetDiffBlockSlot(ImU32 hash, int mask)
+{
+	return (hash * 2654435761u) & (ImU32)mask;
+}
+
+static void AddDiffHunk(ImGuiHexEditorDiff* diff, ImS64 from_a, ImS64 size_a, ImS64 from_b, ImS64 size_b)
+{
+	ImGuiHexEditorDiffHunk& current = diff->Current;
+	if (diff->HasCurrent && current.From[0] + current.Size[0] == from_a && current.From[1] + current.Size[1] == from_b)
+	{
+		current.Size[0] += size_a;
+		current.Size[1] += size_b;
+		return;
+	}
+
+	if (diff->HasCurrent)
+	{
+		std::lock_guard<std::mutex> lock(diff->Mutex);
+		diff->Pending.push_back(current);
+	}
+
+	current.From[0] = from_a;
+	current.From[1] = from_b;
+	current.Size[0] = size_a;
+	current.Size[1] = size_b;
+	diff->HasCurrent = true;
+}
+
+// Finds where the sources match again after a difference at pos. Bytes changed in place are found by comparing at the
+// same distance from pos. With ImGuiHexEditorDiffFlags_Align, blocks of the second source within the lookahead are
+// hashed and the first source is scanned with a rolling hash for one of them, which finds inserted and deleted bytes
+static void FindDiffResync(ImGuiHexEditorDiff* diff, const ImS64 pos[2], ImS64 out_skip[2])
+{
+	const bool align = (diff->Flags & ImGuiHexEditorDiffFlags_Align) != 0;
+	const int block_size = diff->BlockSize;
+	const int sync = align ? block_size : 1;
+
+	const unsigned char* a;
+	const unsigned char* b;
+	const ImS64 size_a = LoadDiffBytes(diff, 0, pos[0], diff->Lookahead + block_size, &a);
+	const ImS64 size_b = LoadDiffBytes(diff, 1, pos[1], diff->Lookahead + block_size, &b);
+
+	// In place changes, only searched a few blocks far when realigning since the rolling hash finds longer ones
+	const ImS64 in_place_limit = align ? ImMin(ImMin(size_a, size_b), (ImS64)block_size * 8) : ImMin(size_a, size_b);
+	int run = 0;
+	for (ImS64 i = 1; i < in_place_limit; i++)
+	{
+		run = a[i] == b[i] ? run + 1 : 0;
+		if (run == sync)
+		{
+			out_skip[0] = out_skip[1] = i - sync + 1;
+			return;
+		}
+	}
+
+	if (!align || size_a < block_size || size_b < block_size)
+	{
+		out_skip[0] = out_skip[1] = ImMax(in_place_limit, (ImS64)1);
+		if (align)
+		{
+			out_skip[0] = size_a;
+			out_skip[1] = size_b;
+		}
+		return;
+	}
+
+	// Hash table of the blocks of the second source, the first block at every hash is the closest one
+	const int blocks_count = (int)(size_b / block_size);
+	int slots_count = 16;
+	while (slots_count < blocks_count * 2)
+		slots_count <<= 1;
+
+	if (!diff->Blocks.resize(slots_count))
+	{
+		out_skip[0] = size_a;
+		out_skip[1] = size_b;
+		return;
+	}
+
+	for (int i = 0; i != slots_count; i++)
+		diff->Blocks.Data[i].Offset = -1;
+
+	for (int i = 0; i != blocks_count; i++)
+	{
+		ImU32 block_a, block_b;
+		const ImU32 hash = CalcDiffBlockHash(b + (ImS64)i * block_size, block_size, &block_a, &block_b);
+		ImU32 slot = GetDiffBlockSlot(hash, slots_count - 1);
+		while (diff->Blocks.Data[slot].Offset != -1 && diff->Blocks.Data[slot].Hash != hash)
+			slot = (slot + 1) & (ImU32)(slots_count - 1);
+
+		if (diff->Blocks.Data[slot].Offset == -1)
+		{
+			diff->Blocks.Data[slot].Hash = hash;
+			diff->Blocks.Data[slot].Offset = (ImS64)i * block_size;
+		}
+	}
+
+	ImU32 roll_a, roll_b;
+	ImU32 hash = CalcDiffBlockHash(a, block_size, &roll_a, &roll_b);
+	for (ImS64 q = 0; q + block_size <= size_a; q++)
+	{
+		if (q > 0)
+		{
+			// Roll the window one byte forward
+			const ImU32 out = a[q - 1];
+			const ImU32 in = a[q + block_size - 1];
+			roll_a = (roll_a - out + in) & 0xffff;
+			roll_b = (roll_b - (ImU32)block_size * out + roll_a) & 0xffff;
+			hash = roll_a | (roll_b << 16);
+		}
+
+		ImU32 slot = GetDiffBlockSlot(hash, slots_count - 1);
+		while (diff->Blocks.Data[slot].Offset != -1 && diff->Blocks.Data[slot].Hash != hash)
+			slot = (slot + 1) & (ImU32)(slots_count - 1);
+
+		const ImS64 offset_b = diff->Blocks.Data[slot].Offset;
+		if (offset_b == -1 || memcmp(a + q, b + offset_b, (size_t)block_size) != 0)
+			continue;
+
+		// Matching bytes right before the block aren't part of the difference
+		ImS64 skip_a = q;
+		ImS64 skip_b = offset_b;
+		while (skip_a > 0 && skip_b > 0 && a[skip_a - 1] == b[skip_b - 1])
+		{
+			skip_a--;
+			skip_b--;
+		}
+
+		out_skip[0] = skip_a;
+		out_skip[1] = skip_b;
+		return;
+	}
+
+	// Nothing in common within the lookahead
+	out_skip[0] = ImMin(size_a, diff->Lookahead);
+	out_skip[1] = ImMin(size_b, diff->Lookahead);
+}
+
+static void DiffThread(ImGuiHexEditorDiff* diff)
+{
+	const ImS64 chunk_size = 64 * 1024;
+	ImS64 pos[2] = { 0, 0 };
+
+	while (!diff->Cancel && pos[0] < diff->Sizes[0] && pos[1] < diff->Sizes[1])
+	{
+		const unsigned char* a;
+		const unsigned char* b;
+		const ImS64 size = ImMin(LoadDiffBytes(diff, 0, pos[0], chunk_size, &a), LoadDiffBytes(diff, 1, pos[1], chunk_size, &b));
+		if (size == 0)
+			break;
+
+		const ImS64 equal = CountEqualBytes(a, b, size);
+		pos[0] += equal;
+		pos[1] += equal;
+
+		if (equal == size)
+		{
+			diff->Progress = pos[0];
+			continue;
+		}
+
+		ImS64 skip[2];
+		FindDiffResync(diff, pos, skip);
+		AddDiffHunk(diff, pos[0], skip[0], pos[1], skip[1]);
+
+		pos[0] += skip[0];
+		pos[1] += skip[1];
+		diff->Progress = pos[0];
+	}
+
+	if (!diff->Cancel && (pos[0] < diff->Sizes[0] || pos[1] < diff->Sizes[1]))
+		AddDiffHunk(diff, pos[0], diff->Sizes[0] - pos[0], pos[1], diff->Sizes[1] - pos[1]);
+
+	if (diff->HasCurrent)
+	{
+		std::lock_guard<std::mutex> lock(diff->Mutex);
+		diff->Pending.push_back(diff->Current);
+		diff->HasCurrent = false;
+	}
+
+	diff->Progress = diff->Sizes[0];
+	diff->Running = false;
+}
+
+// Moves the published hunks to Hunks
+static void UpdateHexEditorDiff(ImGuiHexEditorDiff* diff)
+{
+	std::lock_guard<std::mutex> lock(diff->Mutex);
+	if (diff->Pending.Size == 0)
+		return;
+
+	const int size = diff->Hunks.Size;
+	diff->Hunks.resize(size + diff->Pending.Size);
+	memcpy(diff->Hunks.Data + size, diff->Pending.Data, sizeof(ImGuiHexEditorDiffHunk) * (size_t)diff->Pending.Size);
+	diff->Pending.Size = 0;
+}
+
+// First hunk ending after offset in the source of side
+static int FindFirstDiffHunk(const ImGuiHexEditorDiff* diff, int side, ImS64 offset)
+{
+	int lo = 0;
+	int hi = diff->Hunks.Size;
+	while (lo < hi)
+	{
+		const int mid = lo + (hi - lo) / 2;
+		const ImGuiHexEditorDiffHunk& hunk = diff->Hunks[mid];
+		if (hunk.From[side] + hunk.Size[side] <= offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+// Collects the differing bytes overlapping [from, to] as pairs of first and last byte
+static void QueryDiffHunks(const ImGuiHexEditorDiff* diff, int side, ImS64 from, ImS64 to, ImVector<ImS64>& out)
+{
+	for (int i = FindFirstDiffHunk(diff, side, from); i != diff->Hunks.Size && diff->Hunks[i].From[side] <= to; i++)
+	{
+		const ImGuiHexEditorDiffHunk& hunk = diff->Hunks[i];
+		if (hunk.Size[side] == 0)
+			continue;
+
+		const ImS64 last = hunk.From[side] + hunk.Size[side] - 1;
+		if (out.Size > 0 && hunk.From[side] <= out.back() + 1)
+			out.back() = ImMax(out.back(), last);
+		else
+		{
+			out.push_back(hunk.From[side]);
+			out.push_back(last);
+		}
+	}
+}
+
+// Offset of the other source lined up with offset, equal bytes between the hunks found so far are paired in order
+static ImS64 MapDiffOffset(const ImGuiHexEditorDiff* diff, int side, ImS64 offset)
+{
+	const int other = 1 - side;
+	int i = FindFirstDiffHunk(diff, side, offset);
+	ImS64 mapped;
+	if (i != diff->Hunks.Size && diff->Hunks[i].From[side] <= offset)
+	{
+		const ImGuiHexEditorDiffHunk& hunk = diff->Hunks[i];
+		mapped = hunk.From[other] + ImMin(offset - hunk.From[side], ImMax(hunk.Size[other] - 1, (ImS64)0));
+	}
+	else if (i > 0)
+	{
+		const ImGuiHexEditorDiffHunk& hunk = diff->Hunks[i - 1];
+		mapped = hunk.From[other] + hunk.Size[other] + (offset - hunk.From[side] - hunk.Size[side]);
+	}
+	else
+		mapped = offset;
+
+	return ImClamp(mapped, (ImS64)0, ImMax(diff->Sizes[other] - 1, (ImS64)0));
+}
+
+// Template
+
+struct ImGuiHexEditorTemplateStruct
+{
+	int Name; // Offset in Names
+	ImS64 Size;
+	int FirstField; // In StructFields, set by the layout pass
+	int FieldsCount;
+	int LayoutState; // 0 not laid out, 1 being laid out, 2 done
+};
+
+struct ImGuiHexEditorTemplateField
+{
+	int Struct;
+	int Name; // Offset in Names, -1 for padding
+	ImGuiHexEditorFieldType Type;
+	ImGuiHexEditorFieldType Target; // Type pointed to by pointers, -1 when not followed
+	int Count;
+	ImGuiHexEditorFieldFlags Flags;
+	ImU32 Color;
+	ImS64 Offset; // From the start of the struct, set by the layout pass
+};
+
+// Instance of a struct, an element of an array of them or the target of a pointer
+struct ImGuiHexEditorTemplateNode
+{
+	ImS64 Offset;
+	ImGuiHexEditorFieldType Type;
+	int Field; // Field of the parent node holding it (the pointer field for targets), -1 for roots
+	int Index; // Array element, -1 when the field isn't an array
+	int Parent;
+	bool Pointee;
+	int FirstLeaf; // In NodeLeaves, the leaves whose Node is this one
+	int LeavesCount;
+};
+
+// Instance of a primitive field, arrays of them are a single leaf
+struct ImGuiHexEditorTemplateLeaf
+{
+	ImS64 Offset;
+	ImS64 Size;
+	ImGuiHexEditorFieldType Type;
+	ImGuiHexEditorFieldFlags Flags;
+	int Field; // -1 for the value of the node itself, a primitive root or the primitive target of a pointer
+	int Node; // -1 for primitive roots
+	ImU32 Color;
+};
+
+struct ImGuiHexEditorTemplatePointer
+{
+	ImS64 Offset;
+	int Field;
+	int Index;
+	int Node;
+};
+
+struct ImGuiHexEditorTemplateTarget
+{
+	ImS64 Offset;
+	ImGuiHexEditorFieldType Type; // -1 for empty slots
+};
+
+struct ImGuiHexEditorTemplate
+{
+	ImVector<char> Names;
+	ImVector<ImGuiHexEditorTemplateStruct> Structs;
+	ImVector<ImGuiHexEditorTemplateField> Fields;
+	ImVector<int> StructFields; // Fields grouped by struct in the order they were added
+
+	// Compiled table
+	ImVector<ImGuiHexEditorTemplateNode> Nodes;
+	ImVector<ImGuiHexEditorTemplateLeaf> Leaves; // Sorted by Offset
+	ImVector<ImS64> LeavesMaxEnd; // Max end of the leaves up to every index, bounds the backward scan of overlapping leaves
+	ImVector<int> NodeLeaves;
+
+	// Compile scratch
+	ImVector<ImGuiHexEditorTemplatePointer> Pointers;
+	ImVector<ImGuiHexEditorTemplateTarget> Targets; // Open addressing set of the followed pointer targets
+	int TargetsCount = 0;
+	int MaxLeaves = 0;
+};
+
+static const int TemplatePrimitiveSizes[ImGuiHexEditorFieldType_COUNT] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8, 1, 4, 8 };
+static const char* const TemplatePrimitiveNames[ImGuiHexEditorFieldType_COUNT] = { "s8", "u8", "s16", "u16", "s32", "u32", "s64", "u64", "float", "double", "char", "ptr32", "ptr64" };
+
+static int AddTemplateName(ImGuiHexEditorTemplate* tpl, const char* name)
+{
+	if (!name)
+		return -1;
+
+	const int offset = tpl->Names.Size;
+	tpl->Names.resize(offset + (int)strlen(name) + 1);
+	memcpy(tpl->Names.Data + offset, name, strlen(name) + 1);
+	return offset;
+}
+
+static const char* GetTemplateTypeName(const ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType type)
+{
+	if (type < ImGuiHexEditorFieldType_COUNT)
+		return TemplatePrimitiveNames[type];
+
+	return tpl->Names.Data + tpl->Structs[type - ImGuiHexEditorFieldType_COUNT].Name;
+}
+
+// Assigns the offsets of the fields of a struct and the structs it contains, returns -1 if it contains itself
+static ImS64 LayoutTemplateType(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType type)
+{
+	if (type < ImGuiHexEditorFieldType_COUNT)
+		return TemplatePrimitiveSizes[type];
+
+	ImGuiHexEditorTemplateStruct& st = tpl->Structs[type - ImGuiHexEditorFieldType_COUNT];
+	if (st.LayoutState == 1)
+		return -1;
+
+	if (st.LayoutState == 2)
+		return st.Size;
+
+	st.LayoutState = 1;
+	ImS64 size = 0;
+	for (int i = 0; i != st.FieldsCount; i++)
+	{
+		ImGuiHexEditorTemplateField& field = tpl->Fields[tpl->StructFields[st.FirstField + i]];
+		const ImS64 field_size = LayoutTemplateType(tpl, field.Type);
+		if (field_size < 0)
+			return -1;
+
+		field.Offset = size;
+		size += field_size * field.Count;
+	}
+
+	st.Size = size;
+	st.LayoutState = 2;
+	return size;
+}
+
+static ImS64 GetTemplateTypeSize(const ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType type)
+{
+	return type < ImGuiHexEditorFieldType_COUNT ? TemplatePrimitiveSizes[type] : tpl->Structs[type - ImGuiHexEditorFieldType_COUNT].Size;
+}
+
+// Colors of fields without one alternate along the struct, so neighbours always differ
+static ImU32 GetTemplateFieldColor(const ImGuiHexEditorTemplateField& field, int position)
+{
+	if (field.Color)
+		return field.Color;
+
+	return ImColor::HSV((float)(position % 6) / 6.f, 0.5f, 0.9f, 0.35f);
+}
+
+static ImU32 HashTemplateTarget(ImS64 offset, ImGuiHexEditorFieldType type)
+{
+	ImU64 hash = ((ImU64)offset ^ ((ImU64)type << 48)) * 0x9E3779B97F4A7C15ull;
+	return (ImU32)(hash >> 32);
+}
+
+// Returns false if the target was already added
+static bool AddTemplateTarget(ImGuiHexEditorTemplate* tpl, ImS64 offset, ImGuiHexEditorFieldType type)
+{
+	if ((tpl->TargetsCount + 1) * 2 > tpl->Targets.Size)
+	{
+		ImVector<ImGuiHexEditorTemplateTarget> old_targets;
+		old_targets.swap(tpl->Targets);
+		tpl->Targets.resize(ImMax(old_targets.Size * 2, 64));
+		for (ImGuiHexEditorTemplateTarget& target : tpl->Targets)
+			target.Type = -1;
+
+		tpl->TargetsCount = 0;
+		for (const ImGuiHexEditorTemplateTarget& target : old_targets)
+		{
+			if (target.Type != -1)
+				AddTemplateTarget(tpl, target.Offset, target.Type);
+		}
+	}
+
+	const int mask = tpl->Targets.Size - 1;
+	for (int slot = (int)(HashTemplateTarget(offset, type) & mask);; slot = (slot + 1) & mask)
+	{
+		ImGuiHexEditorTemplateTarget& target = tpl->Targets[slot];
+		if (target.Type == -1)
+		{
+			target.Offset = offset;
+			target.Type = type;
+			tpl->TargetsCount++;
+			return true;
+		}
+
+		if (target.Offset == offset && target.Type == type)
+			return false;
+	}
+}
+
+static int AddTemplateNode(ImGuiHexEditorTemplate* tpl, ImS64 offset, ImGuiHexEditorFieldType type, int field, int index, int parent, bool pointee)
+{
+	ImGuiHexEditorTemplateNode node;
+	node.Offset = offset;
+	node.Type = type;
+	node.Field = field;
+	node.Index = index;
+	node.Parent = parent;
+	node.Pointee = pointee;
+	node.FirstLeaf = 0;
+	node.LeavesCount = 0;
+	tpl->Nodes.push_back(node);
+	return tpl->Nodes.Size - 1;
+}
+
+static void ExpandTemplateNode(ImGuiHexEditorTemplate* tpl, int node);
+
+// Expands count consecutive values of type into nodes and leaves, pointers to follow are queued into Pointers
+static void ExpandTemplateType(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType type, ImS64 offset, int count, int field, int index, int parent, ImU32 color)
+{
+	if (tpl->Leaves.Size >= tpl->MaxLeaves)
+		return;
+
+	if (type < ImGuiHexEditorFieldType_COUNT)
+	{
+		ImGuiHexEditorTemplateLeaf leaf;
+		leaf.Offset = offset;
+		leaf.Size = (ImS64)TemplatePrimitiveSizes[type] * count;
+		leaf.Type = type;
+		leaf.Flags = field != -1 ? tpl->Fields[field].Flags : 0;
+		leaf.Field = field;
+		leaf.Node = parent;
+		leaf.Color = color;
+		tpl->Leaves.push_back(leaf);
+
+		if (field != -1 && tpl->Fields[field].Target != -1)
+		{
+			for (int i = 0; i != count; i++)
+			{
+				ImGuiHexEditorTemplatePointer pointer;
+				pointer.Offset = offset + (ImS64)TemplatePrimitiveSizes[type] * i;
+				pointer.Field = field;
+				pointer.Index = count > 1 ? i : -1;
+				pointer.Node = parent;
+				tpl->Pointers.push_back(pointer);
+			}
+		}
+		return;
+	}
+
+	// Elements past the cap would only add nodes without leaves
+	const ImS64 size = tpl->Structs[type - ImGuiHexEditorFieldType_COUNT].Size;
+	for (int i = 0; i != count && tpl->Leaves.Size < tpl->MaxLeaves; i++)
+		ExpandTemplateNode(tpl, AddTemplateNode(tpl, offset + size * i, type, field, count > 1 ? i : index, parent, false));
+}
+
+static void ExpandTemplateNode(ImGuiHexEditorTemplate* tpl, int node)
+{
+	const ImS64 offset = tpl->Nodes[node].Offset;
+	const ImGuiHexEditorFieldType type = tpl->Nodes[node].Type;
+	if (type < ImGuiHexEditorFieldType_COUNT)
+	{
+		ExpandTemplateType(tpl, type, offset, 1, -1, -1, node, GetTemplateFieldColor(tpl->Fields[tpl->Nodes[node].Field], 0));
+		return;
+	}
+
+	const ImGuiHexEditorTemplateStruct& st = tpl->Structs[type - ImGuiHexEditorFieldType_COUNT];
+	for (int i = 0; i != st.FieldsCount; i++)
+	{
+		const int field = tpl->StructFields[st.FirstField + i];
+		const ImGuiHexEditorTemplateField& child = tpl->Fields[field];
+		if (child.Name != -1 && child.Count > 0)
+			ExpandTemplateType(tpl, child.Type, offset + child.Offset, child.Count, field, -1, node, GetTemplateFieldColor(child, i));
+	}
+}
+
+static int CompareTemplateLeaves(const void* a, const void* b)
+{
+	const ImGuiHexEditorTemplateLeaf* leaf_a = (const ImGuiHexEditorTemplateLeaf*)a;
+	const ImGuiHexEditorTemplateLeaf* leaf_b = (const ImGuiHexEditorTemplateLeaf*)b;
+	if (leaf_a->Offset != leaf_b->Offset)
+		return leaf_a->Offset < leaf_b->Offset ? -1 : 1;
+
+	// Outer nodes were added first, so ties keep the innermost leaf last
+	return leaf_a->Node < leaf_b->Node ? -1 : leaf_a->Node > leaf_b->Node ? 1 : 0;
+}
+
+static ImU64 LoadValueBits(const unsigned char* data, int size, bool big_endian)
+{
+	ImU64 bits = 0;
+	for (int i = 0; i != size; i++)
+		bits |= (ImU64)data[i] << ((big_endian ? size - 1 - i : i) * 8);
+
+	return bits;
+}
+
+static void FormatTemplateValue(char* buf, int buf_size, ImGuiHexEditorFieldType type, ImGuiHexEditorFieldFlags flags, const unsigned char* data)
+{
+	const int size = TemplatePrimitiveSizes[type];
+	const ImU64 bits = LoadValueBits(data, size, (flags & ImGuiHexEditorFieldFlags_BigEndian) != 0);
+
+	switch (type)
+	{
+	case ImGuiHexEditorFieldType_Float:
+	{
+		const ImU32 value_bits = (ImU32)bits;
+		float value;
+		memcpy(&value, &value_bits, sizeof(value));
+		ImFormatString(buf, (size_t)buf_size, "%g", value);
+		break;
+	}
+	case ImGuiHexEditorFieldType_Double:
+	{
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		ImFormatString(buf, (size_t)buf_size, "%g", value);
+		break;
+	}
+	case ImGuiHexEditorFieldType_Char:
+		if (HasAsciiRepresentation(data[0]))
+			ImFormatString(buf, (size_t)buf_size, "'%c'", data[0]);
+		else
+			ImFormatString(buf, (size_t)buf_size, "0x%02X", data[0]);
+		break;
+	case ImGuiHexEditorFieldType_Pointer32:
+	case ImGuiHexEditorFieldType_Pointer64:
+		ImFormatString(buf, (size_t)buf_size, "0x%0*llX", size * 2, (unsigned long long)bits);
+		break;
+	case ImGuiHexEditorFieldType_S8:
+	case ImGuiHexEditorFieldType_S16:
+	case ImGuiHexEditorFieldType_S32:
+	case ImGuiHexEditorFieldType_S64:
+		if (!(flags & ImGuiHexEditorFieldFlags_Hex))
+		{
+			// Sign extend from the top bit of the value
+			const int shift = 64 - size * 8;
+			ImFormatString(buf, (size_t)buf_size, "%lld", (long long)(ImS64)(bits << shift) >> shift);
+			break;
+		}
+		// fallthrough
+	default:
+		if (flags & ImGuiHexEditorFieldFlags_Hex)
+			ImFormatString(buf, (size_t)buf_size, "0x%0*llX", size * 2, (unsigned long long)bits);
+		else
+			ImFormatString(buf, (size_t)buf_size, "%llu", (unsigned long long)bits);
+		break;
+	}
+}
+
+// Index of the first leaf starting after offset
+static int FindTemplateLeavesEnd(const ImGuiHexEditorTemplate* tpl, ImS64 offset)
+{
+	int lo = 0;
+	int hi = tpl->Leaves.Size;
+	while (lo < hi)
+	{
+		const int mid = lo + (hi - lo) / 2;
+		if (tpl->Leaves[mid].Offset <= offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+// Collects the leaves overlapping [from, to] in ascending order, O(log n + k) unless leaves overlap each other.
+// The scan goes backwards from the last leaf starting before to until no earlier leaf can reach from
+static void QueryTemplateLeaves(const ImGuiHexEditorTemplate* tpl, ImS64 from, ImS64 to, ImVector<int>& out)
+{
+	const int start = out.Size;
+	for (int i = FindTemplateLeavesEnd(tpl, to) - 1; i >= 0 && tpl->LeavesMaxEnd[i] > from; i--)
+	{
+		const ImGuiHexEditorTemplateLeaf& leaf = tpl->Leaves[i];
+		if (leaf.Offset + leaf.Size > from)
+			out.push_back(i);
+	}
+
+	for (int i = start, j = out.Size - 1; i < j; i++, j--)
+		ImSwap(out[i], out[j]);
+}
+
+// Innermost leaf containing offset, the one starting last. -1 if none
+static int FindTemplateLeaf(const ImGuiHexEditorTemplate* tpl, ImS64 offset)
+{
+	for (int i = FindTemplateLeavesEnd(tpl, offset) - 1; i >= 0 && tpl->LeavesMaxEnd[i] > offset; i--)
+	{
+		if (tpl->Leaves[i].Offset + tpl->Leaves[i].Size > offset)
+			return i;
+	}
+
+	return -1;
+}
+
+static char* AppendTemplatePath(char* out, char* end, const char* text)
+{
+	while (*text && out + 1 < end)
+		*out++ = *text++;
+
+	*out = '\0';
+	return out;
+}
+
+// Writes the path of a leaf from its outermost node, the array element containing offset and the offset into it.
+// Long chains of nodes, such as followed linked lists, are cut after the innermost 8
+static void FormatTemplatePath(const ImGuiHexEditorTemplate* tpl, const ImGuiHexEditorTemplateLeaf& leaf, ImS64 offset, char* buf, int size)
+{
+	char* out = buf;
+	char* end = buf + size;
+	*out = '\0';
+
+	int chain[8];
+	int chain_size = 0;
+	bool cut = false;
+	for (int node = leaf.Node; node != -1; node = tpl->Nodes[node].Parent)
+	{
+		if (chain_size == IM_ARRAYSIZE(chain))
+		{
+			cut = true;
+			break;
+		}
+		chain[chain_size++] = node;
+	}
+
+	char index_buf[32];
+	if (cut)
+		out = AppendTemplatePath(out, end, "...");
+
+	for (int i = chain_size - 1; i >= 0; i--)
+	{
+		const ImGuiHexEditorTemplateNode& node = tpl->Nodes[chain[i]];
+		if (node.Field != -1)
+			out = AppendTemplatePath(out, end, tpl->Names.Data + tpl->Fields[node.Field].Name);
+		else
+			out = AppendTemplatePath(out, end, GetTemplateTypeName(tpl, node.Type));
+
+		if (node.Index != -1)
+		{
+			ImFormatString(index_buf, sizeof(index_buf), "[%d]", node.Index);
+			out = AppendTemplatePath(out, end, index_buf);
+		}
+
+		out = AppendTemplatePath(out, end, node.Pointee ? "->" : ".");
+	}
+
+	// Values of nodes themselves, primitive roots and targets of pointers, are named after their type: "list.count_ptr->u32"
+	const int element_size = TemplatePrimitiveSizes[leaf.Type];
+	if (leaf.Field != -1)
+		out = AppendTemplatePath(out, end, tpl->Names.Data + tpl->Fields[leaf.Field].Name);
+	else
+		out = AppendTemplatePath(out, end, GetTemplateTypeName(tpl, leaf.Type));
+
+	const ImS64 rel = offset - leaf.Offset;
+	if (leaf.Size > element_size)
+	{
+		ImFormatString(index_buf, sizeof(index_buf), "[%lld]", (long long)(rel / element_size));
+		out = AppendTemplatePath(out, end, index_buf);
+	}
+
+	if (rel % element_size)
+	{
+		ImFormatString(index_buf, sizeof(index_buf), "+%d", (int)(rel % element_size));
+		AppendTemplatePath(out, end, index_buf);
+	}
+}
+
+// Data inspector
+
+enum ImGuiHexEditorInspectorRow_
+{
+	ImGuiHexEditorInspectorRow_Binary,
+	ImGuiHexEditorInspectorRow_S8,
+	ImGuiHexEditorInspectorRow_U8,
+	ImGuiHexEditorInspectorRow_S16,
+	ImGuiHexEditorInspectorRow_U16,
+	ImGuiHexEditorInspectorRow_S32,
+	ImGuiHexEditorInspectorRow_U32,
+	ImGuiHexEditorInspectorRow_S64,
+	ImGuiHexEditorInspectorRow_U64,
+	ImGuiHexEditorInspectorRow_Half,
+	ImGuiHexEditorInspectorRow_Float,
+	ImGuiHexEditorInspectorRow_Double,
+	ImGuiHexEditorInspectorRow_Time32,
+	ImGuiHexEditorInspectorRow_Time64,
+	ImGuiHexEditorInspectorRow_Guid,
+	ImGuiHexEditorInspectorRow_Uleb128,
+	ImGuiHexEditorInspectorRow_Sleb128,
+	ImGuiHexEditorInspectorRow_Utf8,
+	ImGuiHexEditorInspectorRow_Utf16,
+	ImGuiHexEditorInspectorRow_COUNT
+};
+
+static const char* const InspectorRowNames[ImGuiHexEditorInspectorRow_COUNT] = { "binary", "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64",
+	"float16", "float32", "float64", "time32_t", "time64_t", "GUID", "ULEB128", "SLEB128", "UTF-8", "UTF-16" };
+
+static const bool InspectorRowHasByteOrder[ImGuiHexEditorInspectorRow_COUNT] = { false, false, false, true, true, true, true, true, true,
+	true, true, true, true, true, true, false, false, false, true };
+
+struct ImGuiHexEditorDataInspector
+{
+	float RefreshInterval = 0.f;
+	double RefreshTime = 0.0;
+	bool Dirty = true;
+	ImS64 Offset = -1;
+	int EditRoot = -1;
+	unsigned char Bytes[32];
+	int Size = 0;
+	char Values[ImGuiHexEditorInspectorRow_COUNT][2][64]; // Little and big endian text of every row
+};
+
+static float DecodeHalf(ImU32 bits)
+{
+	const int exponent = (int)((bits >> 10) & 0x1f);
+	const float mantissa = (float)(bits & 0x3ff);
+
+	float value;
+	if (exponent == 0)
+		value = ldexpf(mantissa, -24);
+	else if (exponent == 31)
+		value = (bits & 0x3ff) ? NAN : INFINITY;
+	else
+		value = ldexpf(mantissa + 1024.f, exponent - 25);
+
+	return (bits & 0x8000) ? -value : value;
+}
+
+// Seconds since 1970 as a UTC date, with the days to civil date conversion from Howard Hinnant's date algorithms
+static void FormatInspectorTime(char* buf, int buf_size, ImS64 seconds)
+{
+	// Years 1 to 9999
+	if (seconds < -62135596800LL || seconds > 253402300799LL)
+	{
+		ImFormatString(buf, (size_t)buf_size, "out of range");
+		return;
+	}
+
+	ImS64 days = seconds / 86400;
+	ImS64 time = seconds % 86400;
+	if (time < 0)
+	{
+		time += 86400;
+		days--;
+	}
+
+	days += 719468;
+	const ImS64 era = (days >= 0 ? days : days - 146096) / 146097;
+	const ImS64 day_of_era = days - era * 146097;
+	const ImS64 year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+	const ImS64 day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+	const ImS64 month_index = (5 * day_of_year + 2) / 153;
+	const int day = (int)(day_of_year - (153 * month_index + 2) / 5 + 1);
+	const int month = (int)(month_index < 10 ? month_index + 3 : month_index - 9);
+	const ImS64 year = year_of_era + era * 400 + (month <= 2);
+
+	ImFormatString(buf, (size_t)buf_size, "%04lld-%02d-%02d %02d:%02d:%02d UTC", (long long)year, month, day, (int)(time / 3600), (int)(time / 60 % 60), (int)(time % 60));
+}
+
+// Returns the number of bytes of the value, 0 if it doesn't end within size bytes or 10 bytes
+static int DecodeLeb128(const unsigned char* data, int size, bool is_signed, ImU64* out_value)
+{
+	ImU64 value = 0;
+	for (int i = 0; i != size && i != 10; i++)
+	{
+		value |= (ImU64)(data[i] & 0x7f) << (i * 7);
+		if (data[i] & 0x80)
+			continue;
+
+		const int bits = (i + 1) * 7;
+		if (is_signed && bits < 64 && (data[i] & 0x40))
+			value |= ~(ImU64)0 << bits;
+
+		*out_value = value;
+		return i + 1;
+	}
+
+	return 0;
+}
+
+// Quoted text up to the first NUL or invalid character, control characters are shown as dots
+static void FormatInspectorText(char* buf, int buf_size, const unsigned char* data, int size, bool utf16, bool big_endian)
+{
+	char* out = buf;
+	char* const end = buf + buf_size - 2; // Room for the closing quote and the terminator
+	*out++ = '"';
+
+	for (int i = 0; i < size;)
+	{
+		unsigned int c;
+		if (!utf16)
+		{
+			i += ImTextCharFromUtf8(&c, (const char*)data + i, (const char*)data + size);
+			if (c == IM_UNICODE_CODEPOINT_INVALID)
+				break;
+		}
+		else
+		{
+			if (i + 2 > size)
+				break;
+
+			c = (unsigned int)LoadValueBits(data + i, 2, big_endian);
+			i += 2;
+			if (c >= 0xdc00 && c < 0xe000)
+				break;
+
+			if (c >= 0xd800 && c < 0xdc00)
+			{
+				const unsigned int low = i + 2 <= size ? (unsigned int)LoadValueBits(data + i, 2, big_endian) : 0;
+				if (low < 0xdc00 || low >= 0xe000)
+					break;
+
+				c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+				i += 2;
+			}
+		}
+
+		if (c == 0)
+			break;
+
+		char utf8[5] = { '.', '\0' };
+		if (c >= 0x20 && c != 0x7f)
+			ImTextCharToUtf8(utf8, c);
+
+		const int utf8_size = (int)strlen(utf8);
+		if (out + utf8_size > end)
+			break;
+
+		memcpy(out, utf8, (size_t)utf8_size);
+		out += utf8_size;
+	}
+
+	*out++ = '"';
+	*out = '\0';
+}
+
+static void DecodeInspectorValues(ImGuiHexEditorDataInspector* inspector)
+{
+	const unsigned char* data = inspector->Bytes;
+	const int size = inspector->Size;
+	const int value_size = IM_ARRAYSIZE(inspector->Values[0][0]);
+	memset(inspector->Values, 0, sizeof(inspector->Values));
+
+	// Every integer width of a byte order comes from a single 8 byte load: little endian values are its low bytes,
+	// big endian ones its high bytes. Single bytes have no byte order
+	unsigned char padded[8] = {};
+	memcpy(padded, data, (size_t)ImMin(size, 8));
+	const ImU64 loads[2] = { LoadValueBits(padded, 8, false), LoadValueBits(padded, 8, true) };
+
+	for (int order = 0; order != 2; order++)
+	{
+		for (int width = order == 0 ? 1 : 2, row = order == 0 ? ImGuiHexEditorInspectorRow_S8 : ImGuiHexEditorInspectorRow_S16; width <= 8 && width <= size; width *= 2, row += 2)
+		{
+			const int shift = 64 - width * 8;
+			const ImU64 value = order == 0 ? (loads[0] << shift) >> shift : loads[1] >> shift;
+			ImFormatString(inspector->Values[row][order], (size_t)value_size, "%lld", (long long)((ImS64)(value << shift) >> shift));
+			ImFormatString(inspector->Values[row + 1][order], (size_t)value_size, "%llu", (unsigned long long)value);
+
+			if (width == 2)
+			{
+				ImFormatString(inspector->Values[ImGuiHexEditorInspectorRow_Half][order], (size_t)value_size, "%g", DecodeHalf((ImU32)value));
+			}
+			else if (width == 4)
+			{
+				const ImU32 value_bits = (ImU32)value;
+				float value_float;
+				memcpy(&value_float, &value_bits, sizeof(value_float));
+				ImFormatString(inspector->Values[ImGuiHexEditorInspectorRow_Float][order], (size_t)value_size, "%g", value_float);
+				FormatInspectorTime(inspector->Values[ImGuiHexEditorInspectorRow_Time32][order], value_size, (ImS64)(ImS32)value_bits);
+			}
+			else if (width == 8)
+			{
+				double value_double;
+				memcpy(&value_double, &value, sizeof(value_double));
+				ImFormatString(inspector->Values[ImGuiHexEditorInspectorRow_Double][order], (size_t)value_size, "%g", value_double);
+				FormatInspectorTime(inspector->Values[ImGuiHexEditorInspectorRow_Time64][order], value_size, (ImS64)value);
+			}
+		}
+
+		// The first three groups of a GUID are stored in the byte order, the last two as bytes
+		if (size >= 16)
+		{
+			const bool big_endian = order == 1;
+			ImFormatString(inspector->Values[ImGuiHexEditorInspectorRow_Guid][order], (size_t)value_size, "{%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+				(unsigned int)LoadValueBits(data, 4, big_endian), (unsigned int)LoadValueBits(data + 4, 2, big_endian), (unsigned int)LoadValueBits(data + 6, 2, big_endian),
+				data[8], data[9], data[10], data[11], data[12], data[13], data[14], data[15]);
+		}
+
+		FormatInspectorText(inspector->Values[ImGuiHexEditorInspectorRow_Utf16][order], value_size, data, size, true, order == 1);
+	}
+
+	if (size >= 1)
+	{
+		char* binary = inspector->Values[ImGuiHexEditorInspectorRow_Binary][0];
+		for (int i = 0; i != 8; i++)
+			binary[i] = (data[0] & (0x80 >> i)) ? '1' : '0';
+		binary[8] = '\0';
+	}
+
+	ImU64 leb;
+	int leb_size = DecodeLeb128(data, size, false, &leb);
+	if (leb_size)
+		ImFormatString(inspector->Values[ImGuiHexEditorInspectorRow_Uleb128][0], (size_t)value_size, "%llu (%d bytes)", (unsigned long long)leb, leb_size);
+
+	leb_size = DecodeLeb128(data, size, true, &leb);
+	if (leb_size)
+		ImFormatString(inspector->Values[ImGuiHexEditorInspectorRow_Sleb128][0], (size_t)value_size, "%lld (%d bytes)", (long long)leb, leb_size);
+
+	FormatInspectorText(inspector->Values[ImGuiHexEditorInspectorRow_Utf8][0], value_size, data, size, false, false);
+
+	// Bytes, the second column of rows without a byte order and rows needing more bytes than available are left empty
+	for (int row = 0; row != ImGuiHexEditorInspectorRow_COUNT; row++)
+	{
+		for (int order = 0; order != (InspectorRowHasByteOrder[row] ? 2 : 1); order++)
+		{
+			if (!inspector->Values[row][order][0])
+				ImFormatString(inspector->Values[row][order], (size_t)value_size, "-");
+		}
+	}
+}
+
+// Reads the bytes at the cursor again when they may have changed
+static void UpdateDataInspector(ImGuiHexEditorState* state, ImGuiHexEditorDataInspector* inspector)
+{
+	const ImS64 offset = state->LastSelectedByte;
+	const ImS64 source_size = GetSourceSize(state);
+	const int size = offset >= 0 && offset < source_size ? (int)ImMin((ImS64)sizeof(inspector->Bytes), source_size - offset) : 0;
+	const int edit_root = state->EditBuffer ? state->EditBuffer->Root : -1;
+	const double time = ImGui::GetTime();
+
+	bool refresh = inspector->Dirty || offset != inspector->Offset || edit_root != inspector->EditRoot
+		|| (inspector->RefreshInterval > 0.f && time - inspector->RefreshTime >= inspector->RefreshInterval);
+
+	// The polled copy of watched bytes is compared every frame instead, the source isn't read
+	unsigned char watched[sizeof(inspector->Bytes)];
+	float change_times[sizeof(inspector->Bytes)];
+	const bool is_watched = size > 0 && state->Watch && !state->EditBuffer && ReadWatchBytes(state->Watch, offset, size, watched, change_times);
+	if (is_watched && !refresh)
+		refresh = size != inspector->Size || memcmp(watched, inspector->Bytes, (size_t)size) != 0;
+
+	if (!refresh)
+		return;
+
+	inspector->Offset = offset;
+	inspector->EditRoot = edit_root;
+	inspector->RefreshTime = time;
+	inspector->Dirty = false;
+
+	if (is_watched)
+	{
+		memcpy(inspector->Bytes, watched, (size_t)size);
+		inspector->Size = size;
+	}
+	else if (size > 0)
+	{
+		const ImS64 read = state->EditBuffer ? ReadEditBuffer(state, offset, inspector->Bytes, size, true) : ReadVisibleSourceBytes(state, offset, inspector->Bytes, size);
+		inspector->Size = (int)ImMax(read, (ImS64)0);
+
+		// Only the page cache returns less than asked without failing, the missing page is being loaded
+		inspector->Dirty = inspector->Size < size && state->PageCache;
+	}
+	else
+		inspector->Size = 0;
+
+	DecodeInspectorValues(inspector);
+}
+
+// Minimap
+
+// Summary of a block of the source, or of every block below a cell of a higher level. Values are scaled to 0-255
+struct ImGuiHexEditorMinimapCell
+{
+	ImU8 Entropy; // Bits per byte times 32
+	ImU8 Zeros;
+	ImU8 Ascii; // Printable characters and whitespace
+	ImU8 Scanned; // Blocks summarized so far, the other values are their mean
+};
+
+// Level 0 has a cell per block and every following level a cell per pair of cells of the previous one, up to a single
+// root. Any span of the source is summarized by one or two cells of the level whose cells are about as large as it.
+// Blocks written since they were scanned are queued in Dirty and scanned again once the running job is done
+struct ImGuiHexEditorMinimap
+{
+	ImGuiHexEditorJob Job;
+	std::mutex Mutex; // Guards Cells, workers publish the blocks of a chunk at once
+	ImVector<ImGuiHexEditorMinimapCell> Cells;
+	ImVector<int> LevelStarts; // First cell of every level, followed by the end of the last one
+	int BlockShift;
+	int MinBlockShift;
+	ImS64 SourceSize;
+	int EditRoot; // Version of the edit buffer scanned, rescanned entirely after undo, redo or edits made outside of the editor
+	ImVector<ImS64> Dirty; // Pairs of first and last block, sorted and disjoint
+};
+
+static const int MinimapMaxBlocks = 1 << 21;
+
+// Blocks below a cell, fewer than a power of two for the last cell of a level
+static inline ImS64 GetMinimapCellBlocks(const ImGuiHexEditorMinimap* minimap, int level, ImS64 index)
+{
+	return ImMin((ImS64)1 << level, minimap->LevelStarts[1] - (index << level));
+}
+
+static ImGuiHexEditorMinimapCell MergeMinimapCells(const ImGuiHexEditorMinimapCell& a, ImS64 a_blocks, const ImGuiHexEditorMinimapCell& b, ImS64 b_blocks)
+{
+	ImGuiHexEditorMinimapCell cell;
+	const ImS64 a_weight = a.Scanned * a_blocks;
+	const ImS64 b_weight = b.Scanned * b_blocks;
+	const ImS64 weight = a_weight + b_weight;
+	if (weight == 0)
+	{
+		memset(&cell, 0, sizeof(cell));
+		return cell;
+	}
+
+	cell.Entropy = (ImU8)((a.Entropy * a_weight + b.Entropy * b_weight + weight / 2) / weight);
+	cell.Zeros = (ImU8)((a.Zeros * a_weight + b.Zeros * b_weight + weight / 2) / weight);
+	cell.Ascii = (ImU8)((a.Ascii * a_weight + b.Ascii * b_weight + weight / 2) / weight);
+	cell.Scanned = (ImU8)((weight + (a_blocks + b_blocks) / 2) / (a_blocks + b_blocks));
+	return cell;
+}
+
+// Zeroed blocks are common in disk and memory images and skip the histogram, checked 64 bytes at a time with SSE2
+static bool IsZeroBlock(const unsigned char* data, ImS64 size)
+{
+	ImS64 i = 0;
+#ifdef IMGUI_HEX_EDITOR_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 64 <= size; i += 64)
+	{
+		const __m128i a = _mm_or_si128(_mm_loadu_si128((const __m128i*)(data + i)), _mm_loadu_si128((const __m128i*)(data + i + 16)));
+		const __m128i b = _mm_or_si128(_mm_loadu_si128((const __m128i*)(data + i + 32)), _mm_loadu_si128((const __m128i*)(data + i + 48)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(a, b), zero)) != 0xffff)
+			return false;
+	}
+#endif
+
+	for (; i < size; i++)
+	{
+		if (data[i] != 0)
+			return false;
+	}
+
+	return true;
+}
+
+static ImGuiHexEditorMinimapCell ScanMinimapBlock(const unsigned char* data, ImS64 size)
+{
+	ImGuiHexEditorMinimapCell cell;
+	cell.Entropy = 0;
+	cell.Zeros = 255;
+	cell.Ascii = 0;
+	cell.Scanned = 255;
+	if (IsZeroBlock(data, size))
+		return cell;
+
+	ImU32 counts[4][256];
+	memset(counts, 0, sizeof(counts));
+	CountByteValues(data, size, counts);
+
+	// Shannon entropy from the histogram: log2(n) - sum(c * log2(c)) / n
+	double sum = 0.0;
+	ImS64 ascii = 0;
+	for (int value = 0; value != 256; value++)
+	{
+		const ImU32 count = counts[0][value] + counts[1][value] + counts[2][value] + counts[3][value];
+		if (count == 0)
+			continue;
+
+		sum += count * log2((double)count);
+		if (HasAsciiRepresentation((unsigned char)value) || value == ' ' || value == '\t' || value == '\n' || value == '\r')
+			ascii += count;
+	}
+
+	const ImU32 zeros = counts[0][0] + counts[1][0] + counts[2][0] + counts[3][0];
+	const double entropy = log2((double)size) - sum / (double)size;
+	cell.Entropy = (ImU8)ImClamp((int)(entropy * 32.0 + 0.5), 0, 255);
+	cell.Zeros = (ImU8)((ImS64)zeros * 255 / size);
+	cell.Ascii = (ImU8)(ascii * 255 / size);
+	return cell;
+}
+
+// Must be called with the mutex held, merges the cells above blocks [first, last] again
+static void UpdateMinimapParents(ImGuiHexEditorMinimap* minimap, ImS64 first, ImS64 last)
+{
+	ImGuiHexEditorMinimapCell* cells = minimap->Cells.Data;
+	for (int level = 1; level < minimap->LevelStarts.Size - 1; level++)
+	{
+		first >>= 1;
+		last >>= 1;
+
+		const ImGuiHexEditorMinimapCell* children = cells + minimap->LevelStarts[level - 1];
+		const ImS64 children_count = minimap->LevelStarts[level] - minimap->LevelStarts[level - 1];
+		ImGuiHexEditorMinimapCell* parents = cells + minimap->LevelStarts[level];
+		for (ImS64 i = first; i <= last; i++)
+		{
+			const ImS64 left = i * 2;
+			const ImS64 right = left + 1;
+			parents[i] = right < children_count ? MergeMinimapCells(children[left], (ImS64)1 << (level - 1), children[right], GetMinimapCellBlocks(minimap, level - 1, right)) : children[left];
+		}
+	}
+}
+
+// Chunks start on block boundaries and hold whole blocks, except for the last one of the source
+static bool ProcessMinimapChunk(ImGuiHexEditorJob* job, int chunk, ImS64 offset, const unsigned char* data, ImS64 size, ImS64 chunk_size)
+{
+	IM_UNUSED(chunk);
+	ImGuiHexEditorMinimap* minimap = (ImGuiHexEditorMinimap*)job->UserData;
+
+	const int shift = minimap->BlockShift;
+	const ImS64 block_size = (ImS64)1 << shift;
+	const ImS64 first_block = offset >> shift;
+	const int blocks_count = (int)((ImMin(size, chunk_size) + block_size - 1) >> shift);
+	if (blocks_count == 0)
+		return true;
+
+	// Chunks hold at most 1 MiB of blocks of at least 256 bytes, or a single larger block
+	ImGuiHexEditorMinimapCell cells[4096];
+	for (int i = 0; i != blocks_count; i++)
+		cells[i] = ScanMinimapBlock(data + i * block_size, ImMin(block_size, size - i * block_size));
+
+	std::lock_guard<std::mutex> lock(minimap->Mutex);
+	memcpy(minimap->Cells.Data + first_block, cells, sizeof(ImGuiHexEditorMinimapCell) * (size_t)blocks_count);
+	UpdateMinimapParents(minimap, first_block, first_block + blocks_count - 1);
+	return true;
+}
+
+// Scans blocks [first, last] in the background, the job of a previous scan must be destroyed
+static void StartMinimapJob(ImGuiHexEditorState* state, ImGuiHexEditorMinimap* minimap, ImS64 first, ImS64 last)
+{
+	ImGuiHexEditorJob* job = &minimap->Job;
+	InitJob(job, state, first << minimap->BlockShift, (last + 1) << minimap->BlockShift, 0, ProcessMinimapChunk, minimap);
+	job->ChunkSize = ImMax(job->ChunkSize, (ImS64)1 << minimap->BlockShift);
+	job->ChunksCount = (int)((job->To - job->From + job->ChunkSize - 1) / job->ChunkSize);
+	StartJob(job);
+}
+
+// Sizes the levels for the current source and scans all of it again
+static void ResetMinimap(ImGuiHexEditorState* state, ImGuiHexEditorMinimap* minimap)
+{
+	DestroyJob(&minimap->Job);
+
+	const ImS64 size = GetSourceSize(state);
+	int shift = minimap->MinBlockShift;
+	while ((size >> shift) >= MinimapMaxBlocks)
+		shift++;
+
+	minimap->BlockShift = shift;
+	minimap->SourceSize = size;
+	minimap->EditRoot = state->EditBuffer ? state->EditBuffer->Root : -1;
+	minimap->Dirty.resize(0);
+
+	minimap->LevelStarts.resize(0);
+	int count = (int)((size + ((ImS64)1 << shift) - 1) >> shift);
+	int total = 0;
+	for (;;)
+	{
+		minimap->LevelStarts.push_back(total);
+		total += count;
+		if (count <= 1)
+			break;
+
+		count = (count + 1) / 2;
+	}
+
+	minimap->LevelStarts.push_back(total);
+	minimap->Cells.resize(total);
+	if (total > 0)
+		memset(minimap->Cells.Data, 0, sizeof(ImGuiHexEditorMinimapCell) * (size_t)total);
+
+	StartMinimapJob(state, minimap, 0, minimap->LevelStarts[1] - 1);
+}
+
+static void AddMinimapDirtyBlocks(ImGuiHexEditorMinimap* minimap, ImS64 first, ImS64 last)
+{
+	ImVector<ImS64>& dirty = minimap->Dirty;
+
+	// Merge with every touching range, the merged range replaces them
+	int i = 0;
+	while (i != dirty.Size && dirty[i + 1] + 1 < first)
+		i += 2;
+
+	int end = i;
+	while (end != dirty.Size && dirty[end] <= last + 1)
+	{
+		first = ImMin(first, dirty[end]);
+		last = ImMax(last, dirty[end + 1]);
+		end += 2;
+	}
+
+	if (end == i)
+	{
+		dirty.insert(dirty.Data + i, last);
+		dirty.insert(dirty.Data + i, first);
+	}
+	else
+	{
+		dirty[i] = first;
+		dirty[i + 1] = last;
+		dirty.erase(dirty.Data + i + 2, dirty.Data + end);
+	}
+}
+
+// Restarts the scan after the source was resized or changed outside of the editor, or scans the next dirty blocks
+static void UpdateHexEditorMinimap(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorMinimap* minimap = state->Minimap;
+	const int edit_root = state->EditBuffer ? state->EditBuffer->Root : -1;
+	if (GetSourceSize(state) != minimap->SourceSize)
+	{
+		ResetMinimap(state, minimap);
+		return;
+	}
+
+	if (edit_root != minimap->EditRoot)
+	{
+		// Cells of the previous version are kept meanwhile, the size didn't change
+		minimap->EditRoot = edit_root;
+		minimap->Dirty.resize(0);
+		if (minimap->SourceSize > 0)
+			AddMinimapDirtyBlocks(minimap, 0, minimap->LevelStarts[1] - 1);
+	}
+
+	if (minimap->Dirty.Size == 0 || minimap->Job.WorkersRunning > 0)
+		return;
+
+	DestroyJob(&minimap->Job);
+	const ImS64 first = minimap->Dirty[0];
+	const ImS64 last = minimap->Dirty[1];
+	minimap->Dirty.erase(minimap->Dirty.Data, minimap->Dirty.Data + 2);
+	StartMinimapJob(state, minimap, first, last);
+}
+
+// Must be called with the mutex held. Summary of [from, to), from the level whose cells are at least as large as the span
+static ImGuiHexEditorMinimapCell SampleMinimap(const ImGuiHexEditorMinimap* minimap, ImS64 from, ImS64 to)
+{
+	ImS64 first = from >> minimap->BlockShift;
+	ImS64 last = (to - 1) >> minimap->BlockShift;
+	int level = 0;
+	while (last - first > 1 && level < minimap->LevelStarts.Size - 2)
+	{
+		first >>= 1;
+		last >>= 1;
+		level++;
+	}
+
+	const ImGuiHexEditorMinimapCell* cells = minimap->Cells.Data + minimap->LevelStarts[level];
+	if (first == last)
+		return cells[first];
+
+	return MergeMinimapCells(cells[first], GetMinimapCellBlocks(minimap, level, first), cells[last], GetMinimapCellBlocks(minimap, level, last));
+}
+
+// Bytes [from, to) shown by pixel row y out of rows, at least one
+static void GetMinimapRowRange(ImS64 source_size, int rows, int y, ImS64* out_from, ImS64* out_to)
+{
+	const double bytes_per_row = (double)source_size / rows;
+	*out_from = ImMin((ImS64)(y * bytes_per_row), source_size - 1);
+	*out_to = ImMax(*out_from + 1, ImMin((ImS64)((y + 1) * bytes_per_row), source_size));
+}
+
+// Zeroes are black, text blue and compressed or encrypted data red, anything else is grey as bright as its entropy
+static ImU32 GetMinimapCellColor(const ImGuiHexEditorMinimapCell& cell, ImU32 unscanned_color)
+{
+	if (cell.Scanned == 0)
+		return unscanned_color;
+
+	const float entropy = cell.Entropy / 255.f;
+	if (cell.Zeros >= 240)
+		return IM_COL32(0, 0, 0, 255);
+
+	if (cell.Ascii >= 192)
+		return ImColor(0.25f + entropy * 0.2f, 0.45f + entropy * 0.25f, 0.95f);
+
+	if (entropy >= 0.9f)
+		return ImColor(0.7f + (entropy - 0.9f) * 3.f, 0.2f, 0.15f);
+
+	const float value = 0.15f + entropy * 0.7f;
+	return ImColor(value, value, value);
+}
+
+// Export
+
+struct ImGuiHexEditorExport
+{
+	ImGuiHexEditorExportCallback Callback;
+	void* UserData;
+	char* Buffer;
+	int Size;
+	int Capacity;
+	bool Failed;
+
+	ImS64 From;
+	ImS64 To;
+	int BytesPerLine;
+	int AddressChars;
+	bool Multiline;
+	bool Lowercase;
+	char* Hex; // Hex digits of the chunk being exported, two per byte
+	char* Ascii; // Ascii column of the chunk, for hex dumps only
+	unsigned char Base64Carry[2]; // Bytes left over from the previous chunk
+	int Base64CarrySize;
+};
+
+static bool FlushExport(ImGuiHexEditorExport* exp)
+{
+	if (exp->Size > 0 && !exp->Failed && !exp->Callback(exp->UserData, exp->Buffer, exp->Size))
+		exp->Failed = true;
+
+	exp->Size = 0;
+	return !exp->Failed;
+}
+
+// Returns room for size more characters, size is at most a line of output
+static char* ReserveExport(ImGuiHexEditorExport* exp, int size)
+{
+	IM_ASSERT(size <= exp->Capacity);
+	if (exp->Size + size > exp->Capacity)
+		FlushExport(exp);
+
+	return exp->Buffer + exp->Size;
+}
+
+static char* WriteExportText(char* out, const char* text)
+{
+	const size_t size = strlen(text);
+	memcpy(out, text, size);
+	return out + size;
+}
+
+// Hex digits of the byte at index of the chunk
+static char* WriteExportPair(char* out, const ImGuiHexEditorExport* exp, int index)
+{
+	out[0] = exp->Hex[index * 2];
+	out[1] = exp->Hex[index * 2 + 1];
+	return out + 2;
+}
+
+static void ExportHex(ImGuiHexEditorExport* exp, ImS64 offset, int size)
+{
+	const int bytes_per_line = exp->BytesPerLine;
+	for (int i = 0; i < size;)
+	{
+		const int count = (int)ImMin((ImS64)(size - i), bytes_per_line - (offset + i) % bytes_per_line);
+		char* out = ReserveExport(exp, count * 3 + 2);
+		char* p = out;
+
+		for (int j = i; j != i + count; j++)
+		{
+			if (offset + j != exp->From)
+			{
+				if (exp->Multiline && (offset + j) % bytes_per_line == 0)
+					p = WriteExportText(p, IM_NEWLINE);
+				else
+					*p++ = ' ';
+			}
+
+			p = WriteExportPair(p, exp, j);
+		}
+
+		exp->Size += (int)(p - out);
+		i += count;
+	}
+}
+
+// Chunks start on line boundaries, so every line lies in a single chunk
+static void ExportHexDump(ImGuiHexEditorExport* exp, ImS64 offset, int size)
+{
+	const int bytes_per_line = exp->BytesPerLine;
+	for (int i = 0; i < size;)
+	{
+		const ImS64 line_base = offset + i - (offset + i) % bytes_per_line;
+		const int first = (int)(offset + i - line_base);
+		const int count = (int)ImMin((ImS64)(size - i), (ImS64)(bytes_per_line - first));
+
+		char* out = ReserveExport(exp, exp->AddressChars + bytes_per_line * 4 + 8);
+		char* p = out;
+
+		p += ImFormatString(p, (size_t)exp->AddressChars + 3, "%0*llX: ", exp->AddressChars, (unsigned long long)line_base);
+
+		for (int column = 0; column != bytes_per_line; column++)
+		{
+			if (column >= first && column < first + count)
+				p = WriteExportPair(p, exp, i + column - first);
+			else
+			{
+				p[0] = ' ';
+				p[1] = ' ';
+				p += 2;
+			}
+
+			*p++ = ' ';
+		}
+
+		*p++ = ' ';
+		for (int column = 0; column != first + count; column++)
+			*p++ = column < first ? ' ' : exp->Ascii[i + column - first];
+
+		p = WriteExportText(p, IM_NEWLINE);
+		exp->Size += (int)(p - out);
+		i += count;
+	}
+}
+
+static void ExportCArray(ImGuiHexEditorExport* exp, ImS64 offset, int size)
+{
+	const int bytes_per_line = exp->BytesPerLine;
+
+	if (offset == exp->From)
+	{
+		char* out = ReserveExport(exp, 64);
+		char* p = out;
+		p += ImFormatString(p, 48, "unsigned char data[%lld] = {", (long long)(exp->To - exp->From + 1));
+		p = exp->Multiline ? WriteExportText(WriteExportText(p, IM_NEWLINE), "\t") : WriteExportText(p, " ");
+		exp->Size += (int)(p - out);
+	}
+
+	for (int i = 0; i < size;)
+	{
+		const ImS64 relative = offset + i - exp->From;
+		const int count = (int)ImMin((ImS64)(size - i), bytes_per_line - relative % bytes_per_line);
+		char* out = ReserveExport(exp, count * 6 + 8);
+		char* p = out;
+
+		for (int j = i; j != i + count; j++)
+		{
+			p[0] = '0';
+			p[1] = 'x';
+			p = WriteExportPair(p + 2, exp, j);
+
+			if (offset + j == exp->To)
+				p = exp->Multiline ? WriteExportText(WriteExportText(p, IM_NEWLINE), "};") : WriteExportText(p, " };");
+			else if (exp->Multiline && (offset + j - exp->From) % bytes_per_line == bytes_per_line - 1)
+				p = WriteExportText(WriteExportText(p, ","), IM_NEWLINE "\t");
+			else
+				p = WriteExportText(p, ", ");
+		}
+
+		exp->Size += (int)(p - out);
+		i += count;
+	}
+}
+
+static void ExportPythonBytes(ImGuiHexEditorExport* exp, ImS64 offset, int size)
+{
+	const int bytes_per_line = exp->BytesPerLine;
+
+	// Multiline output is a parenthesized sequence of literals, one per line
+	if (offset == exp->From)
+	{
+		char* out = ReserveExport(exp, 3);
+		exp->Size += (int)(WriteExportText(out, exp->Multiline ? "(b\"" : "b\"") - out);
+	}
+
+	for (int i = 0; i < size;)
+	{
+		const ImS64 relative = offset + i - exp->From;
+		const int count = exp->Multiline ? (int)ImMin((ImS64)(size - i), bytes_per_line - relative % bytes_per_line) : ImMin(size - i, 4096);
+		char* out = ReserveExport(exp, count * 4 + 8);
+		char* p = out;
+
+		int j = i;
+#ifdef IMGUI_HEX_EDITOR_SSE2
+		const __m128i escape = _mm_set1_epi16((short)('\\' | ('x' << 8)));
+		for (; j + 8 <= i + count; j += 8)
+		{
+			const __m128i pairs = _mm_loadu_si128((const __m128i*)(exp->Hex + j * 2));
+			_mm_storeu_si128((__m128i*)p, _mm_unpacklo_epi16(escape, pairs));
+			_mm_storeu_si128((__m128i*)(p + 16), _mm_unpackhi_epi16(escape, pairs));
+			p += 32;
+		}
+#endif
+		for (; j != i + count; j++)
+		{
+			p[0] = '\\';
+			p[1] = 'x';
+			p = WriteExportPair(p + 2, exp, j);
+		}
+
+		const ImS64 last = offset + i + count - 1;
+		if (last == exp->To)
+			p = WriteExportText(p, exp->Multiline ? "\")" : "\"");
+		else if (exp->Multiline && (last - exp->From) % bytes_per_line == bytes_per_line - 1)
+			p = WriteExportText(WriteExportText(p, "\"" IM_NEWLINE), " b\"");
+
+		exp->Size += (int)(p - out);
+		i += count;
+	}
+}
+
+static void ExportBase64Group(char* out, const unsigned char* group, int size)
+{
+	static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	const ImU32 bits = ((ImU32)group[0] << 16) | (size > 1 ? (ImU32)group[1] << 8 : 0) | (size > 2 ? (ImU32)group[2] : 0);
+	out[0] = chars[(bits >> 18) & 0x3f];
+	out[1] = chars[(bits >> 12) & 0x3f];
+	out[2] = size > 1 ? chars[(bits >> 6) & 0x3f] : '=';
+	out[3] = size > 2 ? chars[bits & 0x3f] : '=';
+}
+
+static void ExportBase64(ImGuiHexEditorExport* exp, ImS64 offset, const unsigned char* data, int size)
+{
+	int i = 0;
+
+	// Complete the group started by the previous chunk
+	while (exp->Base64CarrySize != 0 && i < size)
+	{
+		unsigned char group[3] = { exp->Base64Carry[0], exp->Base64Carry[1], data[i++] };
+		if (exp->Base64CarrySize == 1)
+		{
+			exp->Base64Carry[1] = group[2];
+			exp->Base64CarrySize = 2;
+			continue;
+		}
+
+		ExportBase64Group(ReserveExport(exp, 4), group, 3);
+		exp->Size += 4;
+		exp->Base64CarrySize = 0;
+	}
+
+	while (i + 3 <= size)
+	{
+		const int count = ImMin((size - i) / 3, 4096);
+		char* out = ReserveExport(exp, count * 4);
+		for (int group = 0; group != count; group++, i += 3)
+			ExportBase64Group(out + group * 4, data + i, 3);
+
+		exp->Size += count * 4;
+	}
+
+	for (; i < size; i++)
+		exp->Base64Carry[exp->Base64CarrySize++] = data[i];
+
+	if (offset + size - 1 == exp->To && exp->Base64CarrySize != 0)
+	{
+		ExportBase64Group(ReserveExport(exp, 4), exp->Base64Carry, exp->Base64CarrySize);
+		exp->Size += 4;
+		exp->Base64CarrySize = 0;
+	}
+}
+
+static bool WriteExportFile(void* user_data, const char* data, int size)
+{
+#ifndef IMGUI_DISABLE_FILE_FUNCTIONS
+	return ImFileWrite(data, 1, (ImU64)size, (ImFileHandle)user_data) == (ImU64)size;
+#else
+	IM_UNUSED(user_data);
+	IM_UNUSED(data);
+	IM_UNUSED(size);
+	return false;
+#endif
+}
+
+static bool AppendExportText(void* user_data, const char* data, int size)
+{
+	ImVector<char>* text = (ImVector<char>*)user_data;
+	if (size > INT_MAX - 1 - text->Size)
+		return false;
+
+	const int text_size = text->Size;
+	text->resize(text_size + size);
+	memcpy(text->Data + text_size, data, (size_t)size);
+	return true;
+}
+
+// Paste
+
+enum ImGuiHexEditorPasteChar_ : unsigned char
+{
+	ImGuiHexEditorPasteChar_Separator = 0xfe,
+	ImGuiHexEditorPasteChar_Invalid = 0xff,
+};
+
+// Digit values of hex or base64 characters, every other character is a separator or invalid
+static void BuildPasteTable(unsigned char table[256], bool base64)
+{
+	memset(table, ImGuiHexEditorPasteChar_Invalid, 256);
+	table[(unsigned char)' '] = table[(unsigned char)'\t'] = table[(unsigned char)'\r'] = table[(unsigned char)'\n'] = ImGuiHexEditorPasteChar_Separator;
+
+	if (base64)
+	{
+		for (int i = 0; i != 26; i++)
+		{
+			table['A' + i] = (unsigned char)i;
+			table['a' + i] = (unsigned char)(26 + i);
+		}
+
+		for (int i = 0; i != 10; i++)
+			table['0' + i] = (unsigned char)(52 + i);
+
+		table[(unsigned char)'+'] = table[(unsigned char)'-'] = 62;
+		table[(unsigned char)'/'] = table[(unsigned char)'_'] = 63;
+	}
+	else
+	{
+		table[(unsigned char)','] = ImGuiHexEditorPasteChar_Separator;
+
+		for (int i = 0; i != 10; i++)
+			table['0' + i] = (unsigned char)i;
+
+		for (int i = 0; i != 6; i++)
+			table['A' + i] = table['a' + i] = (unsigned char)(10 + i);
+	}
+}
+
+#ifdef IMGUI_HEX_EDITOR_SSE2
+// Decodes 16 hex digits into 8 bytes, returns false without writing if any of the characters isn't a digit
+static bool DecodeHexDigits(const char* text, unsigned char* out)
+{
+	const __m128i chars = _mm_loadu_si128((const __m128i*)text);
+	const __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+
+	const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+	const __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+	if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xffff)
+		return false;
+
+	const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+	const __m128i letters = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+	const __m128i nibbles = _mm_or_si128(_mm_and_si128(is_digit, digits), _mm_andnot_si128(is_digit, letters));
+
+	// Every 16-bit lane holds the high nibble of a byte in its low half and the low nibble in its high half
+	const __m128i high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4);
+	const __m128i low = _mm_srli_epi16(nibbles, 8);
+	_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(_mm_or_si128(high, low), _mm_setzero_si128()));
+	return true;
+}
+#endif
+
+static bool DecodePasteHex(ImVector<unsigned char>* out, const char* text, int size)
+{
+	unsigned char table[256];
+	BuildPasteTable(table, false);
+
+	out->resize(size / 2);
+	unsigned char* dst = out->Data;
+
+	for (int i = 0; i < size;)
+	{
+#ifdef IMGUI_HEX_EDITOR_SSE2
+		if (i + 16 <= size && DecodeHexDigits(text + i, dst))
+		{
+			i += 16;
+			dst += 8;
+			continue;
+		}
+#endif
+
+		const unsigned char high = table[(unsigned char)text[i]];
+		if (high == ImGuiHexEditorPasteChar_Separator)
+		{
+			i++;
+			continue;
+		}
+
+		// 0x prefix at the start of a token
+		if (text[i] == '0' && i + 1 < size && (text[i + 1] == 'x' || text[i + 1] == 'X') && (i == 0 || table[(unsigned char)text[i - 1]] == ImGuiHexEditorPasteChar_Separator))
+		{
+			i += 2;
+			continue;
+		}
+
+		const unsigned char low = i + 1 < size ? table[(unsigned char)text[i + 1]] : (unsigned char)ImGuiHexEditorPasteChar_Invalid;
+		if (high > 0x0f || low > 0x0f)
+			return false;
+
+		*dst++ = (unsigned char)((high << 4) | low);
+		i += 2;
+	}
+
+	out->resize((int)(dst - out->Data));
+	return true;
+}
+
+static bool DecodePasteBase64(ImVector<unsigned char>* out, const char* text, int size)
+{
+	unsigned char table[256];
+	BuildPasteTable(table, true);
+
+	out->resize(size / 4 * 3 + 3);
+	unsigned char* dst = out->Data;
+
+	ImU32 bits = 0;
+	int count = 0;
+	int padding = 0;
+
+	for (int i = 0; i != size; i++)
+	{
+		const unsigned char value = table[(unsigned char)text[i]];
+		if (value == ImGuiHexEditorPasteChar_Separator)
+			continue;
+
+		if (text[i] == '=')
+		{
+			padding++;
+			continue;
+		}
+
+		if (value == ImGuiHexEditorPasteChar_Invalid || padding != 0)
+			return false;
+
+		bits = (bits << 6) | value;
+		if (++count == 4)
+		{
+			dst[0] = (unsigned char)(bits >> 16);
+			dst[1] = (unsigned char)(bits >> 8);
+			dst[2] = (unsigned char)bits;
+			dst += 3;
+			bits = 0;
+			count = 0;
+		}
+	}
+
+	if (count == 1 || padding > 2)
+		return false;
+
+	if (count == 2)
+		*dst++ = (unsigned char)(bits >> 4);
+	else if (count == 3)
+	{
+		dst[0] = (unsigned char)(bits >> 10);
+		dst[1] = (unsigned char)(bits >> 2);
+		dst += 2;
+	}
+
+	out->resize((int)(dst - out->Data));
+	return true;
+}
+
+struct ImGuiHexEditorGlyph
+{
+	ImVec2 Pos;
+	ImU32 Color;
+	const ImFontGlyph* Glyph;
+};
+
+// Glyphs of the printable ascii range, looked up once per frame instead of once per rendered character
+struct ImGuiHexEditorGlyphTable
+{
+	const ImFontGlyph* Glyphs[128];
+	float Scale;
+};
+
+static void BuildGlyphTable(ImGuiHexEditorGlyphTable* table, ImFont* font, float font_size)
+{
+	memset(table->Glyphs, 0, sizeof(table->Glyphs));
+	for (int c = ' '; c <= '~'; c++)
+		table->Glyphs[c] = font->FindGlyph((ImWchar)c);
+
+	table->Scale = font_size / font->FontSize;
+}
+
+// Queues the glyphs of an ascii string the way ImDrawList::AddText() lays them out. Returns false without queueing
+// anything if the string has characters outside of the table.
+static bool PushGlyphs(ImVector<ImGuiHexEditorGlyph>& glyphs, const ImGuiHexEditorGlyphTable& table, ImVec2 pos, const char* text, int count, ImU32 color, float* out_end_x = nullptr)
+{
+	for (int i = 0; i != count; i++)
+	{
+		const unsigned char c = (unsigned char)text[i];
+		if (c >= IM_ARRAYSIZE(table.Glyphs) || !table.Glyphs[c])
+			return false;
+	}
+
+	pos.x = (float)(int)pos.x;
+	pos.y = (float)(int)pos.y;
+
+	for (int i = 0; i != count; i++)
+	{
+		const ImFontGlyph* glyph = table.Glyphs[(unsigned char)text[i]];
+
+		if (glyph->Visible && (color & IM_COL32_A_MASK))
+		{
+			ImGuiHexEditorGlyph queued;
+			queued.Pos = pos;
+			queued.Color = glyph->Colored ? (color | ~IM_COL32_A_MASK) : color;
+			queued.Glyph = glyph;
+			glyphs.push_back(queued);
+		}
+
+		pos.x += glyph->AdvanceX * table.Scale;
+	}
+
+	if (out_end_x)
+		*out_end_x = pos.x;
+
+	return true;
+}
+
+// Emits every queued glyph as textured quads, with a reservation per batch small enough for 16-bit indices
+static void RenderGlyphs(ImDrawList* draw_list, const ImVector<ImGuiHexEditorGlyph>& glyphs, float scale)
+{
+	const int max_batch_glyphs = sizeof(ImDrawIdx) == 2 ? (1 << 16) / 4 : glyphs.Size;
+
+	for (int batch_start = 0; batch_start < glyphs.Size; batch_start += max_batch_glyphs)
+	{
+		const int batch_glyphs = ImMin(glyphs.Size - batch_start, max_batch_glyphs);
+		draw_list->PrimReserve(batch_glyphs * 6, batch_glyphs * 4);
+
+		ImDrawVert* vtx_write = draw_list->_VtxWritePtr;
+		ImDrawIdx* idx_write = draw_list->_IdxWritePtr;
+		unsigned int vtx_index = draw_list->_VtxCurrentIdx;
+
+		for (int i = batch_start; i != batch_start + batch_glyphs; i++)
+		{
+			const ImGuiHexEditorGlyph& queued = glyphs[i];
+			const ImFontGlyph* glyph = queued.Glyph;
+			const float x0 = queued.Pos.x + glyph->X0 * scale;
+			const float y0 = queued.Pos.y + glyph->Y0 * scale;
+			const float x1 = queued.Pos.x + glyph->X1 * scale;
+			const float y1 = queued.Pos.y + glyph->Y1 * scale;
+
+			idx_write[0] = (ImDrawIdx)vtx_index;
+			idx_write[1] = (ImDrawIdx)(vtx_index + 1);
+			idx_write[2] = (ImDrawIdx)(vtx_index + 2);
+			idx_write[3] = (ImDrawIdx)vtx_index;
+			idx_write[4] = (ImDrawIdx)(vtx_index + 2);
+			idx_write[5] = (ImDrawIdx)(vtx_index + 3);
+
+			vtx_write[0].pos = ImVec2(x0, y0); vtx_write[0].uv = ImVec2(glyph->U0, glyph->V0); vtx_write[0].col = queued.Color;
+			vtx_write[1].pos = ImVec2(x1, y0); vtx_write[1].uv = ImVec2(glyph->U1, glyph->V0); vtx_write[1].col = queued.Color;
+			vtx_write[2].pos = ImVec2(x1, y1); vtx_write[2].uv = ImVec2(glyph->U1, glyph->V1); vtx_write[2].col = queued.Color;
+			vtx_write[3].pos = ImVec2(x0, y1); vtx_write[3].uv = ImVec2(glyph->U0, glyph->V1); vtx_write[3].col = queued.Color;
+
+			vtx_write += 4;
+			idx_write += 6;
+			vtx_index += 4;
+		}
+
+		draw_list->_VtxWritePtr = vtx_write;
+		draw_list->_IdxWritePtr = idx_write;
+		draw_list->_VtxCurrentIdx = vtx_index;
+	}
+}
+
+// Cell formats
+
+struct ImGuiHexEditorCellFormatInfo
+{
+	int Bytes; // Bytes of a cell
+	int Chars; // Characters of a cell
+	int ByteChars; // Characters of every byte of a cell, 0 when the cell is a single number
+	int DigitBits; // Bits of a digit typed by keys, 0 when not editable
+};
+
+static const ImGuiHexEditorCellFormatInfo CellFormatInfos[ImGuiHexEditorCellFormat_COUNT] =
+{
+	{ 1, 2, 2, 4 }, // Hex
+	{ 1, 8, 8, 1 }, // Binary
+	{ 1, 3, 3, 3 }, // Octal
+	{ 1, 3, 3, 0 }, // Unsigned
+	{ 1, 4, 4, 0 }, // Signed
+	{ 2, 4, 2, 4 }, // Hex16
+	{ 4, 8, 2, 4 }, // Hex32
+	{ 8, 16, 2, 4 }, // Hex64
+	{ 4, 13, 0, 0 }, // Float32, "%13.7g"
+	{ 8, 22, 0, 0 }, // Float64, "%22.15g"
+};
+
+static const ImGuiHexEditorCellFormatInfo& GetCellFormatInfo(ImGuiHexEditorCellFormat format)
+{
+	IM_ASSERT(format >= 0 && format < ImGuiHexEditorCellFormat_COUNT);
+	return CellFormatInfos[format];
+}
+
+// Digits typed into a byte, 1 for formats which aren't editable
+static int GetCellByteDigits(const ImGuiHexEditorCellFormatInfo& info)
+{
+	return info.DigitBits != 0 ? info.ByteChars : 1;
+}
+
+// Position of a byte within its cell from the left, also the byte at a position since the mapping is its own inverse
+static int GetCellSlot(int byte_in_cell, int cell_bytes, bool big_endian)
+{
+	return big_endian ? byte_in_cell : cell_bytes - 1 - byte_in_cell;
+}
+
+// Left of a digit of a byte relative to its cell, the whole part of the cell showing the byte for formats which aren't editable
+static float GetCellDigitX(const ImGuiHexEditorCellFormatInfo& info, bool big_endian, int byte_in_cell, int digit, float char_width, float* out_width)
+{
+	const int slot = GetCellSlot(byte_in_cell, info.Bytes, big_endian);
+	if (info.DigitBits != 0)
+	{
+		*out_width = char_width;
+		return (float)(slot * info.ByteChars + digit) * char_width;
+	}
+
+	const float slot_width = (float)info.Chars * char_width / (float)info.Bytes;
+	*out_width = slot_width;
+	return slot * slot_width;
+}
+
+// Byte of a cell and digit of the byte at x relative to the cell
+static int FindCellByte(const ImGuiHexEditorCellFormatInfo& info, bool big_endian, float x, float char_width, int* out_digit)
+{
+	const float slot_width = (float)info.Chars * char_width / (float)info.Bytes;
+	const int slot = ImClamp((int)(x / slot_width), 0, info.Bytes - 1);
+
+	*out_digit = info.DigitBits != 0 ? ImClamp((int)((x - slot * slot_width) / char_width), 0, info.ByteChars - 1) : 0;
+	return GetCellSlot(slot, info.Bytes, big_endian);
+}
+
+// Byte next to offset in the order bytes are shown, skipping the missing bytes of the last cell. -1 past either end
+static ImS64 StepVisualByte(ImS64 offset, int dir, int cell_bytes, bool big_endian, ImS64 max_bytes)
+{
+	ImS64 cell = offset - offset % cell_bytes;
+	int slot = GetCellSlot((int)(offset - cell), cell_bytes, big_endian);
+
+	for (;;)
+	{
+		slot += dir;
+		if (slot < 0)
+		{
+			cell -= cell_bytes;
+			slot = cell_bytes - 1;
+		}
+		else if (slot == cell_bytes)
+		{
+			cell += cell_bytes;
+			slot = 0;
+		}
+
+		if (cell < 0 || cell >= max_bytes)
+			return -1;
+
+		const ImS64 next = cell + GetCellSlot(slot, cell_bytes, big_endian);
+		if (next < max_bytes)
+			return next;
+	}
+}
+
+// Replaces a digit of byte with the one typed by key, returns false if the format has no such digit
+static bool WriteCellDigit(const ImGuiHexEditorCellFormatInfo& info, unsigned char byte, int digit, ImGuiKey key, unsigned char* out)
+{
+	const int value = KeyToHalfByte(key);
+	if (info.DigitBits == 0 || (value >> info.DigitBits) != 0)
+		return false;
+
+	const int shift = (info.ByteChars - 1 - digit) * info.DigitBits;
+	if ((value << shift) > 0xff)
+		return false;
+
+	const int mask = ((1 << info.DigitBits) - 1) << shift;
+	*out = (unsigned char)((byte & ~mask) | (value << shift));
+	return true;
+}
+
+// Text of every byte value for formats showing the digits of every byte, ByteChars characters per value
+static void BuildCellTable(char* table, ImGuiHexEditorCellFormat format, bool lowercase)
+{
+	const char* digits = lowercase ? "0123456789abcdef" : "0123456789ABCDEF";
+	const int byte_chars = GetCellFormatInfo(format).ByteChars;
+
+	for (int value = 0; value != 256; value++)
+	{
+		char* out = table + value * byte_chars;
+		switch (format)
+		{
+		case ImGuiHexEditorCellFormat_Binary:
+			for (int i = 0; i != 8; i++)
+				out[i] = (char)('0' + ((value >> (7 - i)) & 1));
+			break;
+		case ImGuiHexEditorCellFormat_Octal:
+			out[0] = (char)('0' + (value >> 6));
+			out[1] = (char)('0' + ((value >> 3) & 7));
+			out[2] = (char)('0' + (value & 7));
+			break;
+		case ImGuiHexEditorCellFormat_Unsigned:
+		case ImGuiHexEditorCellFormat_Signed:
+		{
+			// Right aligned
+			const int number = format == ImGuiHexEditorCellFormat_Signed ? (int)(signed char)value : value;
+			int magnitude = number < 0 ? -number : number;
+			int i = byte_chars - 1;
+			do
+			{
+				out[i--] = (char)('0' + magnitude % 10);
+				magnitude /= 10;
+			} while (magnitude != 0);
+
+			if (number < 0)
+				out[i--] = '-';
+			while (i >= 0)
+				out[i--] = ' ';
+			break;
+		}
+		default:
+			out[0] = digits[value >> 4];
+			out[1] = digits[value & 0x0f];
+			break;
+		}
+	}
+}
+
+// Text of a row of cells into out_cells, (bytes_per_line / Bytes) * Chars characters, and its ascii column into out_ascii
+// (bytes_per_line characters) unless it's nullptr. The size read bytes are followed by the missing ones, shown as '?'. Digits
+// come from table, built by BuildCellTable(), numbers of incomplete cells are all '?'
+static void FormatCellRow(ImGuiHexEditorCellFormat format, bool big_endian, bool lowercase, const char* table, const unsigned char* data, int size,
+	int bytes_per_line, char* out_cells, char* out_ascii)
+{
+	const ImGuiHexEditorCellFormatInfo& info = GetCellFormatInfo(format);
+
+	if (format == ImGuiHexEditorCellFormat_Hex)
+	{
+		FormatHexRow(data, size, lowercase, out_cells, out_ascii);
+		memset(out_cells + size * 2, '?', (size_t)(bytes_per_line - size) * 2);
+	}
+	else
+	{
+		for (int cell = 0; cell < bytes_per_line; cell += info.Bytes)
+		{
+			char* out = out_cells + (cell / info.Bytes) * info.Chars;
+			if (info.ByteChars != 0)
+			{
+				for (int i = 0; i != info.Bytes; i++)
+				{
+					char* out_byte = out + GetCellSlot(i, info.Bytes, big_endian) * info.ByteChars;
+					if (cell + i < size)
+						memcpy(out_byte, table + data[cell + i] * info.ByteChars, (size_t)info.ByteChars);
+					else
+						memset(out_byte, '?', (size_t)info.ByteChars);
+				}
+			}
+			else if (cell + info.Bytes <= size)
+			{
+				const ImU64 bits = LoadValueBits(data + cell, info.Bytes, big_endian);
+
+				char buf[32];
+				if (format == ImGuiHexEditorCellFormat_Float32)
+				{
+					const ImU32 value_bits = (ImU32)bits;
+					float value;
+					memcpy(&value, &value_bits, sizeof(value));
+					ImFormatString(buf, sizeof(buf), "%*.7g", info.Chars, value);
+				}
+				else
+				{
+					double value;
+					memcpy(&value, &bits, sizeof(value));
+					ImFormatString(buf, sizeof(buf), "%*.15g", info.Chars, value);
+				}
+				memcpy(out, buf, (size_t)info.Chars);
+			}
+			else
+				memset(out, '?', (size_t)info.Chars);
+		}
+
+		if (out_ascii)
+		{
+			for (int i = 0; i != size; i++)
+				out_ascii[i] = HasAsciiRepresentation(data[i]) ? (char)data[i] : '.';
+		}
+	}
+
+	if (out_ascii)
+		memset(out_ascii + size, '.', (size_t)(bytes_per_line - size));
+}
+
+// Layout of the cells of the hex or ascii column over the rows of a clipper step
+struct ImGuiHexEditorCellGrid
+{
+	const float* OffsetsX; // Left of every cell relative to X, or nullptr when cells are CellWidth apart
+	float X;
+	float FirstY;
+	ImS64 FirstLine; // Line drawn at FirstY
+	float LineHeight;
+	ImVec2 CellSize;
+	ImVec2 FullSizedPadding; // Added around cells of FullSized highlights, except above the first line
+	int BytesPerLine;
+};
+
+static ImRect GetCellRect(const ImGuiHexEditorCellGrid& grid, ImS64 line, int column, bool full_sized)
+{
+	const float x = grid.X + (grid.OffsetsX ? grid.OffsetsX[column] : grid.CellSize.x * column);
+	const float y = grid.FirstY + grid.LineHeight * (float)(line - grid.FirstLine);
+
+	ImRect bb = { { x, y }, { x + grid.CellSize.x, y + grid.CellSize.y } };
+	if (full_sized)
+	{
+		bb.Min.x -= grid.FullSizedPadding.x;
+		bb.Max.x += grid.FullSizedPadding.x;
+		if (line != grid.FirstLine)
+			bb.Min.y -= grid.FullSizedPadding.y;
+		bb.Max.y += grid.FullSizedPadding.y;
+	}
+
+	return bb;
+}
+
+enum ImGuiHexEditorCellMask_
+{
+	ImGuiHexEditorCellMask_Selected = 1 << 0,
+	ImGuiHexEditorCellMask_Highlighted = 1 << 1, // Has a single highlight applied
+};
+
+// Single highlight of a byte, queried for a whole row before its decorations are drawn
+struct ImGuiHexEditorCellHighlight
+{
+	ImGuiHexEditorHighlightFlags Flags;
+	ImColor Color;
+	ImColor BorderColor;
+	ImColor TextColor;
+};
+
+static ImColor CalcHighlightBorderColor(ImGuiHexEditorHighlightFlags flags, ImColor color, ImColor custom_border_color, ImColor border_color)
+{
+	if (flags & ImGuiHexEditorHighlightFlags_BorderAutomaticContrast)
+		return CalcContrastColor(color);
+	else if (flags & ImGuiHexEditorHighlightFlags_OverrideBorderColor)
+		return custom_border_color;
+
+	return border_color;
+}
+
+static bool IsCellInRange(ImS64 line, int column, int bytes_per_line, ImS64 range_min, ImS64 range_max)
+{
+	if (column < 0 || column >= bytes_per_line)
+		return false;
+
+	const ImS64 offset = line * bytes_per_line + column;
+	return offset >= range_min && offset <= range_max;
+}
+
+// Fills cells [first, last] of a line with one rect per run of touching cells, skipping cells whose mask has any of
+// the skip bits. Bordered highlights get rounded corners where the outline of [range_min, range_max] turns outwards.
+static void RenderHighlightRuns(ImDrawList* draw_list, const ImGuiHexEditorCellGrid& grid, ImS64 line, int first, int last, ImColor color,
+	ImGuiHexEditorHighlightFlags flags, bool full_sized, float rounding, ImS64 range_min, ImS64 range_max, const unsigned char* mask = nullptr, unsigned char skip = 0)
+{
+	const int bytes_per_line = grid.BytesPerLine;
+
+	int run_first = -1;
+	ImRect run_bb;
+
+	for (int column = first; column <= last + 1; column++)
+	{
+		const bool in_run = column <= last && !(mask && (mask[column] & skip));
+
+		ImRect bb;
+		if (in_run)
+		{
+			bb = GetCellRect(grid, line, column, full_sized);
+			if (run_first != -1 && bb.Min.x <= run_bb.Max.x + 0.5f)
+			{
+				run_bb.Max.x = bb.Max.x;
+				continue;
+			}
+		}
+
+		if (run_first != -1)
+		{
+			const int run_last = column - 1;
+
+			ImDrawFlags corners = ImDrawFlags_None;
+			if (flags & ImGuiHexEditorHighlightFlags_Border)
+			{
+				const bool left_open = !IsCellInRange(line, run_first - 1, bytes_per_line, range_min, range_max);
+				const bool right_open = !IsCellInRange(line, run_last + 1, bytes_per_line, range_min, range_max);
+
+				if (left_open && !IsCellInRange(line - 1, run_first, bytes_per_line, range_min, range_max))
+					corners |= ImDrawFlags_RoundCornersTopLeft;
+				if (right_open && !IsCellInRange(line - 1, run_last, bytes_per_line, range_min, range_max))
+					corners |= ImDrawFlags_RoundCornersTopRight;
+				if (right_open && !IsCellInRange(line + 1, run_last, bytes_per_line, range_min, range_max))
+					corners |= ImDrawFlags_RoundCornersBottomRight;
+				if (left_open && !IsCellInRange(line + 1, run_first, bytes_per_line, range_min, range_max))
+					corners |= ImDrawFlags_RoundCornersBottomLeft;
+			}
+
+			if (corners != ImDrawFlags_None)
+			{
+				const ImRect cell_bb = GetCellRect(grid, line, run_first, full_sized);
+				const float cell_rounding = ImMin(rounding, ImMin(cell_bb.GetWidth(), cell_bb.GetHeight()) * 0.5f);
+				draw_list->AddRectFilled(run_bb.Min, run_bb.Max, color, cell_rounding, corners);
+			}
+			else
+				draw_list->AddRectFilled(run_bb.Min, run_bb.Max, color, 0.f, ImDrawFlags_RoundCornersNone);
+		}
+
+		run_first = in_run ? column : -1;
+		run_bb = bb;
+	}
+}
+
+// Adds a corner of a clockwise outline, corners are numbered clockwise starting from the top left one
+static void PathOutlineCorner(ImDrawList* draw_list, const ImVec2& pos, int corner, float rounding)
+{
+	static const ImVec2 centers[4] = { { 1.f, 1.f }, { -1.f, 1.f }, { -1.f, -1.f }, { 1.f, -1.f } };
+	static const int arcs[4] = { 6, 9, 0, 3 };
+
+	if (rounding <= 0.f)
+		draw_list->PathLineTo(pos);
+	else
+		draw_list->PathArcToFast({ pos.x + centers[corner].x * rounding, pos.y + centers[corner].y * rounding }, rounding, arcs[corner], arcs[corner] + 3);
+}
+
+static void RenderOutlineRect(ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, ImColor color, float rounding)
+{
+	PathOutlineCorner(draw_list, { a.x + 0.5f, a.y + 0.5f }, 0, rounding);
+	PathOutlineCorner(draw_list, { b.x - 0.5f, a.y + 0.5f }, 1, rounding);
+	PathOutlineCorner(draw_list, { b.x - 0.5f, b.y - 0.5f }, 2, rounding);
+	PathOutlineCorner(draw_list, { a.x + 0.5f, b.y - 0.5f }, 3, rounding);
+	draw_list->PathStroke(color, ImDrawFlags_Closed, 1.f);
+}
+
+// Strokes the outline of the bytes [range_min, range_max] as a single path. Lines further than one line away from
+// [first_line, last_line] are cut off, the clip rect hides the rest.
+static void RenderHighlightOutline(ImDrawList* draw_list, const ImGuiHexEditorCellGrid& grid, ImS64 first_line, ImS64 last_line, ImColor color,
+	bool full_sized, float rounding, ImS64 range_min, ImS64 range_max)
+{
+	const int bytes_per_line = grid.BytesPerLine;
+
+	ImS64 start_line = range_min / bytes_per_line;
+	int start_column = (int)(range_min % bytes_per_line);
+	ImS64 end_line = range_max / bytes_per_line;
+	int end_column = (int)(range_max % bytes_per_line);
+
+	if (end_line < first_line || start_line > last_line)
+		return;
+
+	if (start_line < first_line - 1)
+	{
+		start_line = first_line - 1;
+		start_column = 0;
+	}
+
+	if (end_line > last_line + 1)
+	{
+		end_line = last_line + 1;
+		end_column = bytes_per_line - 1;
+	}
+
+	const ImRect first = GetCellRect(grid, start_line, start_column, full_sized);
+	const ImRect last = GetCellRect(grid, end_line, end_column, full_sized);
+	rounding = ImMin(rounding, ImMin(first.GetWidth(), first.GetHeight()) * 0.5f);
+
+	if (start_line == end_line)
+	{
+		RenderOutlineRect(draw_list, first.Min, last.Max, color, rounding);
+		return;
+	}
+
+	const float left_x = GetCellRect(grid, start_line + 1, 0, full_sized).Min.x + 0.5f;
+	const float right_x = GetCellRect(grid, end_line - 1, bytes_per_line - 1, full_sized).Max.x - 0.5f;
+
+	if (start_line + 1 == end_line && end_column < start_column)
+	{
+		// The parts on both lines don't touch
+		RenderOutlineRect(draw_list, first.Min, { right_x + 0.5f, first.Max.y }, color, rounding);
+		RenderOutlineRect(draw_list, { left_x - 0.5f, last.Min.y }, last.Max, color, rounding);
+		return;
+	}
+
+	const float top_y = first.Min.y + 0.5f;
+	const float second_top_y = GetCellRect(grid, start_line + 1, 0, full_sized).Min.y + 0.5f;
+	const float second_bottom_y = GetCellRect(grid, end_line - 1, 0, full_sized).Max.y - 0.5f;
+	const float bottom_y = last.Max.y - 0.5f;
+
+	PathOutlineCorner(draw_list, { first.Min.x + 0.5f, top_y }, 0, rounding);
+	PathOutlineCorner(draw_list, { right_x, top_y }, 1, rounding);
+	if (end_column != bytes_per_line - 1)
+	{
+		PathOutlineCorner(draw_list, { right_x, second_bottom_y }, 2, rounding);
+		draw_list->PathLineTo({ last.Max.x - 0.5f, second_bottom_y });
+	}
+	PathOutlineCorner(draw_list, { last.Max.x - 0.5f, bottom_y }, 2, rounding);
+	PathOutlineCorner(draw_list, { left_x, bottom_y }, 3, rounding);
+	if (start_column != 0)
+	{
+		PathOutlineCorner(draw_list, { left_x, second_top_y }, 0, rounding);
+		draw_list->PathLineTo({ first.Min.x + 0.5f, second_top_y });
+	}
+
+	draw_list->PathStroke(color, ImDrawFlags_Closed, 1.f);
+}
+
+// Geometry of one row kept between frames. Positions are relative to the floored origin of the row
+struct ImGuiHexEditorRowCacheEntry
+{
+	ImS64 LineBase = -1;
+	int BytesPerLine = 0;
+	ImU64 LayoutHash = 0;
+	ImU64 ContentHash = 0;
+	ImVector<ImDrawVert> Vertices;
+	ImVector<ImDrawIdx> Indices; // Relative to the first vertex
+	ImVector<ImGuiHexEditorGlyph> Glyphs;
+};
+
+struct ImGuiHexEditorRowCache
+{
+	ImVector<ImGuiHexEditorRowCacheEntry*> Entries; // Direct mapped by line, the size is a power of two
+};
+
+// Everything outside of the row itself which its geometry depends on
+struct ImGuiHexEditorRowCacheLayout
+{
+	const ImFont* Font;
+	const ImFontGlyph* FontGlyphs;
+	float FontSize;
+	ImVec2 TexUvWhitePixel;
+	ImVec2 CharSize;
+	ImVec2 Spacing;
+	float Rounding;
+	int BytesPerLine;
+	int Separators;
+	ImGuiHexEditorCellFormat CellFormat;
+	bool BigEndianCells;
+	ImU32 Colors[6];
+	ImGuiHexEditorHighlightFlags SelectionFlags;
+	ImGuiHexEditorHighlightFlags SearchFlags;
+	ImGuiHexEditorHighlightFlags DiffFlags;
+	ImGuiHexEditorHighlightFlags TemplateFlags;
+	bool LowercaseBytes;
+	bool ShowAscii;
+	bool RenderZeroesDisabled;
+};
+
+static ImU64 HashRowCacheData(ImU64 hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i != size; i++)
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+
+	return hash;
+}
+
+// Copies the vertices added to the draw list and the glyphs queued since the start of the row
+static void StoreRowCacheEntry(ImGuiHexEditorRowCacheEntry* entry, const ImDrawList* draw_list, int vtx_start, int idx_start, unsigned int vtx_index_start,
+	const ImVector<ImGuiHexEditorGlyph>& glyphs, int glyph_start, ImVec2 origin)
+{
+	const int vtx_count = draw_list->VtxBuffer.Size - vtx_start;
+	const int idx_count = draw_list->IdxBuffer.Size - idx_start;
+
+	// A draw command was started in the middle of the row, its indices can't be rebased
+	if (draw_list->_VtxCurrentIdx != vtx_index_start + (unsigned int)vtx_count)
+	{
+		entry->LineBase = -1;
+		return;
+	}
+
+	entry->Vertices.resize(vtx_count);
+	for (int i = 0; i != vtx_count; i++)
+	{
+		ImDrawVert vtx = draw_list->VtxBuffer[vtx_start + i];
+		vtx.pos.x -= origin.x;
+		vtx.pos.y -= origin.y;
+		entry->Vertices[i] = vtx;
+	}
+
+	entry->Indices.resize(idx_count);
+	for (int i = 0; i != idx_count; i++)
+		entry->Indices[i] = (ImDrawIdx)(draw_list->IdxBuffer[idx_start + i] - vtx_index_start);
+
+	entry->Glyphs.resize(glyphs.Size - glyph_start);
+	for (int i = 0; i != entry->Glyphs.Size; i++)
+	{
+		ImGuiHexEditorGlyph glyph = glyphs[glyph_start + i];
+		glyph.Pos.x -= origin.x;
+		glyph.Pos.y -= origin.y;
+		entry->Glyphs[i] = glyph;
+	}
+}
+
+static void ReplayRowCacheEntry(const ImGuiHexEditorRowCacheEntry& entry, ImDrawList* draw_list, ImVector<ImGuiHexEditorGlyph>& glyphs, ImVec2 origin)
+{
+	if (entry.Indices.Size > 0)
+	{
+		draw_list->PrimReserve(entry.Indices.Size, entry.Vertices.Size);
+
+		ImDrawVert* vtx_write = draw_list->_VtxWritePtr;
+		memcpy(vtx_write, entry.Vertices.Data, (size_t)entry.Vertices.Size * sizeof(ImDrawVert));
+		for (int i = 0; i != entry.Vertices.Size; i++)
+		{
+			vtx_write[i].pos.x += origin.x;
+			vtx_write[i].pos.y += origin.y;
+		}
+
+		ImDrawIdx* idx_write = draw_list->_IdxWritePtr;
+		const unsigned int vtx_index = draw_list->_VtxCurrentIdx;
+		for (int i = 0; i != entry.Indices.Size; i++)
+			idx_write[i] = (ImDrawIdx)(vtx_index + entry.Indices[i]);
+
+		draw_list->_VtxWritePtr += entry.Vertices.Size;
+		draw_list->_IdxWritePtr += entry.Indices.Size;
+		draw_list->_VtxCurrentIdx += entry.Vertices.Size;
+	}
+
+	const int glyph_start = glyphs.Size;
+	glyphs.resize(glyphs.Size + entry.Glyphs.Size);
+	for (int i = 0; i != entry.Glyphs.Size; i++)
+	{
+		ImGuiHexEditorGlyph& glyph = glyphs[glyph_start + i];
+		glyph = entry.Glyphs[i];
+		glyph.Pos.x += origin.x;
+		glyph.Pos.y += origin.y;
+	}
+}
+
+bool ImGui::BeginHexEditor(const char* str_id, ImGuiHexEditorState* state, const ImVec2& size, ImGuiChildFlags child_flags, ImGuiWindowFlags window_flags)
+{
+	if (!ImGui::BeginChild(str_id, size, child_flags, window_flags))
+		return false;
+
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	state->Stats = ImGuiHexEditorStats();
+	GHexEditorStats = &state->Stats;
+#endif
+	IMGUI_HEX_EDITOR_STAT_TIME(frame_start);
+
+	if (state->File)
+		state->MaxBytes = state->File->Size;
+
+	if (state->EditBuffer)
+		state->MaxBytes = ImGui::GetHexEditorEditBufferSize(state->EditBuffer);
+
+	UpdateHexEditorSearch(state);
+	if (state->Diff)
+		UpdateHexEditorDiff(state->Diff);
+
+	// Keys only go to the focused grid, editors showing a cursor next to each other would all react otherwise
+	ImGuiWindow* window = ImGui::GetCurrentWindow();
+	const ImGuiID grid_id = ImGui::GetID("##Grid");
+	const bool grid_focused = ImGui::GetFocusID() == grid_id;
+
+	if (state->Search && grid_focused && ImGui::IsKeyPressed(ImGuiKey_F3))
+		ImGui::SelectNextHexEditorSearchResult(state, ImGui::GetIO().KeyShift);
+
+	const ImGuiHexEditorCellFormat cell_format = state->CellFormat;
+	const ImGuiHexEditorCellFormatInfo& cell_info = GetCellFormatInfo(cell_format);
+	const int cell_bytes = cell_info.Bytes;
+	const int cell_digits = GetCellByteDigits(cell_info);
+	const bool big_endian_cells = state->BigEndianCells;
+
+	const ImVec2 char_size = ImGui::CalcTextSize("0");
+	const ImVec2 cell_size = { char_size.x * cell_info.Chars, char_size.y };
+
+	const ImGuiStyle& style = ImGui::GetStyle();
+	const ImVec2 spacing = style.ItemSpacing;
+
+	ImVec2 content_avail = ImGui::GetContentRegionAvail();
+
+	float address_max_size;
+	int address_max_chars;
+	if (state->ShowAddress)
+	{
+		int address_chars = state->AddressChars;
+		if (address_chars == -1)
+			address_chars = ImFormatString(nullptr, 0, "%llX", (unsigned long long)state->MaxBytes) + 1;
+
+		address_max_chars = address_chars + 1;
+		address_max_size = char_size.x * address_max_chars + spacing.x * 0.5f;
+	}
+	else
+	{
+		address_max_size = 0.f;
+		address_max_chars = 0;
+	}
+
+	float bytes_avail_x = content_avail.x - address_max_size;
+	if (ImGui::GetScrollMaxY() > 0.f)
+		bytes_avail_x -= style.ScrollbarSize;
+
+	const bool show_ascii = state->ShowAscii;
+
+	if (show_ascii)
+		bytes_avail_x -= char_size.x * 0.5f;
+
+	bytes_avail_x = bytes_avail_x < 0.f ? 0.f : bytes_avail_x;
+
+	const int separator_bytes = CalcSeparatorBytes(state->Separators, cell_bytes);
+	int bytes_per_line;
+
+	if (state->BytesPerLine == -1)
+	{
+		bytes_per_line = CalcBytesPerLine(bytes_avail_x, cell_size, cell_bytes, spacing, show_ascii, char_size, separator_bytes);
+	}
+	else
+	{
+		// Whole cells only
+		bytes_per_line = state->BytesPerLine > 0 ? ImMax(state->BytesPerLine - state->BytesPerLine % cell_bytes, cell_bytes) : 0;
+	}
+
+	state->DisplayBytesPerLine = bytes_per_line;
+
+	ImS64 lines_count;
+	if (bytes_per_line != 0)
+	{
+		lines_count = state->MaxBytes / bytes_per_line;
+		if (lines_count * bytes_per_line < state->MaxBytes)
+		{
+			++lines_count;
+		}
+	}
+	else
+		lines_count = 0;
+
+	int scroll_lines_count;
+	ImS64 scroll_base_line;
+	if (lines_count > IMGUI_HEX_EDITOR_MAX_SCROLL_LINES)
+	{
+		scroll_lines_count = IMGUI_HEX_EDITOR_MAX_SCROLL_LINES;
+		scroll_base_line = ImClamp(state->ScrollBaseLine, (ImS64)0, lines_count - scroll_lines_count);
+	}
+	else
+	{
+		scroll_lines_count = (int)lines_count;
+		scroll_base_line = 0;
+	}
+
+	ImDrawList* draw_list = ImGui::GetWindowDrawList();
+	ImGuiIO& io = ImGui::GetIO();
+
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	const int draw_list_vtx_start = draw_list->VtxBuffer.Size;
+	const int draw_list_idx_start = draw_list->IdxBuffer.Size;
+#endif
+
+	const ImColor text_color = ImGui::GetColorU32(ImGuiCol_Text);
+	const ImColor text_disabled_color = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+	const ImColor text_selected_bg_color = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
+	const ImColor separator_color = ImGui::GetColorU32(ImGuiCol_Separator);
+	const ImColor border_color = ImGui::GetColorU32(ImGuiCol_FrameBgActive);
+	const ImColor search_color = ImGui::GetColorU32(ImGuiCol_PlotHistogram, 0.5f);
+	const ImColor diff_color = ImGui::GetColorU32(ImGuiCol_PlotLinesHovered, 0.5f);
+
+	const bool lowercase_bytes = state->LowercaseBytes;
+	const bool read_only = state->ReadOnly || (state->File && !state->EditBuffer && !(state->File->Flags & ImGuiHexEditorFileFlags_CopyOnWrite));
+
+	// Sub bytes are digits of the cell format, they may have been left by another one
+	const ImS64 select_start_byte = state->SelectStartByte;
+	const int select_start_subbyte = ImClamp(state->SelectStartSubByte, 0, cell_digits - 1);
+	const ImS64 select_end_byte = state->SelectEndByte;
+	const int select_end_subbyte = ImClamp(state->SelectEndSubByte, 0, cell_digits - 1);
+	const ImS64 last_selected_byte = state->LastSelectedByte;
+	const ImS64 select_drag_byte = state->SelectDragByte;
+	const int select_drag_subbyte = ImClamp(state->SelectDragSubByte, 0, cell_digits - 1);
+
+	ImS64 next_select_start_byte = select_start_byte;
+	int next_select_start_subbyte = select_start_subbyte;
+	ImS64 next_select_end_byte = select_end_byte;
+	int next_select_end_subbyte = select_end_subbyte;
+	ImS64 next_last_selected_byte = last_selected_byte;
+	ImS64 next_select_drag_byte = select_drag_byte;
+	int next_select_drag_subbyte = select_drag_subbyte;
+
+	ImGuiKey hex_key_pressed = ImGuiKey_None;
+
+	IMGUI_HEX_EDITOR_STAT_TIME(input_start);
+	if (grid_focused)
+	{
+		if (state->EnableClipboard && ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_C))
+		{
+			if (state->SelectStartByte != -1)
+				ImGui::CopyHexEditorBytes(state, state->SelectStartByte, state->SelectEndByte, state->ClipboardFormat, state->ClipboardFlags, bytes_per_line);
+		}
+		else if (state->EnableClipboard && !read_only && ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_V))
+		{
+			if (state->SelectStartByte != -1)
+			{
+				const bool insert = (state->ClipboardFlags & ImGuiHexEditorClipboardFlags_PasteInsert) && state->EditBuffer;
+				const ImS64 written = ImGui::PasteHexEditorBytes(state, state->SelectStartByte, ImGui::GetClipboardText(), state->PasteFormat, insert);
+
+				// Select the pasted bytes
+				if (written > 0)
+				{
+					next_select_start_byte = state->SelectStartByte;
+					next_select_start_subbyte = 0;
+					next_select_end_byte = state->SelectStartByte + written - 1;
+					next_select_end_subbyte = 0;
+					next_last_selected_byte = next_select_end_byte;
+				}
+			}
+		}
+		else if (state->EditBuffer && !read_only && ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Z))
+		{
+			ImGui::UndoHexEditorEdit(state->EditBuffer);
+		}
+		else if (state->EditBuffer && !read_only && (ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Y) || ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_Z)))
+		{
+			ImGui::RedoHexEditorEdit(state->EditBuffer);
+		}
+		else
+		{
+
+			if (last_selected_byte != -1)
+			{
+				bool any_pressed = false;
+				// Left and right go over the digits in the order they are shown, across the bytes of multi-byte cells
+				if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow))
+				{
+					if (!select_start_subbyte)
+					{
+						const ImS64 prev_byte = StepVisualByte(last_selected_byte, -1, cell_bytes, big_endian_cells, state->MaxBytes);
+						if (prev_byte != -1)
+						{
+							next_last_selected_byte = prev_byte;
+							next_select_start_subbyte = cell_digits - 1;
+						}
+					}
+					else
+						next_select_start_subbyte = select_start_subbyte - 1;
+
+					any_pressed = true;
+				}
+				else if (ImGui::IsKeyPressed(ImGuiKey_RightArrow))
+				{
+					if (select_start_subbyte == cell_digits - 1)
+					{
+						const ImS64 next_byte = StepVisualByte(last_selected_byte, 1, cell_bytes, big_endian_cells, state->MaxBytes);
+						if (next_byte != -1)
+						{
+							next_last_selected_byte = next_byte;
+							next_select_start_subbyte = 0;
+						}
+						else if (last_selected_byte >= state->MaxBytes)
+							next_last_selected_byte = state->MaxBytes - 1;
+					}
+					else
+						next_select_start_subbyte = select_start_subbyte + 1;
+
+					any_pressed = true;
+				}
+				else if (bytes_per_line != 0)
+				{
+					if (ImGui::IsKeyPressed(ImGuiKey_UpArrow))
+					{
+						if (last_selected_byte >= bytes_per_line)
+						{
+							next_last_selected_byte = last_selected_byte - bytes_per_line;
+						}
+
+						any_pressed = true;
+					}
+					else if (ImGui::IsKeyPressed(ImGuiKey_DownArrow))
+					{
+						if (last_selected_byte < state->MaxBytes - bytes_per_line)
+						{
+							next_last_selected_byte = last_selected_byte + bytes_per_line;
+						}
+
+						any_pressed = true;
+					}
+				}
+
+				if (any_pressed)
+				{
+					next_select_start_byte = next_last_selected_byte;
+					next_select_end_byte = next_last_selected_byte;
+				}
+			}
+
+			for (ImGuiKey key = ImGuiKey_A; key != ImGuiKey_G; key = (ImGuiKey)((int)key + 1))
+			{
+				if (ImGui::IsKeyPressed(key))
+				{
+					hex_key_pressed = key;
+					break;
+				}
+			}
+
+			if (hex_key_pressed == ImGuiKey_None)
+			{
+				for (ImGuiKey key = ImGuiKey_0; key != ImGuiKey_A; key = (ImGuiKey)((int)key + 1))
+				{
+					if (ImGui::IsKeyPressed(key))
+					{
+						hex_key_pressed = key;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	IMGUI_HEX_EDITOR_STAT(InputTime += (float)(GetStatsTime() - input_start));
+
+	unsigned char stack_line_buf[128];
+	unsigned char* line_buf = bytes_per_line <= sizeof(stack_line_buf) ? stack_line_buf : (unsigned char*)ImGui::MemAlloc(bytes_per_line);
+	if (!line_buf)
+	{
+		IMGUI_HEX_EDITOR_STAT(TotalTime = (float)(GetStatsTime() - frame_start));
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+		GHexEditorStats = nullptr;
+#endif
+		return true;
+	}
+
+	char stack_address_buf[32];
+	char* address_buf = address_max_chars <= sizeof(stack_address_buf) ? stack_address_buf : (char*)ImGui::MemAlloc(address_max_chars);
+	if (!address_buf)
+	{
+		if (line_buf != stack_line_buf)
+			ImGui::MemFree(line_buf);
+
+		IMGUI_HEX_EDITOR_STAT(TotalTime = (float)(GetStatsTime() - frame_start));
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+		GHexEditorStats = nullptr;
+#endif
+		return true;
+	}
+
+	const ImVec2 mouse_pos = ImGui::GetMousePos();
+	const bool mouse_left_down = ImGui::IsMouseDown(ImGuiMouseButton_Left);
+
+	UpdateHighlightRangesIndex(state);
+	ImVector<ImGuiHexEditorHighlightRange> step_ranges;
+	ImVector<ImGuiHexEditorHighlightRange> step_callback_ranges;
+	ImVector<int> step_line_starts;
+	ImVector<int> step_line_ranges;
+	ImVector<int> row_ranges;
+	ImVector<ImS64> row_matches;
+	ImVector<ImS64> row_diffs;
+	ImVector<int> row_fields;
+
+	ImGuiHexEditorTemplate* tpl = state->Template;
+
+	ImGuiHexEditorDiff* diff = state->Diff;
+	const int diff_side = diff && diff->States[1] == state ? 1 : 0;
+
+	ImVector<ImGuiHexEditorCellHighlight> row_highlights;
+	row_highlights.resize(bytes_per_line);
+	ImVector<unsigned char> row_mask;
+	row_mask.resize(bytes_per_line);
+	const int row_cells_chars = (bytes_per_line / cell_bytes) * cell_info.Chars;
+	ImVector<char> row_text; // Cells of a row followed by its ascii column
+	row_text.resize(row_cells_chars + bytes_per_line);
+
+	char cell_table[256 * 8];
+	if (cell_info.ByteChars != 0 && cell_format != ImGuiHexEditorCellFormat_Hex)
+		BuildCellTable(cell_table, cell_format, lowercase_bytes);
+
+	ImGuiHexEditorGlyphTable glyph_table;
+	BuildGlyphTable(&glyph_table, ImGui::GetFont(), ImGui::GetFontSize());
+
+	// Text of a whole clipper step is queued and emitted at once after its decorations
+	ImVector<ImGuiHexEditorGlyph> step_glyphs;
+
+	const bool has_single_highlight = HasSingleHighlightCallback(state);
+
+	// Watched sources are drawn from the polled copy
+	ImGuiHexEditorWatch* watch = state->EditBuffer ? nullptr : state->Watch;
+	const float watch_time = watch ? GetWatchTime(watch) : 0.f;
+	ImVector<float> row_change_times;
+	if (watch)
+		row_change_times.resize(bytes_per_line);
+
+	ImGuiHexEditorWriteQueue* write_queue = state->EditBuffer ? nullptr : state->WriteQueue;
+	ImVector<unsigned char> row_write_states;
+	if (write_queue)
+		row_write_states.resize(bytes_per_line);
+
+	// The largest clipper step is the visible range, polled next by the watch thread
+	int visible_lines = 0;
+	ImS64 visible_from = 0;
+	ImS64 visible_size = 0;
+
+	ImGuiHexEditorRowCache* row_cache = state->RowCache;
+	ImU64 row_cache_layout_hash = 0;
+	if (row_cache)
+	{
+		ImGuiHexEditorRowCacheLayout layout;
+		memset((void*)&layout, 0, sizeof(layout));
+		layout.Font = ImGui::GetFont();
+		layout.FontGlyphs = layout.Font->Glyphs.Data;
+		layout.FontSize = ImGui::GetFontSize();
+		layout.TexUvWhitePixel = draw_list->_Data->TexUvWhitePixel;
+		layout.CharSize = char_size;
+		layout.Spacing = spacing;
+		layout.Rounding = style.FrameRounding;
+		layout.BytesPerLine = bytes_per_line;
+		layout.Separators = state->Separators;
+		layout.CellFormat = cell_format;
+		layout.BigEndianCells = big_endian_cells;
+		layout.Colors[0] = text_color;
+		layout.Colors[1] = text_disabled_color;
+		layout.Colors[2] = text_selected_bg_color;
+		layout.Colors[3] = border_color;
+		layout.Colors[4] = search_color;
+		layout.Colors[5] = diff_color;
+		layout.SelectionFlags = state->SelectionHighlightFlags;
+		layout.SearchFlags = state->SearchHighlightFlags;
+		layout.DiffFlags = state->DiffHighlightFlags;
+		layout.TemplateFlags = state->TemplateHighlightFlags;
+		layout.LowercaseBytes = lowercase_bytes;
+		layout.ShowAscii = show_ascii;
+		layout.RenderZeroesDisabled = state->RenderZeroesDisabled;
+		row_cache_layout_hash = HashRowCacheData(0xcbf29ce484222325ull, &layout, sizeof(layout));
+	}
+
+	ImS64 scroll_to_byte = state->ScrollToByte;
+	state->ScrollToByte = -1;
+	if (next_last_selected_byte != last_selected_byte && next_last_selected_byte >= 0)
+		scroll_to_byte = next_last_selected_byte;
+
+	if (scroll_lines_count < lines_count && scroll_to_byte >= 0)
+	{
+		// Keyboard navigation or a requested scroll left the scroll window, center it around the new cursor line
+		const ImS64 cursor_line = ImMin(scroll_to_byte / bytes_per_line, lines_count - 1);
+		if (cursor_line < scroll_base_line || cursor_line >= scroll_base_line + scroll_lines_count)
+			scroll_base_line = ImClamp(cursor_line - scroll_lines_count / 2, (ImS64)0, lines_count - scroll_lines_count);
+	}
+
+	// The whole grid is a single item, the byte under the mouse is found from the row layout instead of
+	// submitting an item per byte
+	bool grid_added = false;
+	bool grid_hovered = false;
+	bool grid_clicked = false;
+
+	ImVector<float> byte_offsets_x;
+	CalcByteOffsetsX(byte_offsets_x, bytes_per_line, cell_bytes, cell_size.x, spacing.x, separator_bytes);
+
+	if (select_drag_byte != -1 && !mouse_left_down)
+		next_select_drag_byte = -1;
+
+	const float line_height = cell_size.y + spacing.y;
+	const float clipper_start_y = ImGui::GetCursorScreenPos().y;
+
+	ImGuiListClipper clipper;
+	clipper.Begin(scroll_lines_count, line_height);
+	while (clipper.Step())
+	{
+		const int clipper_lines = clipper.DisplayEnd - clipper.DisplayStart;
+
+		if (state->PageCache)
+		{
+			const ImS64 display_from = (scroll_base_line + clipper.DisplayStart) * bytes_per_line;
+			const ImS64 display_to = ImMin((scroll_base_line + clipper.DisplayEnd) * bytes_per_line, state->MaxBytes);
+			RequestPageCacheRange(state->PageCache, display_from, display_to, state->MaxBytes);
+		}
+		else if (state->File)
+		{
+			const ImS64 display_from = (scroll_base_line + clipper.DisplayStart) * bytes_per_line;
+			const ImS64 display_to = ImMin((scroll_base_line + clipper.DisplayEnd) * bytes_per_line, state->MaxBytes);
+			AdviseFileRange(state->File, display_from, display_to);
+		}
+
+		ImVec2 cursor = ImGui::GetCursorScreenPos();
+
+		const float cells_width = bytes_per_line > 0 ? byte_offsets_x[bytes_per_line - 1] + cell_size.x + spacing.x : 0.f;
+		ImVec2 ascii_cursor = { cursor.x + address_max_size + (spacing.x * 0.5f) + cells_width, cursor.y };
+
+		if (!grid_added)
+		{
+			const ImRect grid_bb = { { cursor.x + address_max_size, window->InnerClipRect.Min.y }, { ascii_cursor.x, window->InnerClipRect.Max.y } };
+
+			ImGui::ItemAdd(grid_bb, grid_id, 0, ImGuiItemFlags_Inputable);
+			grid_hovered = ImGui::ItemHoverable(grid_bb, grid_id, ImGuiItemFlags_Inputable);
+			grid_clicked = grid_hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left);
+			grid_added = true;
+		}
+
+		if (show_ascii)
+		{
+			draw_list->AddLine(ascii_cursor, { ascii_cursor.x, ascii_cursor.y + clipper_lines * (cell_size.y + spacing.y) }, separator_color);
+		}
+
+		{
+			int count = clipper_lines * row_cells_chars;
+			if (show_ascii)
+				count += clipper_lines * bytes_per_line;
+
+			draw_list->IdxBuffer.reserve(draw_list->IdxBuffer.Size + (count * 6));
+			draw_list->VtxBuffer.reserve(draw_list->VtxBuffer.Size + (count * 4));
+			step_glyphs.reserve(count + clipper_lines * (address_max_chars + 1));
+		}
+
+		const ImS64 step_first_line = scroll_base_line + clipper.DisplayStart;
+		const ImS64 step_last_line = scroll_base_line + clipper.DisplayEnd - 1;
+
+		if (clipper_lines > visible_lines)
+		{
+			visible_lines = clipper_lines;
+			visible_from = step_first_line * bytes_per_line;
+			visible_size = ImMin((step_last_line + 1) * bytes_per_line, state->MaxBytes) - visible_from;
+		}
+
+		CollectStepHighlightRanges(state, step_first_line, clipper_lines, bytes_per_line, step_ranges, step_callback_ranges, step_line_starts, step_line_ranges, row_ranges);
+
+		ImGuiHexEditorCellGrid hex_grid;
+		hex_grid.OffsetsX = byte_offsets_x.Data;
+		hex_grid.X = cursor.x + address_max_size + spacing.x * 0.5f;
+		hex_grid.FirstY = cursor.y;
+		hex_grid.FirstLine = step_first_line;
+		hex_grid.LineHeight = line_height;
+		hex_grid.CellSize = cell_size;
+		hex_grid.FullSizedPadding = { spacing.x * 0.5f, spacing.y * 0.5f };
+		hex_grid.BytesPerLine = bytes_per_line;
+
+		ImGuiHexEditorCellGrid ascii_grid = hex_grid;
+		ascii_grid.OffsetsX = nullptr;
+		ascii_grid.X = ascii_cursor.x + spacing.x;
+		ascii_grid.CellSize = char_size;
+		ascii_grid.FullSizedPadding = { 0.f, 0.f };
+
+		for (int clipper_n = clipper.DisplayStart; clipper_n != clipper.DisplayEnd; clipper_n++)
+		{
+			const ImS64 n = scroll_base_line + clipper_n;
+			const ImS64 line_base = n * bytes_per_line;
+
+			IMGUI_HEX_EDITOR_STAT_TIME(text_start);
+			if (state->ShowAddress)
+			{
+				if (!GetAddressName(state, line_base, address_buf, address_max_chars))
+					ImFormatString(address_buf, (size_t)address_max_chars, "%0.*llX", address_max_chars - 1, (unsigned long long)line_base);
+
+				float address_end_x;
+				if (PushGlyphs(step_glyphs, glyph_table, cursor, address_buf, (int)strlen(address_buf), text_color, &address_end_x))
+					PushGlyphs(step_glyphs, glyph_table, { address_end_x, cursor.y }, ":", 1, text_disabled_color);
+				else
+				{
+					const ImVec2 text_size = ImGui::CalcTextSize(address_buf);
+					draw_list->AddText(cursor, text_color, address_buf);
+					draw_list->AddText({ cursor.x + text_size.x, cursor.y }, text_disabled_color, ":");
+				}
+				cursor.x += address_max_size;
+			}
+			IMGUI_HEX_EDITOR_STAT_TIME(read_start);
+			IMGUI_HEX_EDITOR_STAT(TextTime += (float)(read_start - text_start));
+
+			const int max_bytes_per_line = (int)ImMin((ImS64)bytes_per_line, state->MaxBytes - line_base);
+			int bytes_read;
+			const unsigned char* line_bytes;
+			bool row_fading = false;
+			if (watch && ReadWatchBytes(watch, line_base, max_bytes_per_line, line_buf, row_change_times.Data))
+			{
+				line_bytes = line_buf;
+				bytes_read = max_bytes_per_line;
+				for (int i = 0; i != bytes_read && !row_fading; i++)
+					row_fading = watch_time - row_change_times[i] < watch->Config.FadeTime;
+			}
+			else
+				line_bytes = AccessVisibleBytes(state, line_base, max_bytes_per_line, line_buf, &bytes_read);
+
+			const bool row_writes = write_queue && max_bytes_per_line > 0 && QueryWriteStates(write_queue, line_base, max_bytes_per_line, row_write_states.Data);
+
+			IMGUI_HEX_EDITOR_STAT_TIME(decoration_start);
+			IMGUI_HEX_EDITOR_STAT(ReadTime += (float)(decoration_start - read_start));
+			IMGUI_HEX_EDITOR_STAT(Rows++);
+			IMGUI_HEX_EDITOR_STAT(Bytes += max_bytes_per_line);
+
+			cursor.x += spacing.x * 0.5f;
+			const float row_x = cursor.x;
+
+			ImS64 hovered_offset = -1;
+			int hovered_digit = 0;
+			if (grid_hovered)
+			{
+				const float row_min_y = clipper_n != clipper.DisplayStart ? cursor.y - spacing.y * 0.5f : cursor.y;
+				const float row_max_y = cursor.y + cell_size.y + spacing.y * 0.5f;
+
+				if (mouse_pos.y >= row_min_y && mouse_pos.y < row_max_y)
+				{
+					int column = FindByteColumn(byte_offsets_x, mouse_pos.x - cursor.x, cell_size.x, spacing.x);
+					if (column != -1)
+					{
+						const float cell_x = mouse_pos.x - cursor.x - byte_offsets_x[column];
+						column = column - column % cell_bytes + FindCellByte(cell_info, big_endian_cells, cell_x, char_size.x, &hovered_digit);
+					}
+
+					if (column != -1 && line_base + column < state->MaxBytes)
+						hovered_offset = line_base + column;
+				}
+			}
+
+			// Ranges are applied in their order, later ones override the text color of earlier ones
+			const int step_line = clipper_n - clipper.DisplayStart;
+			row_ranges.resize(step_line_starts[step_line + 1] - step_line_starts[step_line]);
+			if (row_ranges.Size > 0)
+				memcpy(row_ranges.Data, step_line_ranges.Data + step_line_starts[step_line], sizeof(int) * (size_t)row_ranges.Size);
+
+			row_matches.resize(0);
+			QuerySearchResults(state, line_base, line_base + bytes_per_line - 1, row_matches);
+
+			row_diffs.resize(0);
+			if (diff)
+				QueryDiffHunks(diff, diff_side, line_base, line_base + bytes_per_line - 1, row_diffs);
+
+			row_fields.resize(0);
+			if (tpl)
+				QueryTemplateLeaves(tpl, line_base, line_base + bytes_per_line - 1, row_fields);
+
+			const ImS64 row_select_from = ImMax(select_start_byte, line_base);
+			const ImS64 row_select_to = ImMin(select_end_byte, line_base + bytes_per_line - 1);
+
+			// Rows away from the mouse, the cursor and key writes reuse the geometry of a previous frame while their bytes and highlights stay the same
+			const ImVec2 row_origin = { (float)(int)row_x, (float)(int)cursor.y };
+			const ImS64 row_last = line_base + bytes_per_line - 1;
+			ImGuiHexEditorRowCacheEntry* cache_entry = nullptr;
+			ImU64 row_hash = 0;
+			if (row_cache && !has_single_highlight && !row_fading && !row_writes && hovered_offset == -1 && !(select_start_byte >= line_base && select_start_byte <= row_last)
+				&& !(hex_key_pressed != ImGuiKey_None && last_selected_byte >= line_base && last_selected_byte <= row_last))
+			{
+				const int row_info[3] = { max_bytes_per_line, bytes_read, clipper_n == clipper.DisplayStart };
+				const float row_origin_frac[2] = { row_x - row_origin.x, cursor.y - row_origin.y };
+
+				row_hash = HashRowCacheData(0xcbf29ce484222325ull, line_bytes, (size_t)bytes_read);
+				row_hash = HashRowCacheData(row_hash, row_info, sizeof(row_info));
+				row_hash = HashRowCacheData(row_hash, row_origin_frac, sizeof(row_origin_frac));
+				if (row_select_from <= row_select_to)
+				{
+					const ImS64 selection[2] = { select_start_byte, select_end_byte };
+					row_hash = HashRowCacheData(row_hash, selection, sizeof(selection));
+				}
+
+				for (int j = 0; j != row_ranges.Size; j++)
+				{
+					const ImGuiHexEditorHighlightRange& range = step_ranges[row_ranges[j]];
+					const ImU32 color = range.Color;
+					row_hash = HashRowCacheData(row_hash, &range.From, sizeof(range.From));
+					row_hash = HashRowCacheData(row_hash, &range.To, sizeof(range.To));
+					row_hash = HashRowCacheData(row_hash, &color, sizeof(color));
+					row_hash = HashRowCacheData(row_hash, &range.Flags, sizeof(range.Flags));
+				}
+				row_hash = HashRowCacheData(row_hash, row_matches.Data, (size_t)row_matches.Size * sizeof(ImS64));
+				row_hash = HashRowCacheData(row_hash, row_diffs.Data, (size_t)row_diffs.Size * sizeof(ImS64));
+
+				for (int j = 0; j != row_fields.Size; j++)
+				{
+					const ImGuiHexEditorTemplateLeaf& leaf = tpl->Leaves[row_fields[j]];
+					row_hash = HashRowCacheData(row_hash, &leaf.Offset, sizeof(leaf.Offset));
+					row_hash = HashRowCacheData(row_hash, &leaf.Size, sizeof(leaf.Size));
+					row_hash = HashRowCacheData(row_hash, &leaf.Color, sizeof(leaf.Color));
+				}
+
+				cache_entry = row_cache->Entries[(int)(n & (row_cache->Entries.Size - 1))];
+				if (cache_entry->LineBase == line_base && cache_entry->BytesPerLine == bytes_per_line && cache_entry->LayoutHash == row_cache_layout_hash
+					&& cache_entry->ContentHash == row_hash)
+				{
+					ReplayRowCacheEntry(*cache_entry, draw_list, step_glyphs, row_origin);
+					IMGUI_HEX_EDITOR_STAT(CachedRows++);
+
+					if (bytes_per_line > 0)
+						cursor.x = row_x + byte_offsets_x[bytes_per_line - 1] + cell_size.x + spacing.x;
+
+					ImGui::SetCursorScreenPos(cursor);
+
+					IMGUI_HEX_EDITOR_STAT(DecorationTime += (float)(GetStatsTime() - decoration_start));
+
+					ImGui::NewLine();
+					cursor = ImGui::GetCursorScreenPos();
+					continue;
+				}
+			}
+
+			const int row_vtx_start = draw_list->VtxBuffer.Size;
+			const int row_idx_start = draw_list->IdxBuffer.Size;
+			const unsigned int row_vtx_index_start = draw_list->_VtxCurrentIdx;
+			const int row_glyph_start = step_glyphs.Size;
+
+			for (int i = 0; i != bytes_per_line; i++)
+			{
+				const ImS64 offset = line_base + i;
+				ImGuiHexEditorCellHighlight& highlight = row_highlights[i];
+
+				highlight.Flags = ImGuiHexEditorHighlightFlags_None;
+				highlight.TextColor = (offset >= state->MaxBytes || i >= bytes_read || (state->RenderZeroesDisabled && line_bytes[i] == 0x00)) ? text_disabled_color : text_color;
+				row_mask[i] = (offset >= row_select_from && offset <= row_select_to) ? ImGuiHexEditorCellMask_Selected : 0;
+
+				if (row_mask[i])
+					continue;
+
+				if (has_single_highlight)
+				{
+					ImColor custom_border_color;
+					const ImGuiHexEditorHighlightFlags flags = GetSingleHighlight(state, offset, &highlight.Color, &highlight.TextColor, &custom_border_color);
+					IMGUI_HEX_EDITOR_STAT(SingleHighlightCalls++);
+
+					if (flags & ImGuiHexEditorHighlightFlags_Apply)
+					{
+						highlight.Flags = flags;
+						highlight.BorderColor = CalcHighlightBorderColor(flags, highlight.Color, custom_border_color, border_color);
+						row_mask[i] |= ImGuiHexEditorCellMask_Highlighted;
+
+						if (flags & ImGuiHexEditorHighlightFlags_TextAutomaticContrast)
+							highlight.TextColor = CalcContrastColor(highlight.Color);
+						continue;
+					}
+				}
+
+				// Queued and failed writes, the callback takes precedence
+				if (row_writes && i < max_bytes_per_line && row_write_states[i] != ImGuiHexEditorWriteState_None)
+				{
+					const ImGuiHexEditorHighlightFlags flags = write_queue->Config.HighlightFlags | ImGuiHexEditorHighlightFlags_Apply;
+					highlight.Flags = flags;
+					highlight.Color = row_write_states[i] == ImGuiHexEditorWriteState_Failed ? write_queue->Config.FailedColor : write_queue->Config.PendingColor;
+					highlight.BorderColor = CalcHighlightBorderColor(flags, highlight.Color, highlight.Color, border_color);
+					row_mask[i] |= ImGuiHexEditorCellMask_Highlighted;
+
+					if (flags & ImGuiHexEditorHighlightFlags_TextAutomaticContrast)
+						highlight.TextColor = CalcContrastColor(highlight.Color);
+					continue;
+				}
+
+				// Bytes changed by the watch fade out, the callback and writes take precedence
+				const float change_age = row_fading ? watch_time - row_change_times[i] : FLT_MAX;
+				if (row_fading && change_age < watch->Config.FadeTime)
+				{
+					const ImGuiHexEditorHighlightFlags flags = watch->Config.HighlightFlags | ImGuiHexEditorHighlightFlags_Apply;
+					highlight.Flags = flags;
+					highlight.Color = watch->Config.Color;
+					highlight.Color.Value.w *= 1.f - change_age / watch->Config.FadeTime;
+					highlight.BorderColor = CalcHighlightBorderColor(flags, highlight.Color, highlight.Color, border_color);
+					row_mask[i] |= ImGuiHexEditorCellMask_Highlighted;
+
+					if (flags & ImGuiHexEditorHighlightFlags_TextAutomaticContrast)
+						highlight.TextColor = CalcContrastColor(highlight.Color);
+				}
+			}
+
+			// Decorations are filled one run of touching cells at a time, outlines are stroked once per clipper step below
+			if (row_select_from <= row_select_to)
+			{
+				const ImGuiHexEditorHighlightFlags flags = state->SelectionHighlightFlags;
+				const int first = (int)(row_select_from - line_base);
+				const int last = (int)(row_select_to - line_base);
+
+				if (select_start_byte == select_end_byte)
+				{
+					// Only the digit of a single selected byte under the cursor is highlighted
+					const bool has_border = (flags & ImGuiHexEditorHighlightFlags_Border) != 0;
+					ImRect bb = GetCellRect(hex_grid, n, first, false);
+
+					float digit_width;
+					bb.Min.x += GetCellDigitX(cell_info, big_endian_cells, first % cell_bytes, select_start_subbyte, char_size.x, &digit_width);
+					bb.Max.x = bb.Min.x + digit_width;
+
+					draw_list->AddRectFilled(bb.Min, bb.Max, text_selected_bg_color, has_border ? style.FrameRounding : 0.f);
+					if (has_border)
+						draw_list->AddRect(bb.Min, bb.Max, border_color, style.FrameRounding);
+				}
+				else
+				{
+					RenderHighlightRuns(draw_list, hex_grid, n, first, last, text_selected_bg_color, flags,
+						(flags & ImGuiHexEditorHighlightFlags_FullSized) != 0, style.FrameRounding, select_start_byte, select_end_byte);
+				}
+
+				if (flags & ImGuiHexEditorHighlightFlags_Ascii)
+				{
+					RenderHighlightRuns(draw_list, ascii_grid, n, first, last, text_selected_bg_color, flags,
+						false, style.FrameRounding, select_start_byte, select_end_byte);
+				}
+			}
+
+			for (int i = 0; i != bytes_per_line; i++)
+			{
+				if (!(row_mask[i] & ImGuiHexEditorCellMask_Highlighted))
+					continue;
+
+				// Equal borderless highlights of consecutive bytes are merged, bordered ones are drawn around every byte
+				const ImGuiHexEditorCellHighlight& highlight = row_highlights[i];
+				int last = i;
+				if (!(highlight.Flags & ImGuiHexEditorHighlightFlags_Border))
+				{
+					while (last + 1 != bytes_per_line && (row_mask[last + 1] & ImGuiHexEditorCellMask_Highlighted)
+						&& row_highlights[last + 1].Flags == highlight.Flags && (ImU32)row_highlights[last + 1].Color == (ImU32)highlight.Color)
+						last++;
+				}
+
+				const bool full_sized = (highlight.Flags & ImGuiHexEditorHighlightFlags_FullSized) != 0;
+				const bool ascii = (highlight.Flags & ImGuiHexEditorHighlightFlags_Ascii) != 0;
+
+				RenderHighlightRuns(draw_list, hex_grid, n, i, last, highlight.Color, highlight.Flags, full_sized, style.FrameRounding, line_base + i, line_base + last);
+				if (ascii)
+					RenderHighlightRuns(draw_list, ascii_grid, n, i, last, highlight.Color, highlight.Flags, false, style.FrameRounding, line_base + i, line_base + last);
+
+				if (highlight.Flags & ImGuiHexEditorHighlightFlags_Border)
+				{
+					RenderHighlightOutline(draw_list, hex_grid, n, n, highlight.BorderColor, full_sized, style.FrameRounding, line_base + i, line_base + i);
+					if (ascii)
+						RenderHighlightOutline(draw_list, ascii_grid, n, n, highlight.BorderColor, false, style.FrameRounding, line_base + i, line_base + i);
+				}
+
+				i = last;
+			}
+
+			// Template fields go under the highlight ranges
+			for (int j = 0; j != row_fields.Size; j++)
+			{
+				const ImGuiHexEditorTemplateLeaf& leaf = tpl->Leaves[row_fields[j]];
+				const ImGuiHexEditorHighlightFlags flags = state->TemplateHighlightFlags;
+				const ImS64 leaf_last = leaf.Offset + leaf.Size - 1;
+				const int first = (int)(ImMax(leaf.Offset, line_base) - line_base);
+				const int last = (int)(ImMin(leaf_last, line_base + bytes_per_line - 1) - line_base);
+				const unsigned char skip = ImGuiHexEditorCellMask_Selected | ImGuiHexEditorCellMask_Highlighted;
+
+				RenderHighlightRuns(draw_list, hex_grid, n, first, last, leaf.Color, flags, (flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, leaf.Offset, leaf_last, row_mask.Data, skip);
+
+				if (flags & ImGuiHexEditorHighlightFlags_Ascii)
+				{
+					RenderHighlightRuns(draw_list, ascii_grid, n, first, last, leaf.Color, flags, false,
+						style.FrameRounding, leaf.Offset, leaf_last, row_mask.Data, skip);
+				}
+			}
+
+			for (int j = 0; j != row_ranges.Size; j++)
+			{
+				const ImGuiHexEditorHighlightRange& range = step_ranges[row_ranges[j]];
+				const int first = (int)(ImMax(range.From, line_base) - line_base);
+				const int last = (int)(ImMin(range.To, line_base + bytes_per_line - 1) - line_base);
+				const unsigned char skip = ImGuiHexEditorCellMask_Selected | ImGuiHexEditorCellMask_Highlighted;
+
+				RenderHighlightRuns(draw_list, hex_grid, n, first, last, range.Color, range.Flags, (range.Flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, range.From, range.To, row_mask.Data, skip);
+
+				if (range.Flags & ImGuiHexEditorHighlightFlags_Ascii)
+				{
+					RenderHighlightRuns(draw_list, ascii_grid, n, first, last, range.Color, range.Flags, false,
+						style.FrameRounding, range.From, range.To, row_mask.Data, skip);
+				}
+			}
+
+			for (int j = 0; j < row_matches.Size; j += 2)
+			{
+				const ImGuiHexEditorHighlightFlags flags = state->SearchHighlightFlags;
+				const int first = (int)(ImMax(row_matches[j], line_base) - line_base);
+				const int last = (int)(ImMin(row_matches[j + 1], line_base + bytes_per_line - 1) - line_base);
+
+				RenderHighlightRuns(draw_list, hex_grid, n, first, last, search_color, flags, (flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, row_matches[j], row_matches[j + 1], row_mask.Data, ImGuiHexEditorCellMask_Selected);
+
+				if (flags & ImGuiHexEditorHighlightFlags_Ascii)
+				{
+					RenderHighlightRuns(draw_list, ascii_grid, n, first, last, search_color, flags, false,
+						style.FrameRounding, row_matches[j], row_matches[j + 1], row_mask.Data, ImGuiHexEditorCellMask_Selected);
+				}
+			}
+
+			for (int j = 0; j < row_diffs.Size; j += 2)
+			{
+				const ImGuiHexEditorHighlightFlags flags = state->DiffHighlightFlags;
+				const int first = (int)(ImMax(row_diffs[j], line_base) - line_base);
+				const int last = (int)(ImMin(row_diffs[j + 1], line_base + bytes_per_line - 1) - line_base);
+
+				RenderHighlightRuns(draw_list, hex_grid, n, first, last, diff_color, flags, (flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, row_diffs[j], row_diffs[j + 1], row_mask.Data, ImGuiHexEditorCellMask_Selected);
+
+				if (flags & ImGuiHexEditorHighlightFlags_Ascii)
+				{
+					RenderHighlightRuns(draw_list, ascii_grid, n, first, last, diff_color, flags, false,
+						style.FrameRounding, row_diffs[j], row_diffs[j + 1], row_mask.Data, ImGuiHexEditorCellMask_Selected);
+				}
+			}
+
+			// Text of the whole row at once, bytes which couldn't be read are shown as ??
+			char* row_cells = row_text.Data;
+			char* row_ascii = row_text.Data + row_cells_chars;
+			const int row_read = ImClamp(bytes_read, 0, bytes_per_line);
+			FormatCellRow(cell_format, big_endian_cells, lowercase_bytes, cell_table, line_bytes, row_read, bytes_per_line, row_cells, show_ascii ? row_ascii : nullptr);
+
+			for (int i = 0; i != bytes_per_line; i++)
+			{
+				const ImRect cell_bb = { { row_x + byte_offsets_x[i], cursor.y }, { row_x + byte_offsets_x[i] + cell_size.x, cursor.y + cell_size.y } };
+				const int byte_in_cell = i % cell_bytes;
+				const char* cell_text = row_cells + (i / cell_bytes) * cell_info.Chars;
+
+				const ImS64 offset = line_base + i;
+				const unsigned char byte = i < bytes_read ? line_bytes[i] : 0x00;
+
+				ImVec2 byte_ascii = ascii_cursor;
+
+				byte_ascii.x += (char_size.x * i) + spacing.x;
+				byte_ascii.y += (char_size.y + spacing.y) * (clipper_n - clipper.DisplayStart);
+
+				ImColor byte_text_color = row_highlights[i].TextColor;
+
+				if (row_mask[i] == 0)
+				{
+					IMGUI_HEX_EDITOR_STAT(HighlightRangeTests += row_ranges.Size);
+					for (int j = 0; j != row_ranges.Size; j++)
+					{
+						const ImGuiHexEditorHighlightRange& range = step_ranges[row_ranges[j]];
+
+						if (offset >= range.From && offset <= range.To && (range.Flags & ImGuiHexEditorHighlightFlags_TextAutomaticContrast))
+							byte_text_color = CalcContrastColor(range.Color);
+					}
+				}
+
+				// Digits of every byte in their own color, numbers spanning the whole cell in the color of its first byte
+				if (cell_info.ByteChars != 0)
+				{
+					const int slot_chars = GetCellSlot(byte_in_cell, cell_bytes, big_endian_cells) * cell_info.ByteChars;
+					PushGlyphs(step_glyphs, glyph_table, { cell_bb.Min.x + char_size.x * slot_chars, cell_bb.Min.y }, cell_text + slot_chars, cell_info.ByteChars, byte_text_color);
+				}
+				else if (byte_in_cell == 0)
+					PushGlyphs(step_glyphs, glyph_table, cell_bb.Min, cell_text, cell_info.Chars, byte_text_color);
+
+				if (offset == select_start_byte)
+				{
+					state->SelectCursorAnimationTime += io.DeltaTime;
+
+					if (!io.ConfigInputTextCursorBlink || ImFmod(state->SelectCursorAnimationTime, 1.20f) <= 0.80f)
+					{
+						float digit_width;
+						ImVec2 pos;
+						pos.x = cell_bb.Min.x + GetCellDigitX(cell_info, big_endian_cells, byte_in_cell, select_start_subbyte, char_size.x, &digit_width);
+						pos.y = cell_bb.Max.y;
+
+						draw_list->AddLine({ pos.x, pos.y }, { pos.x + digit_width, pos.y }, text_color);
+					}
+				}
+
+				if (offset == hovered_offset)
+				{
+					if (grid_clicked)
+					{
+						next_select_start_byte = offset;
+						next_select_end_byte = offset;
+						next_select_drag_byte = offset;
+						next_select_drag_subbyte = hovered_digit;
+						next_select_start_subbyte = next_select_drag_subbyte;
+						next_last_selected_byte = offset;
+
+						ImGui::SetFocusID(grid_id, window);
+					}
+					else if (mouse_left_down && select_drag_byte != -1)
+					{
+						if (offset >= select_drag_byte)
+						{
+							next_select_end_byte = offset;
+						}
+						else
+						{
+							next_select_start_byte = offset;
+							next_select_end_byte = select_drag_byte;
+							next_select_start_subbyte = 0;
+						}	
+
+						ImGui::SetFocusID(grid_id, window);
+					}
+				}
+
+				if (offset == last_selected_byte && !read_only && hex_key_pressed != ImGuiKey_None)
+				{
+					IM_ASSERT(offset == select_start_byte || offset == select_end_byte);
+					const int subbyte = offset == select_start_byte ? select_start_subbyte : select_end_subbyte;
+
+					// Keys which aren't digits of the format are ignored
+					unsigned char wbyte;
+					if (WriteCellDigit(cell_info, byte, subbyte, hex_key_pressed, &wbyte))
+					{
+						WriteBytes(state, offset, &wbyte, sizeof(wbyte));
+
+						int* next_subbyte = (int*)(offset == select_start_byte ? &next_select_start_subbyte : &next_select_end_subbyte);
+						if (subbyte != cell_digits - 1)
+						{
+							next_select_start_byte = offset;
+							next_select_end_byte = offset;
+							*next_subbyte = subbyte + 1;
+						}
+						else
+						{
+							const ImS64 next_byte = StepVisualByte(offset, 1, cell_bytes, big_endian_cells, state->MaxBytes);
+							if (next_byte != -1)
+							{
+								next_last_selected_byte = next_byte;
+								*next_subbyte = 0;
+							}
+							else
+								next_last_selected_byte = offset;
+
+							next_select_start_byte = next_last_selected_byte;
+							next_select_end_byte = next_last_selected_byte;
+						}
+
+						state->SelectCursorAnimationTime = 0.f;
+					}
+				}
+
+				if (show_ascii)
+					PushGlyphs(step_glyphs, glyph_table, byte_ascii, row_ascii + i, 1, byte_text_color);
+			}
+
+			if (cache_entry)
+			{
+				cache_entry->LineBase = line_base;
+				cache_entry->BytesPerLine = bytes_per_line;
+				cache_entry->LayoutHash = row_cache_layout_hash;
+				cache_entry->ContentHash = row_hash;
+				StoreRowCacheEntry(cache_entry, draw_list, row_vtx_start, row_idx_start, row_vtx_index_start, step_glyphs, row_glyph_start, row_origin);
+			}
+
+			if (bytes_per_line > 0)
+				cursor.x = row_x + byte_offsets_x[bytes_per_line - 1] + cell_size.x + spacing.x;
+
+			ImGui::SetCursorScreenPos(cursor);
+
+			IMGUI_HEX_EDITOR_STAT(DecorationTime += (float)(GetStatsTime() - decoration_start));
+
+			ImGui::NewLine();
+			cursor = ImGui::GetCursorScreenPos();
+		}
+
+		IMGUI_HEX_EDITOR_STAT_TIME(outlines_start);
+
+		// Outlines of the whole visible part of every bordered highlight go over the row decorations and under the text
+		const ImS64 step_from = step_first_line * bytes_per_line;
+		const ImS64 step_to = (step_last_line + 1) * bytes_per_line - 1;
+
+		const ImGuiHexEditorHighlightFlags selection_flags = state->SelectionHighlightFlags;
+		if ((selection_flags & ImGuiHexEditorHighlightFlags_Border) && select_start_byte >= 0 && select_start_byte <= step_to && select_end_byte >= step_from)
+		{
+			// The border of a single selected byte was drawn with its fill
+			if (select_start_byte != select_end_byte)
+			{
+				RenderHighlightOutline(draw_list, hex_grid, step_first_line, step_last_line, border_color, (selection_flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, select_start_byte, select_end_byte);
+			}
+
+			if (selection_flags & ImGuiHexEditorHighlightFlags_Ascii)
+				RenderHighlightOutline(draw_list, ascii_grid, step_first_line, step_last_line, border_color, false, style.FrameRounding, select_start_byte, select_end_byte);
+		}
+
+		const ImGuiHexEditorHighlightFlags template_flags = state->TemplateHighlightFlags;
+		if (tpl && (template_flags & ImGuiHexEditorHighlightFlags_Border))
+		{
+			row_fields.resize(0);
+			QueryTemplateLeaves(tpl, step_from, step_to, row_fields);
+
+			for (int j = 0; j != row_fields.Size; j++)
+			{
+				const ImGuiHexEditorTemplateLeaf& leaf = tpl->Leaves[row_fields[j]];
+				RenderHighlightOutline(draw_list, hex_grid, step_first_line, step_last_line, border_color, (template_flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, leaf.Offset, leaf.Offset + leaf.Size - 1);
+
+				if (template_flags & ImGuiHexEditorHighlightFlags_Ascii)
+					RenderHighlightOutline(draw_list, ascii_grid, step_first_line, step_last_line, border_color, false, style.FrameRounding, leaf.Offset, leaf.Offset + leaf.Size - 1);
+			}
+		}
+
+		for (const ImGuiHexEditorHighlightRange& range : step_ranges)
+		{
+			if (!(range.Flags & ImGuiHexEditorHighlightFlags_Border) || range.From > range.To || range.To < step_from || range.From > step_to)
+				continue;
+
+			const ImColor range_border_color = CalcHighlightBorderColor(range.Flags, range.Color, range.BorderColor, border_color);
+			RenderHighlightOutline(draw_list, hex_grid, step_first_line, step_last_line, range_border_color, (range.Flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+				style.FrameRounding, range.From, range.To);
+
+			if (range.Flags & ImGuiHexEditorHighlightFlags_Ascii)
+				RenderHighlightOutline(draw_list, ascii_grid, step_first_line, step_last_line, range_border_color, false, style.FrameRounding, range.From, range.To);
+		}
+
+		const ImGuiHexEditorHighlightFlags search_flags = state->SearchHighlightFlags;
+		if (search_flags & ImGuiHexEditorHighlightFlags_Border)
+		{
+			row_matches.resize(0);
+			QuerySearchResults(state, step_from, step_to, row_matches);
+
+			for (int j = 0; j < row_matches.Size; j += 2)
+			{
+				RenderHighlightOutline(draw_list, hex_grid, step_first_line, step_last_line, border_color, (search_flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, row_matches[j], row_matches[j + 1]);
+
+				if (search_flags & ImGuiHexEditorHighlightFlags_Ascii)
+					RenderHighlightOutline(draw_list, ascii_grid, step_first_line, step_last_line, border_color, false, style.FrameRounding, row_matches[j], row_matches[j + 1]);
+			}
+		}
+
+		const ImGuiHexEditorHighlightFlags diff_flags = state->DiffHighlightFlags;
+		if (diff && (diff_flags & ImGuiHexEditorHighlightFlags_Border))
+		{
+			row_diffs.resize(0);
+			QueryDiffHunks(diff, diff_side, step_from, step_to, row_diffs);
+
+			for (int j = 0; j < row_diffs.Size; j += 2)
+			{
+				RenderHighlightOutline(draw_list, hex_grid, step_first_line, step_last_line, border_color, (diff_flags & ImGuiHexEditorHighlightFlags_FullSized) != 0,
+					style.FrameRounding, row_diffs[j], row_diffs[j + 1]);
+
+				if (diff_flags & ImGuiHexEditorHighlightFlags_Ascii)
+					RenderHighlightOutline(draw_list, ascii_grid, step_first_line, step_last_line, border_color, false, style.FrameRounding, row_diffs[j], row_diffs[j + 1]);
+			}
+		}
+
+		IMGUI_HEX_EDITOR_STAT_TIME(glyphs_start);
+		IMGUI_HEX_EDITOR_STAT(DecorationTime += (float)(glyphs_start - outlines_start));
+
+		RenderGlyphs(draw_list, step_glyphs, glyph_table.Scale);
+		step_glyphs.resize(0);
+
+		IMGUI_HEX_EDITOR_STAT(TextTime += (float)(GetStatsTime() - glyphs_start));
+	}
+
+	state->DisplayStartByte = visible_from;
+	state->DisplayEndByte = visible_from + ImMax(visible_size, (ImS64)0);
+
+	if (watch)
+	{
+		std::lock_guard<std::mutex> lock(watch->Mutex);
+		SetWatchRange(watch, 0, visible_from, visible_size);
+	}
+
+	if (scroll_lines_count < lines_count)
+	{
+		// Slide the scroll window by half of its size once the scroll position gets close to one of its edges,
+		// compensating the scroll position so the visible lines stay in place
+		const float line_height = cell_size.y + spacing.y;
+		const float scroll_y = ImGui::GetScrollY();
+		const float edge_y = (scroll_lines_count / 4) * line_height;
+		const ImS64 half_lines = scroll_lines_count / 2;
+
+		ImS64 shift = 0;
+		if (scroll_y < edge_y && scroll_base_line > 0)
+			shift = -ImMin(half_lines, scroll_base_line);
+		else if (scroll_y > ImGui::GetScrollMaxY() - edge_y && scroll_base_line + scroll_lines_count < lines_count)
+			shift = ImMin(half_lines, lines_count - scroll_lines_count - scroll_base_line);
+
+		if (shift != 0)
+		{
+			scroll_base_line += shift;
+			ImGui::SetScrollY(scroll_y - shift * line_height);
+		}
+	}
+
+	state->ScrollBaseLine = scroll_base_line;
+
+	// Keep the cursor visible and the grid focused while navigating with the keyboard
+	const bool cursor_moved = next_last_selected_byte != last_selected_byte && next_last_selected_byte >= 0;
+	if (cursor_moved)
+		scroll_to_byte = next_last_selected_byte;
+
+	if (scroll_to_byte >= 0 && bytes_per_line > 0)
+	{
+		const ImS64 cursor_line = scroll_to_byte / bytes_per_line - scroll_base_line;
+		if (cursor_line >= 0 && cursor_line < scroll_lines_count)
+		{
+			const float line_y = clipper_start_y + cursor_line * line_height;
+			if (line_y < window->InnerClipRect.Min.y)
+				ImGui::SetScrollFromPosY(window, line_y - window->Pos.y, 0.f);
+			else if (line_y + line_height > window->InnerClipRect.Max.y)
+				ImGui::SetScrollFromPosY(window, line_y + line_height - window->Pos.y, 1.f);
+		}
+	}
+
+	if (cursor_moved)
+		ImGui::SetFocusID(grid_id, window);
+
+	state->SelectStartByte = next_select_start_byte;
+	state->SelectStartSubByte = next_select_start_subbyte;
+	state->SelectEndByte = next_select_end_byte;
+	state->SelectEndSubByte = next_select_end_subbyte;	
+	state->LastSelectedByte = next_last_selected_byte;
+	state->SelectDragByte = next_select_drag_byte;
+	state->SelectDragSubByte = next_select_drag_subbyte;
+
+	if (line_buf != stack_line_buf)
+		ImGui::MemFree(line_buf);
+
+	if (address_buf != stack_address_buf)
+		ImGui::MemFree(address_buf);
+
+	IMGUI_HEX_EDITOR_STAT(Vertices = draw_list->VtxBuffer.Size - draw_list_vtx_start);
+	IMGUI_HEX_EDITOR_STAT(Indices = draw_list->IdxBuffer.Size - draw_list_idx_start);
+	IMGUI_HEX_EDITOR_STAT(TotalTime = (float)(GetStatsTime() - frame_start));
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	GHexEditorStats = nullptr;
+#endif
+	
+	return true;
+}
+
+void ImGui::EndHexEditor()
+{
+	ImGui::EndChild();
+}
+
+bool ImGui::CalcHexEditorRowRange(ImS64 row_offset, int row_bytes_count, ImS64 range_min, ImS64 range_max, int* out_min, int* out_max)
+{
+	ImS64 abs_min;
+	ImS64 abs_max;
+
+	if (RangeRangeIntersection(row_offset, row_offset + row_bytes_count, range_min, range_max, &abs_min, &abs_max))
+	{
+		*out_min = (int)(abs_min - row_offset);
+		*out_max = (int)(abs_max - row_offset);
+		return true;
+	}
+
+	return false;
+}
+
+void ImGui::ShowHexEditorStatsWindow(ImGuiHexEditorState* state, bool* p_open)
+{
+	if (!ImGui::Begin("Hex Editor Stats", p_open, ImGuiWindowFlags_AlwaysAutoResize))
+	{
+		ImGui::End();
+		return;
+	}
+
+#ifdef IMGUI_HEX_EDITOR_ENABLE_STATS
+	const ImGuiHexEditorStats& stats = state->Stats;
+	ImGui::Text("Total: %.3f ms", stats.TotalTime);
+	ImGui::Text("Input: %.3f ms", stats.InputTime);
+	ImGui::Text("Read: %.3f ms", stats.ReadTime);
+	ImGui::Text("Decoration: %.3f ms", stats.DecorationTime);
+	ImGui::Text("Text: %.3f ms", stats.TextTime);
+	ImGui::Separator();
+	ImGui::Text("Rows: %d (%d cached), bytes: %lld", stats.Rows, stats.CachedRows, (long long)stats.Bytes);
+	ImGui::Text("Source reads: %d, %lld bytes, %.3f ms", stats.SourceReads, (long long)stats.SourceReadBytes, stats.SourceReadTime);
+	ImGui::Text("Highlight range tests: %d", stats.HighlightRangeTests);
+	ImGui::Text("SingleHighlightCallback calls: %d", stats.SingleHighlightCalls);
+	ImGui::Text("HighlightRangesCallback calls: %d", stats.HighlightRangesCalls);
+	ImGui::Text("Vertices: %d, indices: %d", stats.Vertices, stats.Indices);
+#else
+	IM_UNUSED(state);
+	ImGui::TextUnformatted("Define IMGUI_HEX_EDITOR_ENABLE_STATS to record stats");
+#endif
+
+	ImGui::End();
+}
+ImGuiHexEditorPageCache* ImGui::CreateHexEditorPageCache(const ImGuiHexEditorPageCacheConfig& config)
+{
+	IM_ASSERT(config.ReadCallback);
+	IM_ASSERT(config.PageSize > 0 && (config.PageSize & (config.PageSize - 1)) == 0);
+
+	ImGuiHexEditorPageCache* cache = IM_NEW(ImGuiHexEditorPageCache)();
+	cache->Config = config;
+
+	cache->PageShift = 0;
+	while ((1 << cache->PageShift) < config.PageSize)
+		++cache->PageShift;
+
+	const int pages_count = (int)ImMax((ImS64)2, config.BudgetBytes / config.PageSize);
+	cache->Pages.resize(pages_count);
+	memset(cache->Pages.Data, 0, (size_t)cache->Pages.size_in_bytes());
+	for (ImGuiHexEditorPage& page : cache->Pages)
+		page.Index = -1;
+
+	cache->Lookup.reserve(pages_count);
+	cache->Queue.reserve(pages_count);
+
+	cache->MaxReadPages = (int)ImClamp(config.MaxReadSize / config.PageSize, (ImS64)1, (ImS64)pages_count);
+	cache->ReadPages.reserve(cache->MaxReadPages);
+	if (cache->MaxReadPages > 1)
+		cache->ReadBuffer = (unsigned char*)IM_ALLOC((size_t)cache->MaxReadPages * config.PageSize);
+
+	cache->Thread = std::thread(PageCacheThread, cache);
+	return cache;
+}
+
+void ImGui::DestroyHexEditorPageCache(ImGuiHexEditorPageCache* cache)
+{
+	if (!cache || --cache->RefCount > 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(cache->Mutex);
+		cache->Quit = true;
+	}
+
+	cache->Cond.notify_one();
+	cache->Thread.join();
+
+	for (ImGuiHexEditorPage& page : cache->Pages)
+		IM_FREE(page.Data);
+
+	if (cache->ReadBuffer)
+		IM_FREE(cache->ReadBuffer);
+
+	IM_DELETE(cache);
+}
+
+ImGuiHexEditorPageCache* ImGui::AddHexEditorPageCacheRef(ImGuiHexEditorPageCache* cache)
+{
+	IM_ASSERT(cache->RefCount > 0);
+	cache->RefCount++;
+	return cache;
+}
+
+void ImGui::SetHexEditorPageCache(ImGuiHexEditorState* state, ImGuiHexEditorPageCache* cache)
+{
+	if (cache)
+		AddHexEditorPageCacheRef(cache);
+
+	DestroyHexEditorPageCache(state->PageCache);
+	state->PageCache = cache;
+}
+
+void ImGui::InvalidateHexEditorPageCache(ImGuiHexEditorPageCache* cache, ImS64 offset, ImS64 size)
+{
+	std::lock_guard<std::mutex> lock(cache->Mutex);
+
+	for (ImGuiHexEditorPage& page : cache->Pages)
+	{
+		if (page.State == ImGuiHexEditorPageState_Free)
+			continue;
+
+		const ImS64 page_from = page.Index << cache->PageShift;
+		const ImS64 page_to = page_from + cache->Config.PageSize;
+		if (size != -1 && (page_to <= offset || page_from >= offset + size))
+			continue;
+
+		if (page.State == ImGuiHexEditorPageState_Loading)
+			page.Stale = true;
+		else
+			FreePage(cache, &page);
+	}
+}
+
+ImGuiHexEditorRowCache* ImGui::CreateHexEditorRowCache(int max_rows)
+{
+	int entries_count = 1;
+	while (entries_count < max_rows)
+		entries_count <<= 1;
+
+	ImGuiHexEditorRowCache* cache = IM_NEW(ImGuiHexEditorRowCache);
+	cache->Entries.resize(entries_count);
+	for (ImGuiHexEditorRowCacheEntry*& entry : cache->Entries)
+		entry = IM_NEW(ImGuiHexEditorRowCacheEntry);
+
+	return cache;
+}
+
+void ImGui::DestroyHexEditorRowCache(ImGuiHexEditorRowCache* cache)
+{
+	if (!cache)
+		return;
+
+	for (ImGuiHexEditorRowCacheEntry* entry : cache->Entries)
+		IM_DELETE(entry);
+
+	IM_DELETE(cache);
+}
+
+void ImGui::InvalidateHexEditorRowCache(ImGuiHexEditorRowCache* cache, ImS64 offset, ImS64 size)
+{
+	for (ImGuiHexEditorRowCacheEntry* entry : cache->Entries)
+	{
+		if (entry->LineBase == -1)
+			continue;
+
+		if (size != -1 && (entry->LineBase + entry->BytesPerLine <= offset || entry->LineBase >= offset + size))
+			continue;
+
+		entry->LineBase = -1;
+	}
+}
+
+ImGuiHexEditorFile* ImGui::OpenHexEditorFile(const char* filename, ImGuiHexEditorFileFlags flags, ImS64 window_size)
+{
+	// Views have to start on the allocation granularity, which is at most 64 KiB on every supported platform
+	const ImS64 granularity = 64 * 1024;
+	window_size = ImMax(granularity, (window_size + granularity - 1) & ~(granularity - 1));
+
+	ImGuiHexEditorFile* file = IM_NEW(ImGuiHexEditorFile)();
+	file->Flags = flags;
+	file->WindowSize = window_size;
+	file->Views.reserve(file->MaxViews + 1); // Views are also mapped from the search thread, which shouldn't allocate
+
+#ifdef _WIN32
+	const int wfilename_size = MultiByteToWideChar(CP_UTF8, 0, filename, -1, nullptr, 0);
+	ImVector<wchar_t> wfilename;
+	wfilename.resize(wfilename_size);
+	MultiByteToWideChar(CP_UTF8, 0, filename, -1, wfilename.Data, wfilename_size);
+
+	file->Handle = CreateFileW(wfilename.Data, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER file_size;
+	if (file->Handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(file->Handle, &file_size))
+	{
+		CloseHexEditorFile(file);
+		return nullptr;
+	}
+
+	file->Size = (ImS64)file_size.QuadPart;
+	if (file->Size > 0)
+	{
+		file->Mapping = CreateFileMappingW(file->Handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (!file->Mapping)
+		{
+			CloseHexEditorFile(file);
+			return nullptr;
+		}
+	}
+#else
+	file->Fd = open(filename, O_RDONLY);
+	struct stat st;
+	if (file->Fd == -1 || fstat(file->Fd, &st) != 0)
+	{
+		CloseHexEditorFile(file);
+		return nullptr;
+	}
+
+	file->Size = (ImS64)st.st_size;
+#endif
+
+	return file;
+}
+
+void ImGui::CloseHexEditorFile(ImGuiHexEditorFile* file)
+{
+	if (!file)
+		return;
+
+	for (ImGuiHexEditorFileView& view : file->Views)
+		UnmapFileView(&view);
+
+#ifdef _WIN32
+	if (file->Mapping)
+		CloseHandle(file->Mapping);
+
+	if (file->Handle != INVALID_HANDLE_VALUE)
+		CloseHandle(file->Handle);
+#else
+	if (file->Fd != -1)
+		close(file->Fd);
+#endif
+
+	IM_DELETE(file);
+}
+
+ImS64 ImGui::GetHexEditorFileSize(ImGuiHexEditorFile* file)
+{
+	return file->Size;
+}
+
+ImGuiHexEditorEditBuffer* ImGui::CreateHexEditorEditBuffer(ImS64 original_size)
+{
+	ImGuiHexEditorEditBuffer* buffer = IM_NEW(ImGuiHexEditorEditBuffer)();
+	ResetEditBuffer(buffer, original_size);
+	return buffer;
+}
+
+void ImGui::DestroyHexEditorEditBuffer(ImGuiHexEditorEditBuffer* buffer)
+{
+	if (!buffer)
+		return;
+
+	for (unsigned char* block : buffer->AddBlocks)
+		IM_FREE(block);
+
+	IM_DELETE(buffer);
+}
+
+ImS64 ImGui::GetHexEditorEditBufferSize(ImGuiHexEditorEditBuffer* buffer)
+{
+	return GetPieceTreeLength(buffer, buffer->Root);
+}
+
+void ImGui::InsertHexEditorBytes(ImGuiHexEditorEditBuffer* buffer, ImS64 offset, const void* data, ImS64 size)
+{
+	std::lock_guard<std::mutex> lock(buffer->Mutex);
+	IM_ASSERT(offset >= 0 && offset <= GetPieceTreeLength(buffer, buffer->Root));
+	if (size <= 0)
+		return;
+
+	int left, right;
+	SplitPieces(buffer, buffer->Root, offset, &left, &right);
+	buffer->Root = MergePieces(buffer, MergePieces(buffer, left, AddPieceData(buffer, data, size)), right);
+	PushEditHistory(buffer);
+}
+
+void ImGui::DeleteHexEditorBytes(ImGuiHexEditorEditBuffer* buffer, ImS64 offset, ImS64 size)
+{
+	std::lock_guard<std::mutex> lock(buffer->Mutex);
+	const ImS64 length = GetPieceTreeLength(buffer, buffer->Root);
+	IM_ASSERT(offset >= 0 && offset <= length);
+
+	size = ImMin(size, length - offset);
+	if (size <= 0)
+		return;
+
+	int left, middle, right;
+	SplitPieces(buffer, buffer->Root, offset, &left, &right);
+	SplitPieces(buffer, right, size, &middle, &right);
+	buffer->Root = MergePieces(buffer, left, right);
+	PushEditHistory(buffer);
+}
+
+void ImGui::OverwriteHexEditorBytes(ImGuiHexEditorEditBuffer* buffer, ImS64 offset, const void* data, ImS64 size)
+{
+	std::lock_guard<std::mutex> lock(buffer->Mutex);
+	const ImS64 length = GetPieceTreeLength(buffer, buffer->Root);
+	IM_ASSERT(offset >= 0 && offset <= length);
+
+	size = ImMin(size, length - offset);
+	if (size <= 0)
+		return;
+
+	int left, middle, right;
+	SplitPieces(buffer, buffer->Root, offset, &left, &right);
+	SplitPieces(buffer, right, size, &middle, &right);
+	buffer->Root = MergePieces(buffer, MergePieces(buffer, left, AddPieceData(buffer, data, size)), right);
+	PushEditHistory(buffer);
+}
+
+void ImGui::BeginHexEditorEditGroup(ImGuiHexEditorEditBuffer* buffer)
+{
+	buffer->GroupDepth++;
+}
+
+void ImGui::EndHexEditorEditGroup(ImGuiHexEditorEditBuffer* buffer)
+{
+	IM_ASSERT(buffer->GroupDepth > 0);
+	buffer->GroupDepth--;
+	PushEditHistory(buffer);
+}
+
+bool ImGui::UndoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer)
+{
+	IM_ASSERT(buffer->GroupDepth == 0);
+	if (buffer->HistoryIndex == 0)
+		return false;
+
+	buffer->Root = buffer->History[--buffer->HistoryIndex];
+	return true;
+}
+
+bool ImGui::RedoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer)
+{
+	IM_ASSERT(buffer->GroupDepth == 0);
+	if (buffer->HistoryIndex + 1 >= buffer->History.Size)
+		return false;
+
+	buffer->Root = buffer->History[++buffer->HistoryIndex];
+	return true;
+}
+
+bool ImGui::CanUndoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer)
+{
+	return buffer->HistoryIndex > 0;
+}
+
+bool ImGui::CanRedoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer)
+{
+	return buffer->HistoryIndex + 1 < buffer->History.Size;
+}
+
+struct ImGuiHexEditorCommitPiece
+{
+	ImS64 Pos;
+	ImS64 Start;
+	ImS64 Length;
+	int Block;
+	ImS64 Written; // Bytes of a moved piece already at their final position, at its end when it moved forward
+	int FailedChunk; // Copy of the chunk of a moved piece whose write failed and may have overwritten its source bytes
+};
+
+static void CollectCommitPieces(ImGuiHexEditorEditBuffer* buffer, int node, ImS64 base, ImVector<ImGuiHexEditorCommitPiece>& out)
+{
+	if (node == -1)
+		return;
+
+	const ImGuiHexEditorPiece piece = buffer->Nodes[node];
+	const ImS64 left_length = GetPieceTreeLength(buffer, piece.Left);
+	CollectCommitPieces(buffer, piece.Left, base, out);
+
+	ImGuiHexEditorCommitPiece commit_piece;
+	commit_piece.Pos = base + left_length;
+	commit_piece.Start = piece.Start;
+	commit_piece.Length = piece.Length;
+	commit_piece.Block = piece.Block;
+	commit_piece.Written = 0;
+	commit_piece.FailedChunk = -1;
+	out.push_back(commit_piece);
+
+	CollectCommitPieces(buffer, piece.Right, base + left_length + piece.Length, out);
+}
+
+static bool CommitMovedPiece(ImGuiHexEditorState* state, ImGuiHexEditorCommitPiece& piece, unsigned char* batch, ImS64 batch_size, bool backwards)
+{
+	while (piece.Written < piece.Length)
+	{
+		const ImS64 count = ImMin(batch_size, piece.Length - piece.Written);
+		const ImS64 chunk = backwards ? piece.Length - piece.Written - count : piece.Written;
+
+		if (ReadSourceBytes(state, piece.Start + chunk, batch, count) != count)
+			return false;
+
+		if (WriteSourceBytes(state, piece.Pos + chunk, batch, count) != count)
+		{
+			ImGuiHexEditorEditBuffer* buffer = state->EditBuffer;
+			std::lock_guard<std::mutex> lock(buffer->Mutex);
+			piece.FailedChunk = AddPieceData(buffer, batch, count);
+			return false;
+		}
+
+		piece.Written += count;
+	}
+
+	return true;
+}
+
+// Rebuilds the tree after a commit that failed partway so it still shows the same bytes: the written parts of moved
+// pieces are read from their final position and the chunk whose write failed from its copy. The rest is written by the
+// next commit, which moves the remaining pieces in the same order.
+static void RebuildCommitPieces(ImGuiHexEditorEditBuffer* buffer, const ImVector<ImGuiHexEditorCommitPiece>& pieces)
+{
+	int root = -1;
+	for (const ImGuiHexEditorCommitPiece& piece : pieces)
+	{
+		if (piece.Block != -1)
+		{
+			root = MergePieces(buffer, root, NewPiece(buffer, piece.Start, piece.Length, piece.Block, NextPiecePriority(buffer), -1, -1));
+			continue;
+		}
+
+		const bool backwards = piece.Pos > piece.Start;
+		const ImS64 failed = piece.FailedChunk != -1 ? buffer->Nodes[piece.FailedChunk].Length : 0;
+		const ImS64 unwritten = piece.Length - piece.Written - failed;
+		const ImS64 written_pos = backwards ? piece.Pos + piece.Length - piece.Written : piece.Pos;
+
+		const int unwritten_part = unwritten > 0 ? NewPiece(buffer, backwards ? piece.Start : piece.Start + piece.Length - unwritten, unwritten, -1, NextPiecePriority(buffer), -1, -1) : -1;
+		const int written_part = piece.Written > 0 ? NewPiece(buffer, written_pos, piece.Written, -1, NextPiecePriority(buffer), -1, -1) : -1;
+		const int first = backwards ? unwritten_part : written_part;
+		const int last = backwards ? written_part : unwritten_part;
+		root = MergePieces(buffer, MergePieces(buffer, MergePieces(buffer, root, first), piece.FailedChunk), last);
+
+		buffer->OriginalSize = ImMax(buffer->OriginalSize, written_pos + piece.Written);
+	}
+
+	// Older versions may read source bytes that were overwritten
+	buffer->Root = root;
+	buffer->History.resize(0);
+	buffer->History.push_back(root);
+	buffer->HistoryIndex = 0;
+}
+
+bool ImGui::CommitHexEditorEdits(ImGuiHexEditorState* state, ImS64 batch_size)
+{
+	ImGuiHexEditorEditBuffer* buffer = state->EditBuffer;
+	IM_ASSERT(buffer && buffer->GroupDepth == 0);
+
+	// Older writes still queued would land over the committed bytes
+	ImGui::FlushHexEditorWriteQueue(state, true);
+
+	const ImS64 length = GetPieceTreeLength(buffer, buffer->Root);
+
+	// Bytes and mapped files can't grow, callbacks receive the writes past the original end
+	if (length > buffer->OriginalSize && (state->File || !HasWriteCallback(state)))
+		return false;
+
+	unsigned char* batch = (unsigned char*)IM_ALLOC((size_t)batch_size);
+	if (!batch)
+		return false;
+
+	// The version of the buffer read by the search, statistics and minimap threads is about to be released
+	ImGui::CancelHexEditorSearch(state);
+	if (state->Statistics)
+		CancelJob(&state->Statistics->Job);
+	if (state->Minimap)
+		CancelJob(&state->Minimap->Job);
+
+	ImVector<ImGuiHexEditorCommitPiece> pieces;
+	CollectCommitPieces(buffer, buffer->Root, 0, pieces);
+
+	// Moved source pieces keep their relative order, so writing the ones moved forward from the last and the ones moved
+	// backward from the first never overwrites source bytes that are still to be moved. Added bytes come last.
+	bool ok = true;
+	for (int i = pieces.Size - 1; i >= 0 && ok; i--)
+	{
+		if (pieces[i].Block == -1 && pieces[i].Pos > pieces[i].Start)
+			ok = CommitMovedPiece(state, pieces[i], batch, batch_size, true);
+	}
+
+	for (int i = 0; i != pieces.Size && ok; i++)
+	{
+		if (pieces[i].Block == -1 && pieces[i].Pos < pieces[i].Start)
+			ok = CommitMovedPiece(state, pieces[i], batch, batch_size, false);
+	}
+	const bool moved_ok = ok;
+
+	// Adjacent added pieces, like bytes typed one after another, are coalesced into a single write
+	ImS64 batch_pos = 0;
+	ImS64 batch_used = 0;
+	for (int i = 0; i != pieces.Size && ok; i++)
+	{
+		const ImGuiHexEditorCommitPiece& piece = pieces[i];
+		if (piece.Block == -1)
+			continue;
+
+		for (ImS64 done = 0; done < piece.Length && ok;)
+		{
+			if (batch_used > 0 && (batch_pos + batch_used != piece.Pos + done || batch_used == batch_size))
+			{
+				ok = WriteSourceBytes(state, batch_pos, batch, batch_used) == batch_used;
+				batch_used = 0;
+			}
+
+			if (batch_used == 0)
+				batch_pos = piece.Pos + done;
+
+			const ImS64 count = ImMin(batch_size - batch_used, piece.Length - done);
+			memcpy(batch + batch_used, buffer->AddBlocks[piece.Block] + piece.Start + done, (size_t)count);
+			batch_used += count;
+			done += count;
+		}
+	}
+
+	if (ok && batch_used > 0)
+		ok = WriteSourceBytes(state, batch_pos, batch, batch_used) == batch_used;
+
+	IM_FREE(batch);
+
+	if (ok)
+	{
+		std::lock_guard<std::mutex> lock(buffer->Mutex);
+		ResetEditBuffer(buffer, length);
+	}
+	else
+	{
+		// Once anything was written the pieces no longer match the source, added pieces are only written after every move
+		bool written = moved_ok;
+		for (const ImGuiHexEditorCommitPiece& piece : pieces)
+			written |= piece.Written > 0 || piece.FailedChunk != -1;
+
+		if (written)
+		{
+			{
+				std::lock_guard<std::mutex> lock(buffer->Mutex);
+				RebuildCommitPieces(buffer, pieces);
+			}
+			InvalidateSourceViews(state, 0, -1);
+		}
+	}
+
+	// Node indices start over with the reset buffer, so the minimap can't tell the new version from its root
+	if (state->Minimap)
+		ResetMinimap(state, state->Minimap);
+
+	return ok;
+}
+
+static bool ParseSearchValue(ImGuiHexEditorSearchPattern* out_pattern, ImGuiHexEditorSearchType type, const char* text, ImGuiHexEditorSearchFlags flags)
+{
+	static const int sizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+	const int size = sizes[type - ImGuiHexEditorSearchType_S8];
+
+	char* end;
+	ImU64 bits;
+	switch (type)
+	{
+	case ImGuiHexEditorSearchType_Float:
+	{
+		const float value = (float)strtod(text, &end);
+		ImU32 value_bits;
+		memcpy(&value_bits, &value, sizeof(value_bits));
+		bits = value_bits;
+		break;
+	}
+	case ImGuiHexEditorSearchType_Double:
+	{
+		const double value = strtod(text, &end);
+		memcpy(&bits, &value, sizeof(bits));
+		break;
+	}
+	case ImGuiHexEditorSearchType_S8:
+	case ImGuiHexEditorSearchType_S16:
+	case ImGuiHexEditorSearchType_S32:
+	case ImGuiHexEditorSearchType_S64:
+	{
+		const long long value = strtoll(text, &end, 0);
+		const long long max = size == 8 ? LLONG_MAX : (1LL << (size * 8 - 1)) - 1;
+		if (value > max || value < -max - 1)
+			return false;
+
+		bits = (ImU64)value;
+		break;
+	}
+	default:
+	{
+		while (*text == ' ' || *text == '\t')
+			text++;
+
+		if (*text == '-')
+			return false;
+
+		bits = strtoull(text, &end, 0);
+		if (size != 8 && bits >> (size * 8))
+			return false;
+
+		break;
+	}
+	}
+
+	if (end == text)
+		return false;
+
+	while (*end == ' ' || *end == '\t')
+		end++;
+
+	if (*end)
+		return false;
+
+	const bool big_endian = flags & ImGuiHexEditorSearchFlags_BigEndian;
+	for (int i = 0; i != size; i++)
+	{
+		out_pattern->Bytes.push_back((unsigned char)(bits >> ((big_endian ? size - 1 - i : i) * 8)));
+		out_pattern->Mask.push_back(0xff);
+	}
+
+	return true;
+}
+
+bool ImGui::ParseHexEditorSearchPattern(ImGuiHexEditorSearchPattern* out_pattern, ImGuiHexEditorSearchType type, const char* text, ImGuiHexEditorSearchFlags flags)
+{
+	out_pattern->Bytes.resize(0);
+	out_pattern->Mask.resize(0);
+
+	switch (type)
+	{
+	case ImGuiHexEditorSearchType_Hex:
+	{
+		int nibbles = 0;
+		for (const char* c = text; *c; c++)
+		{
+			if (isspace((unsigned char)*c))
+				continue;
+
+			if (c[0] == '0' && (c[1] == 'x' || c[1] == 'X') && !(nibbles & 1))
+			{
+				c++;
+				continue;
+			}
+
+			unsigned char value, mask;
+			if (*c == '?')
+			{
+				value = 0;
+				mask = 0;
+			}
+			else if (isxdigit((unsigned char)*c))
+			{
+				value = (unsigned char)(isdigit((unsigned char)*c) ? *c - '0' : (tolower((unsigned char)*c) - 'a') + 10);
+				mask = 0xf;
+			}
+			else
+				return false;
+
+			if (!(nibbles & 1))
+			{
+				out_pattern->Bytes.push_back(value << 4);
+				out_pattern->Mask.push_back(mask << 4);
+			}
+			else
+			{
+				out_pattern->Bytes.back() |= value;
+				out_pattern->Mask.back() |= mask;
+			}
+
+			nibbles++;
+		}
+
+		if (nibbles & 1)
+			return false;
+
+		break;
+	}
+	case ImGuiHexEditorSearchType_Ascii:
+	{
+		for (const char* c = text; *c; c++)
+		{
+			out_pattern->Bytes.push_back((unsigned char)*c);
+			out_pattern->Mask.push_back(0xff);
+		}
+		break;
+	}
+	case ImGuiHexEditorSearchType_Utf16:
+	{
+		const bool big_endian = flags & ImGuiHexEditorSearchFlags_BigEndian;
+		const char* text_end = text + strlen(text);
+		while (text < text_end)
+		{
+			unsigned int c;
+			text += ImTextCharFromUtf8(&c, text, text_end);
+
+			ImU16 units[2];
+			int units_count = 1;
+			if (c >= 0x10000)
+			{
+				units[0] = (ImU16)(0xd800 + ((c - 0x10000) >> 10));
+				units[1] = (ImU16)(0xdc00 + ((c - 0x10000) & 0x3ff));
+				units_count = 2;
+			}
+			else
+				units[0] = (ImU16)c;
+
+			for (int i = 0; i != units_count; i++)
+			{
+				out_pattern->Bytes.push_back((unsigned char)(big_endian ? units[i] >> 8 : units[i] & 0xff));
+				out_pattern->Bytes.push_back((unsigned char)(big_endian ? units[i] & 0xff : units[i] >> 8));
+				out_pattern->Mask.push_back(0xff);
+				out_pattern->Mask.push_back(0xff);
+			}
+		}
+		break;
+	}
+	default:
+		IM_ASSERT(type >= ImGuiHexEditorSearchType_S8 && type <= ImGuiHexEditorSearchType_Double);
+		if (!ParseSearchValue(out_pattern, type, text, flags))
+			return false;
+		break;
+	}
+
+	return out_pattern->Bytes.Size > 0;
+}
+
+void ImGui::StartHexEditorSearch(ImGuiHexEditorState* state, const ImGuiHexEditorSearchPattern& pattern, ImS64 from, ImS64 to, int max_results)
+{
+	IM_ASSERT(pattern.Bytes.Size > 0 && pattern.Bytes.Size == pattern.Mask.Size);
+	ImGui::ClearHexEditorSearch(state);
+
+	ImGuiHexEditorSearch* search = IM_NEW(ImGuiHexEditorSearch)();
+	search->Pattern = pattern;
+	search->FirstAnchor = -1;
+	search->LastAnchor = -1;
+	for (int i = 0; i != pattern.Bytes.Size; i++)
+	{
+		search->Pattern.Bytes[i] &= pattern.Mask[i];
+		if (pattern.Mask[i] == 0xff)
+		{
+			if (search->FirstAnchor == -1)
+				search->FirstAnchor = i;
+
+			search->LastAnchor = i;
+		}
+	}
+
+	search->MaxResults = max_results;
+	search->MergedChunks = 0;
+	search->Found = 0;
+
+	InitJob(&search->Job, state, from, to, pattern.Bytes.Size - 1, ProcessSearchChunk, search);
+
+	const int chunks_count = ImMax(search->Job.ChunksCount, 1);
+	search->ChunkMatches = (ImGuiHexEditorThreadVector<ImS64>*)IM_ALLOC(sizeof(ImGuiHexEditorThreadVector<ImS64>) * (size_t)chunks_count);
+	search->ChunkDone = (bool*)IM_ALLOC(sizeof(bool) * (size_t)chunks_count);
+	for (int i = 0; i != chunks_count; i++)
+		IM_PLACEMENT_NEW(&search->ChunkMatches[i]) ImGuiHexEditorThreadVector<ImS64>();
+	memset(search->ChunkDone, 0, sizeof(bool) * (size_t)chunks_count);
+
+	state->Search = search;
+	StartJob(&search->Job);
+}
+
+void ImGui::CancelHexEditorSearch(ImGuiHexEditorState* state)
+{
+	if (!state->Search)
+		return;
+
+	CancelJob(&state->Search->Job);
+	UpdateHexEditorSearch(state);
+}
+
+void ImGui::ClearHexEditorSearch(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorSearch* search = state->Search;
+	if (!search)
+		return;
+
+	DestroyJob(&search->Job);
+	for (int i = 0; i != search->Job.ChunksCount; i++)
+		search->ChunkMatches[i].clear();
+
+	search->Pending.clear();
+	IM_FREE(search->ChunkMatches);
+	IM_FREE(search->ChunkDone);
+	IM_DELETE(search);
+
+	state->Search = nullptr;
+	state->SearchResults.clear();
+}
+
+bool ImGui::IsHexEditorSearchRunning(ImGuiHexEditorState* state)
+{
+	// Checked before collecting the results so the last ones are never left behind
+	const bool running = state->Search && state->Search->Job.WorkersRunning > 0;
+	UpdateHexEditorSearch(state);
+	return running;
+}
+
+float ImGui::GetHexEditorSearchProgress(ImGuiHexEditorState* state)
+{
+	return state->Search ? GetJobProgress(&state->Search->Job) : 0.f;
+}
+
+bool ImGui::SelectNextHexEditorSearchResult(ImGuiHexEditorState* state, bool backwards)
+{
+	UpdateHexEditorSearch(state);
+
+	const ImVector<ImS64>& results = state->SearchResults;
+	if (!state->Search || results.empty())
+		return false;
+
+	int index;
+	if (backwards)
+	{
+		index = FindFirstSearchResult(results, state->LastSelectedByte) - 1;
+		if (index < 0)
+			index = results.Size - 1;
+	}
+	else
+	{
+		index = FindFirstSearchResult(results, state->LastSelectedByte + 1);
+		if (index == results.Size)
+			index = 0;
+	}
+
+	const ImS64 offset = results[index];
+	state->SelectStartByte = offset;
+	state->SelectStartSubByte = 0;
+	state->SelectEndByte = offset + state->Search->Pattern.Bytes.Size - 1;
+	state->SelectEndSubByte = 0;
+	state->LastSelectedByte = offset;
+	state->ScrollToByte = offset;
+	return true;
+}
+
+void ImGui::StartHexEditorStatistics(ImGuiHexEditorState* state, ImS64 from, ImS64 to)
+{
+	ImGui::ClearHexEditorStatistics(state);
+
+	ImGuiHexEditorStatistics* statistics = IM_NEW(ImGuiHexEditorStatistics)();
+	memset(statistics->Histogram, 0, sizeof(statistics->Histogram));
+
+	state->Statistics = statistics;
+	InitJob(&statistics->Job, state, from, to, 0, ProcessStatisticsChunk, statistics);
+	StartJob(&statistics->Job);
+}
+
+void ImGui::ClearHexEditorStatistics(ImGuiHexEditorState* state)
+{
+	if (!state->Statistics)
+		return;
+
+	DestroyJob(&state->Statistics->Job);
+	IM_DELETE(state->Statistics);
+	state->Statistics = nullptr;
+}
+
+bool ImGui::IsHexEditorStatisticsRunning(ImGuiHexEditorState* state)
+{
+	return state->Statistics && state->Statistics->Job.WorkersRunning > 0;
+}
+
+float ImGui::GetHexEditorStatisticsProgress(ImGuiHexEditorState* state)
+{
+	return state->Statistics ? GetJobProgress(&state->Statistics->Job) : 0.f;
+}
+
+void ImGui::GetHexEditorByteHistogram(ImGuiHexEditorState* state, ImU64 out_histogram[256])
+{
+	ImGuiHexEditorStatistics* statistics = state->Statistics;
+	if (!statistics)
+	{
+		memset(out_histogram, 0, sizeof(ImU64) * 256);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(statistics->Mutex);
+	memcpy(out_histogram, statistics->Histogram, sizeof(statistics->Histogram));
+}
+
+void ImGui::StartHexEditorWatch(ImGuiHexEditorState* state, const ImGuiHexEditorWatchConfig& config)
+{
+	ImGui::StopHexEditorWatch(state);
+
+	ImGuiHexEditorWatch* watch = IM_NEW(ImGuiHexEditorWatch)();
+	watch->Config = config;
+	watch->State = state;
+	watch->StartTime = std::chrono::steady_clock::now();
+	AddWatchRange(watch, 0, 0); // Visible lines, set by BeginHexEditor()
+
+	state->Watch = watch;
+	watch->Thread = std::thread(WatchThread, watch);
+}
+
+void ImGui::StopHexEditorWatch(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorWatch* watch = state->Watch;
+	if (!watch)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(watch->Mutex);
+		watch->Quit = true;
+	}
+
+	watch->Cond.notify_one();
+	watch->Thread.join();
+
+	for (int i = 0; i != watch->Ranges.Size; i++)
+	{
+		watch->Ranges.Data[i].Data.clear();
+		watch->Ranges.Data[i].ChangeTimes.clear();
+	}
+
+	watch->Ranges.clear();
+	watch->Reads.clear();
+	watch->ReadBuffer.clear();
+	watch->ScratchData.clear();
+	watch->ScratchTimes.clear();
+
+	IM_DELETE(watch);
+	state->Watch = nullptr;
+}
+
+void ImGui::AddHexEditorWatchRange(ImGuiHexEditorState* state, ImS64 from, ImS64 to)
+{
+	ImGuiHexEditorWatch* watch = state->Watch;
+	IM_ASSERT(watch && "Call StartHexEditorWatch() first");
+
+	from = ImMax(from, (ImS64)0);
+	to = ImMin(to, GetSourceSize(state) - 1);
+	if (from > to)
+		return;
+
+	IM_ASSERT(to - from < INT_MAX && "Watched ranges are limited to 2 GiB");
+
+	std::lock_guard<std::mutex> lock(watch->Mutex);
+	AddWatchRange(watch, from, to - from + 1);
+}
+
+void ImGui::ClearHexEditorWatchRanges(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorWatch* watch = state->Watch;
+	if (!watch)
+		return;
+
+	std::lock_guard<std::mutex> lock(watch->Mutex);
+	for (int i = 1; i < watch->Ranges.Size; i++)
+	{
+		watch->Ranges.Data[i].Data.clear();
+		watch->Ranges.Data[i].ChangeTimes.clear();
+	}
+
+	watch->Ranges.Size = ImMin(watch->Ranges.Size, 1);
+}
+
+void ImGui::StartHexEditorWriteQueue(ImGuiHexEditorState* state, const ImGuiHexEditorWriteQueueConfig& config)
+{
+	ImGui::StopHexEditorWriteQueue(state);
+
+	ImGuiHexEditorWriteQueue* queue = IM_NEW(ImGuiHexEditorWriteQueue)();
+	queue->Config = config;
+	queue->State = state;
+
+	state->WriteQueue = queue;
+	queue->Thread = std::thread(WriteQueueThread, queue);
+}
+
+void ImGui::StopHexEditorWriteQueue(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorWriteQueue* queue = state->WriteQueue;
+	if (!queue)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(queue->Mutex);
+		queue->Quit = true;
+	}
+
+	queue->Cond.notify_one();
+	queue->Thread.join();
+
+	// Failed bytes were never written, so the source is read again
+	const bool had_failures = queue->Failed.Size != 0;
+	ClearQueuedWrites(&queue->Pending);
+	ClearQueuedWrites(&queue->Failed);
+	queue->Pending.clear();
+	queue->Flushing.clear();
+	queue->Failed.clear();
+
+	IM_DELETE(queue);
+	state->WriteQueue = nullptr;
+
+	if (had_failures)
+		InvalidateSourceViews(state, 0, -1);
+}
+
+void ImGui::FlushHexEditorWriteQueue(ImGuiHexEditorState* state, bool wait)
+{
+	ImGuiHexEditorWriteQueue* queue = state->WriteQueue;
+	if (!queue)
+		return;
+
+	std::unique_lock<std::mutex> lock(queue->Mutex);
+	if (queue->Pending.Size == 0 && queue->Flushing.Size == 0)
+		return;
+
+	queue->FlushRequested = true;
+	queue->Cond.notify_one();
+
+	if (wait)
+		queue->FlushedCond.wait(lock, [queue]() { return !queue->FlushRequested; });
+}
+
+ImS64 ImGui::GetHexEditorQueuedWriteBytes(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorWriteQueue* queue = state->WriteQueue;
+	if (!queue)
+		return 0;
+
+	std::lock_guard<std::mutex> lock(queue->Mutex);
+	ImS64 bytes = 0;
+	for (int i = 0; i != queue->Pending.Size; i++)
+		bytes += queue->Pending.Data[i].Data.Size;
+	for (int i = 0; i != queue->Flushing.Size; i++)
+		bytes += queue->Flushing.Data[i].Data.Size;
+
+	return bytes;
+}
+
+void ImGui::GetHexEditorWriteFailures(ImGuiHexEditorState* state, ImVector<ImGuiHexEditorWriteFailure>* out_failures)
+{
+	out_failures->resize(0);
+
+	ImGuiHexEditorWriteQueue* queue = state->WriteQueue;
+	if (!queue)
+		return;
+
+	std::lock_guard<std::mutex> lock(queue->Mutex);
+	for (int i = 0; i != queue->Failed.Size; i++)
+	{
+		ImGuiHexEditorWriteFailure failure;
+		failure.From = queue->Failed.Data[i].From;
+		failure.Size = queue->Failed.Data[i].Data.Size;
+		out_failures->push_back(failure);
+	}
+}
+
+void ImGui::RetryHexEditorWriteFailures(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorWriteQueue* queue = state->WriteQueue;
+	if (!queue)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(queue->Mutex);
+		for (int i = 0; i != queue->Failed.Size; i++)
+		{
+			const ImGuiHexEditorQueuedWrite& write = queue->Failed.Data[i];
+			AddQueuedWriteUnder(&queue->Pending, &queue->Pending, write.From, write.Data.Data, write.Data.Size, 0);
+		}
+		ClearQueuedWrites(&queue->Failed);
+	}
+
+	if (queue->Config.FlushInterval == 0.f)
+		queue->Cond.notify_one();
+}
+
+void ImGui::ClearHexEditorWriteFailures(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorWriteQueue* queue = state->WriteQueue;
+	if (!queue)
+		return;
+
+	ImVector<ImGuiHexEditorWriteFailure> failures;
+	{
+		std::lock_guard<std::mutex> lock(queue->Mutex);
+		for (int i = 0; i != queue->Failed.Size; i++)
+		{
+			ImGuiHexEditorWriteFailure failure;
+			failure.From = queue->Failed.Data[i].From;
+			failure.Size = queue->Failed.Data[i].Data.Size;
+			failures.push_back(failure);
+		}
+		ClearQueuedWrites(&queue->Failed);
+	}
+
+	for (const ImGuiHexEditorWriteFailure& failure : failures)
+		InvalidateSourceViews(state, failure.From, failure.Size);
+}
+
+ImGuiHexEditorDiff* ImGui::StartHexEditorDiff(ImGuiHexEditorState* state_a, ImGuiHexEditorState* state_b, ImGuiHexEditorDiffFlags flags, int block_size, ImS64 lookahead)
+{
+	IM_ASSERT(state_a != state_b && !state_a->Diff && !state_b->Diff);
+
+	ImGuiHexEditorDiff* diff = IM_NEW(ImGuiHexEditorDiff)();
+	diff->States[0] = state_a;
+	diff->States[1] = state_b;
+	diff->Flags = flags;
+	diff->BlockSize = ImMax(block_size, 4);
+	diff->Lookahead = ImMax(lookahead, (ImS64)diff->BlockSize * 4);
+	diff->Sizes[0] = state_a->File ? state_a->File->Size : state_a->MaxBytes;
+	diff->Sizes[1] = state_b->File ? state_b->File->Size : state_b->MaxBytes;
+	diff->Cancel = false;
+	diff->Running = true;
+	diff->Progress = 0;
+	for (ImGuiHexEditorDiffWindow& window : diff->Windows)
+		window.From = 0;
+
+	state_a->Diff = diff;
+	state_b->Diff = diff;
+	diff->Thread = std::thread(DiffThread, diff);
+	return diff;
+}
+
+void ImGui::DestroyHexEditorDiff(ImGuiHexEditorDiff* diff)
+{
+	if (!diff)
+		return;
+
+	diff->Cancel = true;
+	diff->Thread.join();
+
+	for (ImGuiHexEditorDiffWindow& window : diff->Windows)
+		window.Data.clear();
+
+	diff->Blocks.clear();
+	diff->Pending.clear();
+	diff->States[0]->Diff = nullptr;
+	diff->States[1]->Diff = nullptr;
+	IM_DELETE(diff);
+}
+
+bool ImGui::IsHexEditorDiffRunning(ImGuiHexEditorDiff* diff)
+{
+	return diff->Running;
+}
+
+float ImGui::GetHexEditorDiffProgress(ImGuiHexEditorDiff* diff)
+{
+	return diff->Sizes[0] > 0 ? (float)((double)diff->Progress / (double)diff->Sizes[0]) : 1.f;
+}
+
+const ImVector<ImGuiHexEditorDiffHunk>& ImGui::GetHexEditorDiffHunks(ImGuiHexEditorDiff* diff)
+{
+	UpdateHexEditorDiff(diff);
+	return diff->Hunks;
+}
+
+bool ImGui::SelectNextHexEditorDiffHunk(ImGuiHexEditorDiff* diff, bool backwards)
+{
+	UpdateHexEditorDiff(diff);
+
+	// Starts from the cursor of the leading pane
+	const int side = diff->Leader;
+	const ImS64 cursor = diff->States[side]->SelectStartByte;
+
+	// First hunk starting after the cursor, or the last one starting before it
+	int lo = 0;
+	int hi = diff->Hunks.Size;
+	while (lo < hi)
+	{
+		const int mid = lo + (hi - lo) / 2;
+		if (backwards ? diff->Hunks[mid].From[side] < cursor : diff->Hunks[mid].From[side] <= cursor)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	const int index = backwards ? lo - 1 : lo;
+
+	if (index < 0 || index >= diff->Hunks.Size)
+		return false;
+
+	const ImGuiHexEditorDiffHunk& hunk = diff->Hunks[index];
+	for (int i = 0; i != 2; i++)
+	{
+		ImGuiHexEditorState* state = diff->States[i];
+		const ImS64 from = ImMin(hunk.From[i], ImMax(diff->Sizes[i] - 1, (ImS64)0));
+
+		state->SelectStartByte = from;
+		state->SelectStartSubByte = 0;
+		state->SelectEndByte = hunk.Size[i] > 0 ? hunk.From[i] + hunk.Size[i] - 1 : from;
+		state->SelectEndSubByte = 0;
+		state->LastSelectedByte = from;
+		state->ScrollToByte = from;
+	}
+
+	return true;
+}
+
+void ImGui::ShowHexEditorDiff(const char* str_id, ImGuiHexEditorDiff* diff, const ImVec2& size)
+{
+	if (!ImGui::BeginChild(str_id, size))
+	{
+		ImGui::EndChild();
+		return;
+	}
+
+	UpdateHexEditorDiff(diff);
+
+	if (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows) && ImGui::IsKeyPressed(ImGuiKey_F7))
+		ImGui::SelectNextHexEditorDiffHunk(diff, ImGui::GetIO().KeyShift);
+
+	const ImGuiStyle& style = ImGui::GetStyle();
+	const ImVec2 avail = ImGui::GetContentRegionAvail();
+	const ImVec2 origin = ImGui::GetCursorScreenPos();
+	const ImVec2 pane_size = { ImMax((avail.x - style.ItemSpacing.x) * 0.5f, 1.f), ImMax(avail.y, 1.f) };
+	const float line_height = ImGui::CalcTextSize("0").y + style.ItemSpacing.y;
+
+	// The pane under the mouse leads, so the one being scrolled isn't pulled back by the other
+	for (int side = 0; side != 2; side++)
+	{
+		const ImVec2 pane_min = { origin.x + side * (pane_size.x + style.ItemSpacing.x), origin.y };
+		if (ImGui::IsMouseHoveringRect(pane_min, { pane_min.x + pane_size.x, pane_min.y + pane_size.y }))
+			diff->Leader = side;
+	}
+
+	ImS64 leader_offset = -1;
+	float leader_line_scroll = 0.f;
+	for (int i = 0; i != 2; i++)
+	{
+		const int side = i == 0 ? diff->Leader : 1 - diff->Leader;
+		ImGuiHexEditorState* state = diff->States[side];
+		const int bytes_per_line = state->DisplayBytesPerLine;
+
+		if (i == 1 && leader_offset >= 0 && bytes_per_line > 0)
+		{
+			// Scroll the following pane to the line lined up with the top line of the leading one
+			const ImS64 line = MapDiffOffset(diff, 1 - side, leader_offset) / bytes_per_line;
+			const ImS64 lines_count = (diff->Sizes[side] + bytes_per_line - 1) / bytes_per_line;
+			ImS64 base_line = 0;
+			if (lines_count > IMGUI_HEX_EDITOR_MAX_SCROLL_LINES)
+			{
+				base_line = state->ScrollBaseLine;
+				if (line < base_line + IMGUI_HEX_EDITOR_MAX_SCROLL_LINES / 4 || line >= base_line + IMGUI_HEX_EDITOR_MAX_SCROLL_LINES * 3 / 4)
+					base_line = ImClamp(line - IMGUI_HEX_EDITOR_MAX_SCROLL_LINES / 2, (ImS64)0, lines_count - IMGUI_HEX_EDITOR_MAX_SCROLL_LINES);
+			}
+
+			state->ScrollBaseLine = base_line;
+			ImGui::SetNextWindowScroll({ -1.f, (line - base_line) * line_height + leader_line_scroll });
+		}
+
+		char pane_id[16];
+		ImFormatString(pane_id, sizeof(pane_id), "##Pane%d", side);
+		ImGui::SetCursorScreenPos({ origin.x + side * (pane_size.x + style.ItemSpacing.x), origin.y });
+
+		const ImS64 base_line = state->ScrollBaseLine;
+		// Like BeginChild(), EndHexEditor() is called even when the pane is clipped
+		if (ImGui::BeginHexEditor(pane_id, state, pane_size) && i == 0 && state->DisplayBytesPerLine > 0)
+		{
+			const float scroll_y = ImGui::GetScrollY();
+			const ImS64 top_line = (ImS64)(scroll_y / line_height);
+			leader_offset = (base_line + top_line) * state->DisplayBytesPerLine;
+			leader_line_scroll = scroll_y - top_line * line_height;
+		}
+		ImGui::EndHexEditor();
+	}
+
+	ImGui::EndChild();
+}
+
+ImGuiHexEditorTemplate* ImGui::CreateHexEditorTemplate()
+{
+	return IM_NEW(ImGuiHexEditorTemplate);
+}
+
+void ImGui::DestroyHexEditorTemplate(ImGuiHexEditorTemplate* tpl)
+{
+	if (tpl)
+		IM_DELETE(tpl);
+}
+
+ImGuiHexEditorFieldType ImGui::AddHexEditorTemplateStruct(ImGuiHexEditorTemplate* tpl, const char* name)
+{
+	IM_ASSERT(name);
+
+	ImGuiHexEditorTemplateStruct st;
+	st.Name = AddTemplateName(tpl, name);
+	st.Size = 0;
+	st.FirstField = 0;
+	st.FieldsCount = 0;
+	st.LayoutState = 0;
+	tpl->Structs.push_back(st);
+	return ImGuiHexEditorFieldType_COUNT + tpl->Structs.Size - 1;
+}
+
+void ImGui::AddHexEditorTemplateField(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType struct_type, const char* name, ImGuiHexEditorFieldType type, int count,
+	ImGuiHexEditorFieldFlags flags, ImU32 color)
+{
+	IM_ASSERT(struct_type >= ImGuiHexEditorFieldType_COUNT && struct_type < ImGuiHexEditorFieldType_COUNT + tpl->Structs.Size);
+	IM_ASSERT(type >= 0 && type < ImGuiHexEditorFieldType_COUNT + tpl->Structs.Size && count >= 0);
+
+	ImGuiHexEditorTemplateField field;
+	field.Struct = struct_type - ImGuiHexEditorFieldType_COUNT;
+	field.Name = AddTemplateName(tpl, name);
+	field.Type = type;
+	field.Target = -1;
+	field.Count = count;
+	field.Flags = flags;
+	field.Color = color;
+	field.Offset = 0;
+	tpl->Fields.push_back(field);
+}
+
+void ImGui::AddHexEditorTemplatePointer(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType struct_type, const char* name, ImGuiHexEditorFieldType pointer_type,
+	ImGuiHexEditorFieldType target_type, int count, ImGuiHexEditorFieldFlags flags, ImU32 color)
+{
+	IM_ASSERT(pointer_type == ImGuiHexEditorFieldType_Pointer32 || pointer_type == ImGuiHexEditorFieldType_Pointer64);
+	IM_ASSERT(target_type >= 0 && target_type < ImGuiHexEditorFieldType_COUNT + tpl->Structs.Size);
+
+	ImGui::AddHexEditorTemplateField(tpl, struct_type, name, pointer_type, count, flags, color);
+	tpl->Fields.back().Target = target_type;
+}
+
+int ImGui::CompileHexEditorTemplate(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorState* state, ImGuiHexEditorFieldType type, ImS64 offset, int count,
+	ImS64 pointer_base, int max_fields)
+{
+	tpl->Nodes.resize(0);
+	tpl->Leaves.resize(0);
+	tpl->LeavesMaxEnd.resize(0);
+	tpl->NodeLeaves.resize(0);
+	tpl->MaxLeaves = max_fields;
+
+	// Group the fields by struct keeping the order they were added in, then lay every struct out
+	for (ImGuiHexEditorTemplateStruct& st : tpl->Structs)
+	{
+		st.FieldsCount = 0;
+		st.LayoutState = 0;
+	}
+
+	for (const ImGuiHexEditorTemplateField& field : tpl->Fields)
+		tpl->Structs[field.Struct].FieldsCount++;
+
+	int first_field = 0;
+	for (ImGuiHexEditorTemplateStruct& st : tpl->Structs)
+	{
+		st.FirstField = first_field;
+		first_field += st.FieldsCount;
+		st.FieldsCount = 0;
+	}
+
+	tpl->StructFields.resize(tpl->Fields.Size);
+	for (int i = 0; i != tpl->Fields.Size; i++)
+	{
+		ImGuiHexEditorTemplateStruct& st = tpl->Structs[tpl->Fields[i].Struct];
+		tpl->StructFields[st.FirstField + st.FieldsCount++] = i;
+	}
+
+	for (int i = 0; i != tpl->Structs.Size; i++)
+	{
+		if (LayoutTemplateType(tpl, ImGuiHexEditorFieldType_COUNT + i) < 0)
+			return -1;
+	}
+
+	ExpandTemplateType(tpl, type, offset, count, -1, -1, -1, ImColor::HSV(0.f, 0.5f, 0.9f, 0.35f));
+
+	// Pointers are followed breadth first, each target is expanded once per type so cycles end
+	const ImS64 source_size = GetSourceSize(state);
+	for (int i = 0; i < tpl->Pointers.Size && tpl->Leaves.Size < tpl->MaxLeaves; i++)
+	{
+		const ImGuiHexEditorTemplatePointer pointer = tpl->Pointers[i];
+		const ImGuiHexEditorTemplateField& field = tpl->Fields[pointer.Field];
+		const int pointer_size = TemplatePrimitiveSizes[field.Type];
+
+		unsigned char data[8];
+		if (ReadBytes(state, pointer.Offset, data, pointer_size) != pointer_size)
+			continue;
+
+		const ImU64 value = LoadValueBits(data, pointer_size, (field.Flags & ImGuiHexEditorFieldFlags_BigEndian) != 0);
+		if (value == 0 || value < (ImU64)pointer_base)
+			continue;
+
+		const ImS64 target = (ImS64)(value - (ImU64)pointer_base);
+		if (target < 0 || target > source_size - GetTemplateTypeSize(tpl, field.Target) || !AddTemplateTarget(tpl, target, field.Target))
+			continue;
+
+		ExpandTemplateNode(tpl, AddTemplateNode(tpl, target, field.Target, pointer.Field, pointer.Index, pointer.Node, true));
+	}
+
+	tpl->Pointers.clear();
+	tpl->Targets.clear();
+	tpl->TargetsCount = 0;
+
+	if (tpl->Leaves.Size > 1)
+		ImQsort(tpl->Leaves.Data, (size_t)tpl->Leaves.Size, sizeof(ImGuiHexEditorTemplateLeaf), CompareTemplateLeaves);
+
+	tpl->LeavesMaxEnd.resize(tpl->Leaves.Size);
+	ImS64 max_end = LLONG_MIN;
+	for (int i = 0; i != tpl->Leaves.Size; i++)
+	{
+		max_end = ImMax(max_end, tpl->Leaves[i].Offset + tpl->Leaves[i].Size);
+		tpl->LeavesMaxEnd[i] = max_end;
+	}
+
+	// Leaves of every node, in offset order
+	for (const ImGuiHexEditorTemplateLeaf& leaf : tpl->Leaves)
+	{
+		if (leaf.Node != -1)
+			tpl->Nodes[leaf.Node].LeavesCount++;
+	}
 
-	char stack_address_buf[32];
-	char* address_buf = address_max_chars <= sizeof(stack_address_buf) ? stack_address_buf : (char*)ImGui::MemAlloc(address_max_chars);
-	if (!address_buf)
+	int first_leaf = 0;
+	for (ImGuiHexEditorTemplateNode& node : tpl->Nodes)
 	{
-		if (line_buf != stack_line_buf)
-			ImGui::MemFree(line_buf);
+		node.FirstLeaf = first_leaf;
+		first_leaf += node.LeavesCount;
+		node.LeavesCount = 0;
+	}
 
-		return true;
+	tpl->NodeLeaves.resize(first_leaf);
+	for (int i = 0; i != tpl->Leaves.Size; i++)
+	{
+		const int node_index = tpl->Leaves[i].Node;
+		if (node_index == -1)
+			continue;
+
+		ImGuiHexEditorTemplateNode& node = tpl->Nodes[node_index];
+		tpl->NodeLeaves[node.FirstLeaf + node.LeavesCount++] = i;
 	}
 
-	const ImVec2 mouse_pos = ImGui::GetMousePos();
-	const bool mouse_left_down = ImGui::IsMouseDown(ImGuiMouseButton_Left);
+	return tpl->Leaves.Size;
+}
 
-	ImGuiListClipper clipper;
-	clipper.Begin(lines_count, byte_size.y + spacing.y);
-	while (clipper.Step())
+bool ImGui::GetHexEditorTemplateFieldName(ImGuiHexEditorTemplate* tpl, ImS64 offset, char* buf, int size)
+{
+	const int leaf = FindTemplateLeaf(tpl, offset);
+	if (leaf == -1 || size <= 0)
+		return false;
+
+	FormatTemplatePath(tpl, tpl->Leaves[leaf], offset, buf, size);
+	return true;
+}
+
+void ImGui::ShowHexEditorTemplateInspector(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorTemplate* tpl = state->Template;
+	const ImS64 cursor = state->LastSelectedByte;
+	const int selected = tpl && cursor >= 0 ? FindTemplateLeaf(tpl, cursor) : -1;
+	if (selected == -1)
 	{
-		const int clipper_lines = clipper.DisplayEnd - clipper.DisplayStart;
+		ImGui::TextDisabled("No field at the cursor");
+		return;
+	}
 
-		ImVec2 cursor = ImGui::GetCursorScreenPos();
+	char text[256];
+	FormatTemplatePath(tpl, tpl->Leaves[selected], cursor, text, sizeof(text));
+	ImGui::TextUnformatted(text);
 
-		ImVec2 ascii_cursor = { cursor.x + address_max_size + (spacing.x * 0.5f) + (bytes_per_line * (byte_size.x + spacing.x)) + (actual_separators * spacing.x), cursor.y };
-		if (show_ascii)
-		{
-			draw_list->AddLine(ascii_cursor, { ascii_cursor.x, ascii_cursor.y + clipper_lines * (byte_size.y + spacing.y) }, separator_color);
-		}
+	// Fields of the struct containing the selected one, or the selected one alone for primitive roots
+	const int node = tpl->Leaves[selected].Node;
+	const int* leaves = node != -1 ? tpl->NodeLeaves.Data + tpl->Nodes[node].FirstLeaf : &selected;
+	const int leaves_count = node != -1 ? tpl->Nodes[node].LeavesCount : 1;
 
-		{
-			int count = clipper_lines * bytes_per_line * 2;
-			if (show_ascii)
-				count += clipper_lines * bytes_per_line;
+	if (!ImGui::BeginTable("##TemplateFields", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY))
+		return;
 
-			draw_list->IdxBuffer.reserve(draw_list->IdxBuffer.Size + (count * 6));
-			draw_list->VtxBuffer.reserve(draw_list->VtxBuffer.Size + (count * 4));
-		}
+	ImGui::TableSetupScrollFreeze(0, 1);
+	ImGui::TableSetupColumn("Offset");
+	ImGui::TableSetupColumn("Field");
+	ImGui::TableSetupColumn("Type");
+	ImGui::TableSetupColumn("Value");
+	ImGui::TableHeadersRow();
 
-		for (int n = clipper.DisplayStart; n != clipper.DisplayEnd; n++)
+	ImGuiListClipper clipper;
+	clipper.Begin(leaves_count);
+	while (clipper.Step())
+	{
+		for (int i = clipper.DisplayStart; i != clipper.DisplayEnd; i++)
 		{
-			const int line_base = n * bytes_per_line;
-			if (state->ShowAddress)
+			const ImGuiHexEditorTemplateLeaf& leaf = tpl->Leaves[leaves[i]];
+			const int element_size = TemplatePrimitiveSizes[leaf.Type];
+			const bool is_selected = leaves[i] == selected;
+			const bool is_array = leaf.Size > element_size;
+
+			// Arrays show the element under the cursor when selected, their first one otherwise
+			const ImS64 element = is_selected ? leaf.Offset + (cursor - leaf.Offset) / element_size * element_size : leaf.Offset;
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::PushID(i);
+			ImFormatString(text, sizeof(text), "%llX", (unsigned long long)element);
+			if (ImGui::Selectable(text, is_selected, ImGuiSelectableFlags_SpanAllColumns))
 			{
-				if (!state->GetAddressNameCallback || !state->GetAddressNameCallback(state, line_base, address_buf, address_max_chars))
-					ImFormatString(address_buf, (size_t)address_max_chars, "%0.*zX", address_max_chars - 1, (size_t)line_base);
-
-				const ImVec2 text_size = ImGui::CalcTextSize(address_buf);
-				draw_list->AddText(cursor, text_color, address_buf);
-				draw_list->AddText({ cursor.x + text_size.x, cursor.y }, text_disabled_color, ":");
-				cursor.x += address_max_size;
+				state->SelectStartByte = leaf.Offset;
+				state->SelectStartSubByte = 0;
+				state->SelectEndByte = leaf.Offset + leaf.Size - 1;
+				state->SelectEndSubByte = 0;
+				state->LastSelectedByte = leaf.Offset;
+				state->ScrollToByte = leaf.Offset;
 			}
+			ImGui::PopID();
 
-			int max_bytes_per_line = line_base;
-			max_bytes_per_line = max_bytes_per_line > state->MaxBytes ? max_bytes_per_line - state->MaxBytes : bytes_per_line;
+			ImGui::TableNextColumn();
+			const char* name = leaf.Field != -1 ? tpl->Names.Data + tpl->Fields[leaf.Field].Name : GetTemplateTypeName(tpl, leaf.Type);
+			if (is_array && is_selected)
+				ImGui::Text("%s[%lld]", name, (long long)((element - leaf.Offset) / element_size));
+			else
+				ImGui::TextUnformatted(name);
 
-			int bytes_read;
-			if (!state->ReadCallback)
+			ImGui::TableNextColumn();
+			const ImGuiHexEditorFieldType target = leaf.Field != -1 ? tpl->Fields[leaf.Field].Target : -1;
+			const char* type_name = target != -1 ? GetTemplateTypeName(tpl, target) : GetTemplateTypeName(tpl, leaf.Type);
+			if (is_array)
+				ImGui::Text("%s%s[%lld]", type_name, target != -1 ? "*" : "", (long long)(leaf.Size / element_size));
+			else
+				ImGui::Text("%s%s", type_name, target != -1 ? "*" : "");
+
+			ImGui::TableNextColumn();
+			if (leaf.Type == ImGuiHexEditorFieldType_Char && is_array)
 			{
-				memcpy(line_buf, (char*)state->Bytes + line_base, max_bytes_per_line);
-				bytes_read = max_bytes_per_line;
+				// Text up to its terminator, cut to what fits into text
+				const int size = (int)ImMin(leaf.Size, (ImS64)sizeof(text) - 3);
+				unsigned char data[sizeof(text)];
+				const int read = (int)ReadBytes(state, leaf.Offset, data, size);
+				int length = 0;
+				text[length++] = '"';
+				for (int j = 0; j != read && data[j]; j++)
+					text[length++] = HasAsciiRepresentation(data[j]) ? (char)data[j] : '.';
+				text[length++] = '"';
+				text[length] = '\0';
+				ImGui::TextUnformatted(text);
 			}
 			else
-				bytes_read = state->ReadCallback(state, line_base, line_buf, max_bytes_per_line);
-
-			cursor.x += spacing.x * 0.5f;
-
-			for (int i = 0; i != bytes_per_line; i++)
 			{
-				const ImRect byte_bb = { { cursor.x, cursor.y }, { cursor.x + byte_size.x, cursor.y + byte_size.y } };
+				unsigned char data[8];
+				if (ReadBytes(state, element, data, element_size) == element_size)
+				{
+					FormatTemplateValue(text, sizeof(text), leaf.Type, leaf.Flags, data);
+					ImGui::TextUnformatted(text);
+				}
+				else
+					ImGui::TextDisabled("??");
+			}
+		}
+	}
 
-				ImRect item_bb = byte_bb;
+	ImGui::EndTable();
+}
 
-				item_bb.Min.x -= spacing.x * 0.5f;
+ImGuiHexEditorDataInspector* ImGui::CreateHexEditorDataInspector(float refresh_interval)
+{
+	ImGuiHexEditorDataInspector* inspector = IM_NEW(ImGuiHexEditorDataInspector);
+	inspector->RefreshInterval = refresh_interval;
+	return inspector;
+}
 
-				if (n != clipper.DisplayStart)
-					item_bb.Min.y -= spacing.y * 0.5f;
+void ImGui::DestroyHexEditorDataInspector(ImGuiHexEditorDataInspector* inspector)
+{
+	if (inspector)
+		IM_DELETE(inspector);
+}
 
-				item_bb.Max.x += spacing.x * 0.5f;
-				item_bb.Max.y += spacing.y * 0.5f;
+void ImGui::InvalidateHexEditorDataInspector(ImGuiHexEditorDataInspector* inspector)
+{
+	inspector->Dirty = true;
+}
 
-				const int offset = bytes_per_line * n + i;
-				unsigned char byte;
+void ImGui::ShowHexEditorDataInspector(ImGuiHexEditorState* state)
+{
+	ImGuiHexEditorDataInspector* inspector = state->DataInspector;
+	IM_ASSERT(inspector && "ImGuiHexEditorState::DataInspector must be set, see ImGui::CreateHexEditorDataInspector()");
 
-				ImVec2 byte_ascii = ascii_cursor;
+	UpdateDataInspector(state, inspector);
+	if (inspector->Size == 0)
+	{
+		ImGui::TextDisabled(inspector->Offset >= 0 ? "Bytes at the cursor can't be read" : "No byte selected");
+		return;
+	}
 
-				byte_ascii.x += (char_size.x * i) + spacing.x;
-				byte_ascii.y += (char_size.y + spacing.y) * (n - clipper.DisplayStart);
+	if (!ImGui::BeginTable("##DataInspector", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable))
+		return;
 
-				char text[3];
-				if (offset < state->MaxBytes && i < bytes_read)
-				{
-					byte = line_buf[i];
+	ImGui::TableSetupColumn("Type");
+	ImGui::TableSetupColumn("Little endian");
+	ImGui::TableSetupColumn("Big endian");
+	ImGui::TableHeadersRow();
 
-					text[0] = HalfByteToPrintable((byte & 0xf0) >> 4, lowercase_bytes);
-					text[1] = HalfByteToPrintable(byte & 0x0f, lowercase_bytes);
-					text[2] = '\0';
-				}
-				else
-				{
-					byte = 0x00;
+	for (int row = 0; row != ImGuiHexEditorInspectorRow_COUNT; row++)
+	{
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(InspectorRowNames[row]);
 
-					text[0] = '?';
-					text[1] = '?';
-					text[2] = '\0';
-				}
+		for (int order = 0; order != 2; order++)
+		{
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(inspector->Values[row][order]);
+		}
+	}
 
-				const ImGuiID id = ImGui::GetID(offset);
+	ImGui::EndTable();
+}
 
-				if (!ImGui::ItemAdd(item_bb, id, 0, ImGuiItemFlags_Inputable))
-					continue;
+void ImGui::StartHexEditorMinimap(ImGuiHexEditorState* state, int block_size)
+{
+	IM_ASSERT(block_size > 0);
+	ImGui::StopHexEditorMinimap(state);
+
+	ImGuiHexEditorMinimap* minimap = IM_NEW(ImGuiHexEditorMinimap)();
+	minimap->Job.Workers = nullptr;
+	minimap->Job.WorkersCount = 0;
+	minimap->Job.WorkersRunning = 0;
+	minimap->MinBlockShift = 8;
+	while (((ImS64)1 << minimap->MinBlockShift) < block_size)
+		minimap->MinBlockShift++;
+
+	state->Minimap = minimap;
+	ResetMinimap(state, minimap);
+}
 
-				ImColor byte_text_color = (offset >= state->MaxBytes || (state->RenderZeroesDisabled && byte == 0x00) || i >= bytes_read) ? text_disabled_color : text_color;
+void ImGui::StopHexEditorMinimap(ImGuiHexEditorState* state)
+{
+	if (!state->Minimap)
+		return;
 
-				if (offset >= select_start_byte && offset <= select_end_byte)
-				{
-					ImGuiHexEditorHighlightFlags flags = state->SelectionHighlightFlags;
-					
-					if (select_start_byte == select_end_byte)
-					{
-						flags &= ~ImGuiHexEditorHighlightFlags_FullSized;
-					}
+	DestroyJob(&state->Minimap->Job);
+	IM_DELETE(state->Minimap);
+	state->Minimap = nullptr;
+}
 
-					ImRect bb = (flags & ImGuiHexEditorHighlightFlags_FullSized) ? item_bb : byte_bb;
+void ImGui::InvalidateHexEditorMinimap(ImGuiHexEditorState* state, ImS64 offset, ImS64 size)
+{
+	ImGuiHexEditorMinimap* minimap = state->Minimap;
+	if (!minimap)
+		return;
 
-					if (select_start_byte == select_end_byte)
-					{
-						if (select_start_subbyte)
-							bb.Min.x = byte_bb.GetCenter().x;
-						else
-							bb.Max.x = byte_bb.GetCenter().x;
-					}
+	minimap->EditRoot = state->EditBuffer ? state->EditBuffer->Root : -1;
+	if (size < 0)
+	{
+		offset = 0;
+		size = minimap->SourceSize;
+	}
 
-					RenderByteDecorations(draw_list, bb, text_selected_bg_color, flags, border_color,
-						style.FrameRounding, offset, select_start_byte, select_end_byte, bytes_per_line, i, line_base);
+	offset = ImMax(offset, (ImS64)0);
+	const ImS64 to = ImMin(offset + size, minimap->SourceSize);
+	if (offset < to)
+		AddMinimapDirtyBlocks(minimap, offset >> minimap->BlockShift, (to - 1) >> minimap->BlockShift);
+}
 
-					if (flags & ImGuiHexEditorHighlightFlags_Ascii)
-					{
-						RenderByteDecorations(draw_list, { byte_ascii, { byte_ascii.x + char_size.x, byte_ascii.y + char_size.y } }, 
-							text_selected_bg_color, flags, border_color, style.FrameRounding, offset, offset, offset, bytes_per_line, i, line_base);
-					}
-				}
-				else
-				{
-					bool single_highlight = false;
+bool ImGui::IsHexEditorMinimapRunning(ImGuiHexEditorState* state)
+{
+	return state->Minimap && (state->Minimap->Job.WorkersRunning > 0 || state->Minimap->Dirty.Size > 0);
+}
 
-					if (state->SingleHighlightCallback)
-					{
-						ImColor color;
-						ImColor custom_border_color;
+float ImGui::GetHexEditorMinimapProgress(ImGuiHexEditorState* state)
+{
+	return state->Minimap ? GetJobProgress(&state->Minimap->Job) : 0.f;
+}
 
-						ImGuiHexEditorHighlightFlags flags = state->SingleHighlightCallback(state, offset, 
-								&color, &byte_text_color, &custom_border_color);
+void ImGui::ShowHexEditorMinimap(const char* str_id, ImGuiHexEditorState* state, const ImVec2& size)
+{
+	ImGuiHexEditorMinimap* minimap = state->Minimap;
+	IM_ASSERT(minimap && "ImGuiHexEditorState::Minimap must be set, see ImGui::StartHexEditorMinimap()");
 
-						if (flags & ImGuiHexEditorHighlightFlags_Apply)
-						{
-							ImColor highlight_border_color;
+	UpdateHexEditorMinimap(state);
 
-							if (flags & ImGuiHexEditorHighlightFlags_BorderAutomaticContrast)
-								highlight_border_color = CalcContrastColor(color);
-							else if (flags & ImGuiHexEditorHighlightFlags_OverrideBorderColor)
-								highlight_border_color = custom_border_color;
-							else
-								highlight_border_color = border_color;
+	const ImVec2 item_size = ImGui::CalcItemSize(size, ImGui::CalcTextSize("000").x, ImGui::GetContentRegionAvail().y);
+	ImGui::InvisibleButton(str_id, { ImMax(item_size.x, 1.f), ImMax(item_size.y, 1.f) });
 
-							single_highlight = true;
+	const ImRect bb = { ImGui::GetItemRectMin(), ImGui::GetItemRectMax() };
+	ImDrawList* draw_list = ImGui::GetWindowDrawList();
+	draw_list->AddRectFilled(bb.Min, bb.Max, ImGui::GetColorU32(ImGuiCol_FrameBg));
 
-							RenderByteDecorations(draw_list, (flags & ImGuiHexEditorHighlightFlags_FullSized) ? item_bb : byte_bb, color, flags, highlight_border_color,
-								style.FrameRounding, offset, offset, offset, bytes_per_line, i, line_base);
+	const ImS64 source_size = minimap->SourceSize;
+	const int rows = (int)bb.GetHeight();
+	if (source_size == 0 || rows == 0)
+		return;
 
-							if (flags & ImGuiHexEditorHighlightFlags_Ascii)
-							{
-								RenderByteDecorations(draw_list, { byte_ascii, { byte_ascii.x + char_size.x, byte_ascii.y + char_size.y } }, color, flags, highlight_border_color,
-									style.FrameRounding, offset, offset, offset, bytes_per_line, i, line_base);
-							}
-							
-							if (flags & ImGuiHexEditorHighlightFlags_TextAutomaticContrast)
-								byte_text_color = CalcContrastColor(color);
-						}
-					}
+	const double bytes_per_row = (double)source_size / rows;
+	const float markers_x = bb.Max.x - ImMax(ImFloor(bb.GetWidth() * 0.25f), 2.f);
+	const ImU32 unscanned_color = ImGui::GetColorU32(ImGuiCol_FrameBgHovered);
 
-					if (!single_highlight)
-					{
-						for (int j = 0; j != state->HighlightRanges.Size; j++)
-						{
-							ImGuiHexEditorHighlightRange& range = state->HighlightRanges[j];
+	ImVector<ImU32> colors;
+	colors.resize(rows);
+	{
+		std::lock_guard<std::mutex> lock(minimap->Mutex);
+		for (int y = 0; y != rows; y++)
+		{
+			ImS64 row_from, row_to;
+			GetMinimapRowRange(source_size, rows, y, &row_from, &row_to);
+			colors[y] = GetMinimapCellColor(SampleMinimap(minimap, row_from, row_to), unscanned_color);
+		}
+	}
 
-							if (line_base + i >= range.From && line_base + i <= range.To)
-							{
-								ImColor highlight_border_color;
-
-								if (range.Flags & ImGuiHexEditorHighlightFlags_BorderAutomaticContrast)
-									highlight_border_color = CalcContrastColor(range.Color);
-								else if (range.Flags & ImGuiHexEditorHighlightFlags_OverrideBorderColor)
-									highlight_border_color = range.BorderColor;
-								else
-									highlight_border_color = border_color;
-
-								RenderByteDecorations(draw_list, (range.Flags & ImGuiHexEditorHighlightFlags_FullSized) ? item_bb : byte_bb, range.Color, range.Flags, highlight_border_color,
-									style.FrameRounding, offset, range.From, range.To, bytes_per_line, i, line_base);
-
-								if (range.Flags & ImGuiHexEditorHighlightFlags_Ascii)
-								{
-									RenderByteDecorations(draw_list, { byte_ascii, { byte_ascii.x + char_size.x, byte_ascii.y + char_size.y } }, range.Color, range.Flags, highlight_border_color,
-										style.FrameRounding, offset, range.From, range.To, bytes_per_line, i, line_base);
-								}
-
-								if (range.Flags & ImGuiHexEditorHighlightFlags_TextAutomaticContrast)
-									byte_text_color = CalcContrastColor(range.Color);
-							}
-						}
-					}
-				}
+	// One rect per run of rows of the same color
+	for (int y = 0; y != rows;)
+	{
+		int end = y + 1;
+		while (end != rows && colors[end] == colors[y])
+			end++;
 
-				draw_list->AddText(byte_bb.Min, byte_text_color, text);
+		draw_list->AddRectFilled({ bb.Min.x, bb.Min.y + y }, { markers_x, bb.Min.y + end }, colors[y]);
+		y = end;
+	}
 
-				if (offset == select_start_byte)
-				{
-					state->SelectCursorAnimationTime += io.DeltaTime;
+	// Markers of the highlight ranges, then of the search results and diff hunks which are drawn over them
+	UpdateHexEditorSearch(state);
+	memset(colors.Data, 0, sizeof(ImU32) * (size_t)rows);
+	for (const ImGuiHexEditorHighlightRange& range : state->HighlightRanges)
+	{
+		if (range.To < 0 || range.From >= source_size)
+			continue;
 
-					if (!io.ConfigInputTextCursorBlink || ImFmod(state->SelectCursorAnimationTime, 1.20f) <= 0.80f)
-					{
-						ImVec2 pos;
-						pos.x = byte_bb.Min.x;
-						pos.y = byte_bb.Max.y;
+		const int first = ImClamp((int)(ImMax(range.From, (ImS64)0) / bytes_per_row), 0, rows - 1);
+		const int last = ImClamp((int)(ImMin(range.To, source_size - 1) / bytes_per_row), first, rows - 1);
+		for (int y = first; y <= last; y++)
+			colors[y] = range.Color;
+	}
 
-						if (select_start_subbyte)
-							pos.x += char_size.x;
-						
-						draw_list->AddLine({ pos.x, pos.y }, { pos.x + char_size.x, pos.y }, text_color);
-					}
-				}
+	const ImVector<ImS64>& results = state->SearchResults;
+	ImGuiHexEditorDiff* diff = state->Diff;
+	const int diff_side = diff && diff->States[1] == state ? 1 : 0;
+	const ImU32 search_color = ImGui::GetColorU32(ImGuiCol_PlotHistogram);
+	const ImU32 diff_color = ImGui::GetColorU32(ImGuiCol_PlotLinesHovered);
+	for (int y = 0; y != rows; y++)
+	{
+		ImS64 row_from, row_to;
+		GetMinimapRowRange(source_size, rows, y, &row_from, &row_to);
+		if (results.Size > 0)
+		{
+			const int i = FindFirstSearchResult(results, row_from);
+			if (i != results.Size && results[i] < row_to)
+				colors[y] = search_color;
+		}
 
-				const bool hovered = ImGui::ItemHoverable(item_bb, id, ImGuiItemFlags_Inputable);
+		if (diff)
+		{
+			const int i = FindFirstDiffHunk(diff, diff_side, row_from);
+			if (i != diff->Hunks.Size && diff->Hunks[i].From[diff_side] < row_to)
+				colors[y] = diff_color;
+		}
+	}
 
-				if (select_drag_byte != -1 && offset == select_drag_byte && !mouse_left_down)
-				{
-					next_select_drag_byte = -1;
-				}
-				else
-				{
-					if (hovered)
-					{
-						const bool clicked = ImGui::IsItemClicked();
+	for (int y = 0; y != rows;)
+	{
+		int end = y + 1;
+		while (end != rows && colors[end] == colors[y])
+			end++;
 
-						if (clicked)
-						{
-							next_select_start_byte = offset;
-							next_select_end_byte = offset;
-							next_select_drag_byte = offset;
-							next_select_drag_subbyte = mouse_pos.x > byte_bb.GetCenter().x;
-							next_select_start_subbyte = next_select_drag_subbyte;
-							next_last_selected_byte = offset;
+		if (colors[y] != 0)
+			draw_list->AddRectFilled({ markers_x, bb.Min.y + y }, { bb.Max.x, bb.Min.y + end }, colors[y]);
 
-							ImGui::SetKeyboardFocusHere();
-						}
-						else if (mouse_left_down && select_drag_byte != -1)
-						{
-							if (offset >= select_drag_byte)
-							{
-								next_select_end_byte = offset;
-							}
-							else
-							{
-								next_select_start_byte = offset;
-								next_select_end_byte = select_drag_byte;
-								next_select_start_subbyte = 0;
-							}	
+		y = end;
+	}
 
-							ImGui::SetKeyboardFocusHere();
-						}
-					}
-				}
+	// Lines visible in the editor and the cursor
+	const ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+	if (state->DisplayEndByte > state->DisplayStartByte)
+	{
+		const float view_min_y = bb.Min.y + ImFloor((float)(state->DisplayStartByte / bytes_per_row));
+		const float view_max_y = ImMax(bb.Min.y + ImFloor((float)(state->DisplayEndByte / bytes_per_row)), view_min_y + 3.f);
+		draw_list->AddRect({ bb.Min.x, view_min_y }, { bb.Max.x, view_max_y }, text_color);
+	}
 
-				if (offset == next_last_selected_byte && last_selected_byte != next_last_selected_byte)
-				{
-					ImGui::SetKeyboardFocusHere();
-				}
+	if (state->LastSelectedByte >= 0 && state->LastSelectedByte < source_size)
+	{
+		const float cursor_y = bb.Min.y + ImFloor((float)(state->LastSelectedByte / bytes_per_row)) + 0.5f;
+		draw_list->AddLine({ bb.Min.x, cursor_y }, { bb.Max.x, cursor_y }, text_color);
+	}
 
-				if (offset == last_selected_byte && !state->ReadOnly && hex_key_pressed != ImGuiKey_None)
-				{
-					IM_ASSERT(offset == select_start_byte || offset == select_end_byte);
-					const int subbyte = offset == select_start_byte ? select_start_subbyte : select_end_subbyte;
+	const float mouse_ratio = ImSaturate((ImGui::GetMousePos().y - bb.Min.y) / bb.GetHeight());
+	const ImS64 mouse_offset = ImMin((ImS64)(mouse_ratio * (double)source_size), source_size - 1);
+	if (ImGui::IsItemActive())
+		state->ScrollToByte = mouse_offset;
 
-					unsigned char wbyte;
-					if (subbyte)
-						wbyte = (byte & 0xf0) | KeyToHalfByte(hex_key_pressed);
-					else
-						wbyte = (KeyToHalfByte(hex_key_pressed) << 4) | (byte & 0x0f);
+	if (ImGui::IsItemHovered())
+	{
+		ImS64 row_from, row_to;
+		GetMinimapRowRange(source_size, rows, ImMin((int)(mouse_ratio * rows), rows - 1), &row_from, &row_to);
 
-					if (!state->WriteCallback)
-						*(unsigned char*)((char*)state->Bytes + n * bytes_per_line + i) = wbyte;
-					else
-						state->WriteCallback(state, n * bytes_per_line + i, &wbyte, sizeof(wbyte));
+		ImGuiHexEditorMinimapCell cell;
+		{
+			std::lock_guard<std::mutex> lock(minimap->Mutex);
+			cell = SampleMinimap(minimap, row_from, row_to);
+		}
 
-					int* next_subbyte = (int*)(offset == select_start_byte ? &next_select_start_subbyte : &next_select_end_subbyte);
-					if (!subbyte)
-					{
-						next_select_start_byte = offset;
-						next_select_end_byte = offset;
-						*next_subbyte = 1;
-					}
-					else
-					{
-						next_last_selected_byte = offset + 1;
-						if (next_last_selected_byte >= state->MaxBytes - 1)
-							next_last_selected_byte = state->MaxBytes - 1;
-						else
-							*next_subbyte = 0;
+		if (cell.Scanned == 0)
+			ImGui::SetTooltip("%llX\nNot scanned yet", (unsigned long long)mouse_offset);
+		else
+			ImGui::SetTooltip("%llX\nEntropy: %.2f bits\nZeros: %d%%\nText: %d%%", (unsigned long long)mouse_offset, cell.Entropy / 32.f, cell.Zeros * 100 / 255, cell.Ascii * 100 / 255);
+	}
+}
 
-						next_select_start_byte = next_last_selected_byte;
-						next_select_end_byte = next_last_selected_byte;
-					}
+bool ImGui::ExportHexEditorBytes(ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImGuiHexEditorExportFormat format, ImGuiHexEditorExportCallback callback, void* user_data,
+	ImGuiHexEditorClipboardFlags flags, int bytes_per_line)
+{
+	const ImS64 source_size = GetSourceSize(state);
+	if (to < 0 || to >= source_size)
+		to = source_size - 1;
 
-					state->SelectCursorAnimationTime = 0.f;
-				}
+	from = ImMax(from, (ImS64)0);
+	if (from > to)
+		return true;
 
-				cursor.x += byte_size.x + spacing.x;
-				if (i > 0 && state->Separators > 0 && (i + 1) % state->Separators == 0
-					&& i != bytes_per_line - 1)
-					cursor.x += spacing.x;
+	if (bytes_per_line <= 0)
+		bytes_per_line = 16;
+
+	// Chunks are aligned to lines, so hex dump lines are never split between two of them
+	const ImS64 chunk_size = (ImS64)bytes_per_line * ImMax(1, 64 * 1024 / bytes_per_line);
+
+	ImGuiHexEditorExport exp;
+	exp.Callback = callback;
+	exp.UserData = user_data;
+	exp.Size = 0;
+	exp.Capacity = ImMax(64 * 1024, bytes_per_line * 8 + 128);
+	exp.Failed = false;
+	exp.From = from;
+	exp.To = to;
+	exp.BytesPerLine = bytes_per_line;
+	exp.Multiline = (flags & ImGuiHexEditorClipboardFlags_Multiline) != 0;
+	exp.Lowercase = state->LowercaseBytes;
+	exp.Base64CarrySize = 0;
+
+	exp.AddressChars = state->AddressChars > 0 ? state->AddressChars : 8;
+	while (exp.AddressChars < 16 && (to >> (exp.AddressChars * 4)) != 0)
+		exp.AddressChars++;
+
+	// The text of every chunk is formatted at once by the same kernel as the rows of the editor
+	const bool has_hex = format == ImGuiHexEditorExportFormat_Hex || format == ImGuiHexEditorExportFormat_HexDump || format == ImGuiHexEditorExportFormat_CArray
+		|| format == ImGuiHexEditorExportFormat_PythonBytes;
+	exp.Hex = has_hex ? (char*)IM_ALLOC((size_t)chunk_size * 2) : nullptr;
+	exp.Ascii = format == ImGuiHexEditorExportFormat_HexDump ? (char*)IM_ALLOC((size_t)chunk_size) : nullptr;
+
+	unsigned char* data = (unsigned char*)IM_ALLOC((size_t)chunk_size);
+	exp.Buffer = (char*)IM_ALLOC((size_t)exp.Capacity);
+
+	bool read_failed = false;
+	for (ImS64 offset = from; offset <= to && !exp.Failed;)
+	{
+		const int size = (int)(ImMin(to + 1, (offset / chunk_size + 1) * chunk_size) - offset);
+		if (ReadBytes(state, offset, data, size) != size)
+		{
+			read_failed = true;
+			break;
+		}
 
-				if (show_ascii)
-				{
-					unsigned char byte;
-					if (offset < state->MaxBytes)
-						byte = line_buf[i];
-					else
-						byte = 0x00;
+		if (exp.Hex)
+			FormatHexRow(data, size, exp.Lowercase, exp.Hex, exp.Ascii);
 
-					bool has_ascii = HasAsciiRepresentation(byte);
+		switch (format)
+		{
+		case ImGuiHexEditorExportFormat_Hex: ExportHex(&exp, offset, size); break;
+		case ImGuiHexEditorExportFormat_HexDump: ExportHexDump(&exp, offset, size); break;
+		case ImGuiHexEditorExportFormat_CArray: ExportCArray(&exp, offset, size); break;
+		case ImGuiHexEditorExportFormat_Base64: ExportBase64(&exp, offset, data, size); break;
+		case ImGuiHexEditorExportFormat_PythonBytes: ExportPythonBytes(&exp, offset, size); break;
+		case ImGuiHexEditorExportFormat_Binary:
+			if (FlushExport(&exp) && !callback(user_data, (const char*)data, size))
+				exp.Failed = true;
+			break;
+		default: IM_ASSERT(0 && "Unknown export format"); break;
+		}
 
-					const ImRect char_bb = { byte_ascii,  { byte_ascii.x + char_size.x, byte_ascii.y + char_size.y } };
-					
-					/*if (offset >= select_start_byte && offset <= select_end_byte)
-					{
-						draw_list->AddRectFilled(char_bb.Min, char_bb.Max, text_selected_bg_color);
-					}*/
+		offset += size;
+	}
 
-					char text[2];
-					text[0] = has_ascii ? *(char*)&byte : '.';
-					text[1] = '\0';
+	FlushExport(&exp);
 
-					draw_list->AddText(byte_ascii, byte_text_color, text);
-				}
+	IM_FREE(exp.Buffer);
+	IM_FREE(data);
+	if (exp.Hex)
+		IM_FREE(exp.Hex);
+	if (exp.Ascii)
+		IM_FREE(exp.Ascii);
 
-				ImGui::SetCursorScreenPos(cursor);
-			}
+	return !read_failed && !exp.Failed;
+}
 
-			ImGui::NewLine();
-			cursor = ImGui::GetCursorScreenPos();
-		}
-	}
+bool ImGui::ExportHexEditorBytesToFile(ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImGuiHexEditorExportFormat format, const char* filename,
+	ImGuiHexEditorClipboardFlags flags, int bytes_per_line)
+{
+#ifndef IMGUI_DISABLE_FILE_FUNCTIONS
+	ImFileHandle file = ImFileOpen(filename, "wb");
+	if (!file)
+		return false;
 
-	state->SelectStartByte = next_select_start_byte;
-	state->SelectStartSubByte = next_select_start_subbyte;
-	state->SelectEndByte = next_select_end_byte;
-	state->SelectEndSubByte = next_select_end_subbyte;	
-	state->LastSelectedByte = next_last_selected_byte;
-	state->SelectDragByte = next_select_drag_byte;
-	state->SelectDragSubByte = next_select_drag_subbyte;
+	const bool exported = ExportHexEditorBytes(state, from, to, format, WriteExportFile, file, flags, bytes_per_line);
+	return ImFileClose(file) && exported;
+#else
+	IM_UNUSED(state);
+	IM_UNUSED(from);
+	IM_UNUSED(to);
+	IM_UNUSED(format);
+	IM_UNUSED(filename);
+	IM_UNUSED(flags);
+	IM_UNUSED(bytes_per_line);
+	return false;
+#endif
+}
 
-	if (line_buf != stack_line_buf)
-		ImGui::MemFree(line_buf);
+bool ImGui::CopyHexEditorBytes(ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImGuiHexEditorExportFormat format,
+	ImGuiHexEditorClipboardFlags flags, int bytes_per_line)
+{
+	// The clipboard holds zero terminated text
+	if (format == ImGuiHexEditorExportFormat_Binary)
+		return false;
 
-	if (address_buf != stack_address_buf)
-		ImGui::MemFree(address_buf);
-	
+	ImVector<char> text;
+	if (!ExportHexEditorBytes(state, from, to, format, AppendExportText, &text, flags, bytes_per_line))
+		return false;
+
+	text.push_back('\0');
+	ImGui::SetClipboardText(text.Data);
 	return true;
 }
 
-void ImGui::EndHexEditor()
+bool ImGui::DecodeHexEditorPasteText(ImVector<unsigned char>* out_bytes, ImGuiHexEditorPasteFormat format, const char* text, int text_size)
 {
-	ImGui::EndChild();
+	if (text_size < 0)
+		text_size = (int)strlen(text);
+
+	switch (format)
+	{
+	case ImGuiHexEditorPasteFormat_Auto:
+		if (DecodePasteHex(out_bytes, text, text_size) && out_bytes->Size != 0)
+			return true;
+		return DecodeHexEditorPasteText(out_bytes, ImGuiHexEditorPasteFormat_Text, text, text_size);
+	case ImGuiHexEditorPasteFormat_Text:
+		out_bytes->resize(text_size);
+		memcpy(out_bytes->Data, text, (size_t)text_size);
+		return true;
+	case ImGuiHexEditorPasteFormat_Hex:
+		return DecodePasteHex(out_bytes, text, text_size);
+	case ImGuiHexEditorPasteFormat_Base64:
+		return DecodePasteBase64(out_bytes, text, text_size);
+	}
+
+	IM_ASSERT(0 && "Unknown paste format");
+	return false;
 }
 
-bool ImGui::CalcHexEditorRowRange(int row_offset, int row_bytes_count, int range_min, int range_max, int* out_min, int* out_max)
+ImS64 ImGui::PasteHexEditorBytes(ImGuiHexEditorState* state, ImS64 offset, const char* text, ImGuiHexEditorPasteFormat format, bool insert)
 {
-	int abs_min;
-	int abs_max;
+	ImVector<unsigned char> bytes;
+	if (!text || !DecodeHexEditorPasteText(&bytes, format, text))
+		return -1;
 
-	if (RangeRangeIntersection(row_offset, row_offset + row_bytes_count, range_min, range_max, &abs_min, &abs_max))
+	if (bytes.Size == 0)
+		return 0;
+
+	if (insert)
 	{
-		*out_min = abs_min - row_offset;
-		*out_max = abs_max - row_offset;
-		return true;
+		IM_ASSERT(state->EditBuffer && "Inserting needs an edit buffer");
+		if (!state->EditBuffer)
+			return 0;
+
+		InsertHexEditorBytes(state->EditBuffer, offset, bytes.Data, bytes.Size);
+		return bytes.Size;
 	}
 
-	return false;
+	const ImS64 size = ImMin((ImS64)bytes.Size, GetSourceSize(state) - offset);
+	if (size <= 0)
+		return 0;
+
+	return WriteBytes(state, offset, bytes.Data, size);
 }
\ No newline at end of file
@@ -1,6 +1,19 @@
 #pragma once
 #include <imgui.h>
 
+// ImGuiListClipper and window scrolling work with int item counts and float positions, so sources with more lines than this
+// are scrolled through a sliding window of lines which is moved as the scroll position approaches its edges. The window
+// is small enough for its positions to stay below 2^24 with lines of up to 64 pixels, past which floats lose whole pixels.
+#ifndef IMGUI_HEX_EDITOR_MAX_SCROLL_LINES
+#define IMGUI_HEX_EDITOR_MAX_SCROLL_LINES (1 << 18)
+#endif
+
+// The SSE2 code paths are used wherever the target has SSE2. Define to build the scalar code only
+//#define IMGUI_HEX_EDITOR_DISABLE_SSE2
+
+// Define to record ImGuiHexEditorState::Stats every frame, see ImGui::ShowHexEditorStatsWindow(). Compiled out otherwise
+//#define IMGUI_HEX_EDITOR_ENABLE_STATS
+
 enum ImGuiHexEditorHighlightFlags_ : int
 {
 	ImGuiHexEditorHighlightFlags_None = 0,
@@ -17,8 +30,8 @@ typedef int ImGuiHexEditorHighlightFlags; // -> enum ImGuiHexEditorHighlightFlag
 
 struct ImGuiHexEditorHighlightRange
 {
-	int From;
-	int To;
+	ImS64 From;
+	ImS64 To;
 	ImColor Color;
 	ImColor BorderColor;
 	ImGuiHexEditorHighlightFlags Flags;
@@ -28,15 +41,215 @@ enum ImGuiHexEditorClipboardFlags_ : int
 {
 	ImGuiHexEditorClipboardFlags_None = 0,
 	ImGuiHexEditorClipboardFlags_Multiline = 1 << 0, // Separate resulting hex editor lines with carriage return
+	ImGuiHexEditorClipboardFlags_PasteInsert = 1 << 1, // Ctrl+V inserts at the cursor instead of overwriting, needs an edit buffer
 };
 
 typedef int ImGuiHexEditorClipboardFlags; // -> enum ImGuiHexEditorClipboardFlags_
 
+enum ImGuiHexEditorExportFormat_ : int
+{
+	ImGuiHexEditorExportFormat_Hex, // "DE AD BE EF"
+	ImGuiHexEditorExportFormat_HexDump, // Address, hex and ascii columns
+	ImGuiHexEditorExportFormat_Binary, // Raw bytes, can't be copied to the clipboard
+	ImGuiHexEditorExportFormat_CArray, // "unsigned char data[4] = { 0xDE, 0xAD, 0xBE, 0xEF };"
+	ImGuiHexEditorExportFormat_Base64, // Written as a single line
+	ImGuiHexEditorExportFormat_PythonBytes, // b"\xDE\xAD\xBE\xEF"
+};
+
+typedef int ImGuiHexEditorExportFormat; // -> enum ImGuiHexEditorExportFormat_
+
+enum ImGuiHexEditorPasteFormat_ : int
+{
+	ImGuiHexEditorPasteFormat_Auto, // Hex if the text is valid hex, text otherwise
+	ImGuiHexEditorPasteFormat_Hex, // Pairs of hex digits separated by whitespace or commas, 0x prefixes are allowed: "0xDE, 0xAD" or "DEAD BEEF"
+	ImGuiHexEditorPasteFormat_Text, // Bytes of the text itself
+	ImGuiHexEditorPasteFormat_Base64, // Whitespace is ignored
+};
+
+typedef int ImGuiHexEditorPasteFormat; // -> enum ImGuiHexEditorPasteFormat_
+
+enum ImGuiHexEditorCellFormat_ : int
+{
+	ImGuiHexEditorCellFormat_Hex, // "DE"
+	ImGuiHexEditorCellFormat_Binary, // "11011110"
+	ImGuiHexEditorCellFormat_Octal, // "336"
+	ImGuiHexEditorCellFormat_Unsigned, // "222", not editable
+	ImGuiHexEditorCellFormat_Signed, // " -34", not editable
+	ImGuiHexEditorCellFormat_Hex16, // "DEAD" for the bytes DE AD when big endian
+	ImGuiHexEditorCellFormat_Hex32,
+	ImGuiHexEditorCellFormat_Hex64,
+	ImGuiHexEditorCellFormat_Float32, // Not editable
+	ImGuiHexEditorCellFormat_Float64, // Not editable
+	ImGuiHexEditorCellFormat_COUNT,
+};
+
+typedef int ImGuiHexEditorCellFormat; // -> enum ImGuiHexEditorCellFormat_
+
+// Receives the exported text piece by piece, returns false to stop the export
+typedef bool(*ImGuiHexEditorExportCallback)(void* user_data, const char* data, int size);
+
+struct ImGuiHexEditorPageCache; // Opaque, see ImGui::CreateHexEditorPageCache()
+struct ImGuiHexEditorRowCache; // Opaque, see ImGui::CreateHexEditorRowCache()
+struct ImGuiHexEditorFile; // Opaque, see ImGui::OpenHexEditorFile()
+struct ImGuiHexEditorEditBuffer; // Opaque, see ImGui::CreateHexEditorEditBuffer()
+struct ImGuiHexEditorSearch; // Opaque, see ImGui::StartHexEditorSearch()
+struct ImGuiHexEditorStatistics; // Opaque, see ImGui::StartHexEditorStatistics()
+struct ImGuiHexEditorMinimap; // Opaque, see ImGui::StartHexEditorMinimap()
+struct ImGuiHexEditorWatch; // Opaque, see ImGui::StartHexEditorWatch()
+struct ImGuiHexEditorWriteQueue; // Opaque, see ImGui::StartHexEditorWriteQueue()
+struct ImGuiHexEditorDiff; // Opaque, see ImGui::StartHexEditorDiff()
+struct ImGuiHexEditorTemplate; // Opaque, see ImGui::CreateHexEditorTemplate()
+struct ImGuiHexEditorDataInspector; // Opaque, see ImGui::CreateHexEditorDataInspector()
+
+enum ImGuiHexEditorFileFlags_ : int
+{
+	ImGuiHexEditorFileFlags_None = 0,
+	ImGuiHexEditorFileFlags_CopyOnWrite = 1 << 0, // Map the file copy-on-write so it can be edited, changes are never written to the file itself
+};
+
+typedef int ImGuiHexEditorFileFlags; // -> enum ImGuiHexEditorFileFlags_
+
+enum ImGuiHexEditorSearchType_ : int
+{
+	ImGuiHexEditorSearchType_Hex, // Pairs of hex digits, whitespace is ignored and '?' matches any nibble: "DE AD ?? EF"
+	ImGuiHexEditorSearchType_Ascii,
+	ImGuiHexEditorSearchType_Utf16, // Text is given as UTF-8
+	ImGuiHexEditorSearchType_S8, // Values are parsed from decimal text, or hex with a 0x prefix
+	ImGuiHexEditorSearchType_U8,
+	ImGuiHexEditorSearchType_S16,
+	ImGuiHexEditorSearchType_U16,
+	ImGuiHexEditorSearchType_S32,
+	ImGuiHexEditorSearchType_U32,
+	ImGuiHexEditorSearchType_S64,
+	ImGuiHexEditorSearchType_U64,
+	ImGuiHexEditorSearchType_Float,
+	ImGuiHexEditorSearchType_Double,
+};
+
+typedef int ImGuiHexEditorSearchType; // -> enum ImGuiHexEditorSearchType_
+
+enum ImGuiHexEditorSearchFlags_ : int
+{
+	ImGuiHexEditorSearchFlags_None = 0,
+	ImGuiHexEditorSearchFlags_BigEndian = 1 << 0, // Byte order of UTF-16 text and values
+};
+
+typedef int ImGuiHexEditorSearchFlags; // -> enum ImGuiHexEditorSearchFlags_
+
+enum ImGuiHexEditorDiffFlags_ : int
+{
+	ImGuiHexEditorDiffFlags_None = 0, // Bytes are compared at the same offsets
+	ImGuiHexEditorDiffFlags_Align = 1 << 0, // Find inserted and deleted bytes and line the sources up again after them
+};
+
+typedef int ImGuiHexEditorDiffFlags; // -> enum ImGuiHexEditorDiffFlags_
+
+enum ImGuiHexEditorFieldType_ : int
+{
+	ImGuiHexEditorFieldType_S8,
+	ImGuiHexEditorFieldType_U8,
+	ImGuiHexEditorFieldType_S16,
+	ImGuiHexEditorFieldType_U16,
+	ImGuiHexEditorFieldType_S32,
+	ImGuiHexEditorFieldType_U32,
+	ImGuiHexEditorFieldType_S64,
+	ImGuiHexEditorFieldType_U64,
+	ImGuiHexEditorFieldType_Float,
+	ImGuiHexEditorFieldType_Double,
+	ImGuiHexEditorFieldType_Char, // Arrays of them are shown as text
+	ImGuiHexEditorFieldType_Pointer32, // See ImGui::AddHexEditorTemplatePointer()
+	ImGuiHexEditorFieldType_Pointer64,
+	ImGuiHexEditorFieldType_COUNT, // Struct types returned by ImGui::AddHexEditorTemplateStruct() follow
+};
+
+typedef int ImGuiHexEditorFieldType; // -> enum ImGuiHexEditorFieldType_
+
+enum ImGuiHexEditorFieldFlags_ : int
+{
+	ImGuiHexEditorFieldFlags_None = 0,
+	ImGuiHexEditorFieldFlags_BigEndian = 1 << 0,
+	ImGuiHexEditorFieldFlags_Hex = 1 << 1, // Integers are shown as hex
+};
+
+typedef int ImGuiHexEditorFieldFlags; // -> enum ImGuiHexEditorFieldFlags_
+
+struct ImGuiHexEditorDiffHunk
+{
+	ImS64 From[2]; // First differing byte of each source
+	ImS64 Size[2]; // 0 on the side the bytes of the other one were inserted into
+};
+
+struct ImGuiHexEditorSearchPattern
+{
+	ImVector<unsigned char> Bytes;
+	ImVector<unsigned char> Mask; // Bits of Bytes which have to match, 0 for wildcards
+};
+
+struct ImGuiHexEditorPageCacheConfig
+{
+	int PageSize = 64 * 1024; // Must be a power of two
+	ImS64 BudgetBytes = 64 * 1024 * 1024; // Memory kept by resident pages, least recently used pages are reused first
+	int PrefetchPages = 4; // Pages requested ahead of and behind the visible range
+	ImS64 MaxReadSize = 1024 * 1024; // Adjacent queued pages are loaded by a single ReadCallback call of up to this many bytes
+	void* UserData = nullptr;
+
+	// Called from the prefetch thread, search and statistics threads, and the calling thread for blocking reads such as clipboard copies. May block
+	ImS64(*ReadCallback)(void* user_data, ImS64 offset, void* buf, ImS64 size) = nullptr;
+};
+
+struct ImGuiHexEditorWatchConfig
+{
+	float PollInterval = 0.1f; // Seconds between two polls of the watched bytes
+	float FadeTime = 1.f; // Seconds a changed byte stays highlighted
+	ImS64 MaxReadSize = 1024 * 1024; // Watched ranges are read in batches of up to this many bytes
+	ImColor Color = ImColor(0.9f, 0.3f, 0.2f);
+	ImGuiHexEditorHighlightFlags HighlightFlags = ImGuiHexEditorHighlightFlags_Apply | ImGuiHexEditorHighlightFlags_Ascii;
+};
+
+struct ImGuiHexEditorWriteQueueConfig
+{
+	float FlushInterval = 0.05f; // Seconds between two flushes of the queued writes, negative to only flush on ImGui::FlushHexEditorWriteQueue()
+	int MaxRetries = 2; // Flushes a range is written again on before it's reported as failed
+	ImS64 MaxWriteSize = 1024 * 1024; // Ranges are written in calls of up to this many bytes
+	ImColor PendingColor = ImColor(0.9f, 0.7f, 0.2f);
+	ImColor FailedColor = ImColor(0.9f, 0.2f, 0.2f);
+	ImGuiHexEditorHighlightFlags HighlightFlags = ImGuiHexEditorHighlightFlags_Apply | ImGuiHexEditorHighlightFlags_Ascii;
+};
+
+struct ImGuiHexEditorWriteFailure
+{
+	ImS64 From;
+	ImS64 Size;
+};
+
+// Work done by the last BeginHexEditor() call, times are in milliseconds
+struct ImGuiHexEditorStats
+{
+	int Rows = 0;
+	int CachedRows = 0; // Rows copied from ImGuiHexEditorState::RowCache
+	ImS64 Bytes = 0; // Bytes drawn
+	int SourceReads = 0; // Blocking reads of the source: ReadCallback, page cache ReadCallback, mapped file or Bytes copies
+	ImS64 SourceReadBytes = 0;
+	float SourceReadTime = 0.f;
+	int HighlightRangeTests = 0;
+	int SingleHighlightCalls = 0;
+	int HighlightRangesCalls = 0; // Calls of HighlightRangesCallback, one per clipper step
+	int Vertices = 0; // Added to the window draw list
+	int Indices = 0;
+	float InputTime = 0.f; // Keyboard and clipboard handling
+	float ReadTime = 0.f; // Fetching the bytes of every row
+	float DecorationTime = 0.f; // Highlights, selection and queueing of the text of every byte
+	float TextTime = 0.f; // Addresses and emitting the queued text
+	float TotalTime = 0.f;
+};
+
 struct ImGuiHexEditorState
 {
 	void* Bytes;
-	int MaxBytes;
-	int BytesPerLine = -1;
+	ImS64 MaxBytes;
+	int BytesPerLine = -1; // Rounded down to a multiple of the cell size, -1 to fit the available width
+	ImGuiHexEditorCellFormat CellFormat = ImGuiHexEditorCellFormat_Hex;
+	bool BigEndianCells = false; // Byte order of the multi-byte cell formats
 	bool ShowPrintable = false;
 	bool LowercaseBytes = false;
 	bool RenderZeroesDisabled = true;
@@ -44,28 +257,73 @@ struct ImGuiHexEditorState
 	int AddressChars = -1;
 	bool ShowAscii = true;
 	bool ReadOnly = false;
-	int Separators = 8;
+	int Separators = 8; // Bytes between two separators, rounded up to whole cells. 0 to disable
 	void* UserData = nullptr;
+	ImGuiHexEditorPageCache* PageCache = nullptr; // When set, rendering only uses resident pages and never waits for the source. See ImGui::SetHexEditorPageCache()
+	ImGuiHexEditorRowCache* RowCache = nullptr; // When set, rows whose bytes and highlights didn't change are copied from previous frames
+	ImGuiHexEditorFile* File = nullptr; // Memory mapped file rendered in place, overrides Bytes and MaxBytes
+	ImGuiHexEditorEditBuffer* EditBuffer = nullptr; // Records edits on top of the source instead of writing them, overrides MaxBytes. See ImGui::CommitHexEditorEdits()
 	ImVector<ImGuiHexEditorHighlightRange> HighlightRanges;
+	int HighlightRangesVersion = -1; // Increment on every change of HighlightRanges to skip comparing them every frame, -1 to always compare
 	bool EnableClipboard = true;
 	ImGuiHexEditorClipboardFlags ClipboardFlags = ImGuiHexEditorClipboardFlags_Multiline;
+	ImGuiHexEditorExportFormat ClipboardFormat = ImGuiHexEditorExportFormat_Hex; // Format of the selection copied with Ctrl+C
+	ImGuiHexEditorPasteFormat PasteFormat = ImGuiHexEditorPasteFormat_Auto; // Format of the clipboard text pasted with Ctrl+V
+
+	ImS64(*ReadCallback)(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size) = nullptr;
+	ImS64(*WriteCallback)(ImGuiHexEditorState* state, ImS64 offset, void* buf, ImS64 size) = nullptr;
+	bool(*GetAddressNameCallback)(ImGuiHexEditorState* state, ImS64 offset, char* buf, int size) = nullptr;
+	ImGuiHexEditorHighlightFlags(*SingleHighlightCallback)(ImGuiHexEditorState* state, ImS64 offset, ImColor* color, ImColor* text_color, ImColor* border_color) = nullptr;
+	void(*HighlightRangesCallback)(ImGuiHexEditorState* state, ImS64 display_start, ImS64 display_end, ImVector<ImGuiHexEditorHighlightRange>* out_ranges) = nullptr; // Called once per clipper step with its bytes [display_start, display_end), the ranges pushed to out_ranges are drawn over HighlightRanges. Cheaper than SingleHighlightCallback, which is called for every visible byte
 
-	int(*ReadCallback)(ImGuiHexEditorState* state, int offset, void* buf, int size) = nullptr;
-	int(*WriteCallback)(ImGuiHexEditorState* state, int offset, void* buf, int size) = nullptr;
-	bool(*GetAddressNameCallback)(ImGuiHexEditorState* state, int offset, char* buf, int size) = nullptr;
-	ImGuiHexEditorHighlightFlags(*SingleHighlightCallback)(ImGuiHexEditorState* state, int offset, ImColor* color, ImColor* text_color, ImColor* border_color) = nullptr;
-	void(*HighlightRangesCallback)(ImGuiHexEditorState* state, int display_start, int display_end) = nullptr;
+#ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+	// Obsolete int based callbacks, only used when the matching 64-bit callback above is not set.
+	// Offsets that don't fit into an int are never passed to them, such bytes are treated as unreadable.
+	int(*ReadCallbackInt)(ImGuiHexEditorState* state, int offset, void* buf, int size) = nullptr;
+	int(*WriteCallbackInt)(ImGuiHexEditorState* state, int offset, void* buf, int size) = nullptr;
+	bool(*GetAddressNameCallbackInt)(ImGuiHexEditorState* state, int offset, char* buf, int size) = nullptr;
+	ImGuiHexEditorHighlightFlags(*SingleHighlightCallbackInt)(ImGuiHexEditorState* state, int offset, ImColor* color, ImColor* text_color, ImColor* border_color) = nullptr;
+#endif
 
-	int SelectStartByte = -1;
+	ImS64 SelectStartByte = -1;
 	int SelectStartSubByte = 0;
-	int SelectEndByte = -1;
+	ImS64 SelectEndByte = -1;
 	int SelectEndSubByte = 0;
-	int LastSelectedByte = -1;
-	int SelectDragByte = -1;
+	ImS64 LastSelectedByte = -1;
+	ImS64 SelectDragByte = -1;
 	int SelectDragSubByte = 0;
 	float SelectCursorAnimationTime = 0.f;
 
+	ImS64 ScrollBaseLine = 0; // First line of the scrollable window, see IMGUI_HEX_EDITOR_MAX_SCROLL_LINES
+	ImS64 ScrollToByte = -1; // Set to scroll a byte into view on the next frame
+
+	ImGuiHexEditorSearch* Search = nullptr; // Running or finished search, results are streamed into SearchResults
+	ImVector<ImS64> SearchResults; // Offsets of the matches found so far, ascending
+	ImGuiHexEditorHighlightFlags SearchHighlightFlags = ImGuiHexEditorHighlightFlags_Ascii | ImGuiHexEditorHighlightFlags_Border;
+	ImGuiHexEditorDiff* Diff = nullptr; // Set by ImGui::StartHexEditorDiff(), bytes differing from the other source are highlighted
+	ImGuiHexEditorHighlightFlags DiffHighlightFlags = ImGuiHexEditorHighlightFlags_Ascii;
+	ImGuiHexEditorStatistics* Statistics = nullptr;
+	ImGuiHexEditorMinimap* Minimap = nullptr; // Summary of the whole source drawn by ImGui::ShowHexEditorMinimap()
+	ImGuiHexEditorTemplate* Template = nullptr; // Compiled template, its fields are highlighted and name the rows GetAddressNameCallback doesn't
+	ImGuiHexEditorHighlightFlags TemplateHighlightFlags = ImGuiHexEditorHighlightFlags_Ascii;
+	ImGuiHexEditorDataInspector* DataInspector = nullptr; // Decoded values of the bytes at the cursor, see ImGui::ShowHexEditorDataInspector()
+	ImGuiHexEditorWatch* Watch = nullptr; // Polled copy of the visible and watched bytes, changed bytes are highlighted. See ImGui::StartHexEditorWatch()
+	ImGuiHexEditorWriteQueue* WriteQueue = nullptr; // Writes flushed by a thread, queued and failed bytes are highlighted. See ImGui::StartHexEditorWriteQueue()
+	int JobThreads = 0; // Threads splitting searches and statistics between them, 0 for one per core
+
+	ImGuiHexEditorStats Stats; // Only recorded when IMGUI_HEX_EDITOR_ENABLE_STATS is defined
+
+	// Interval index over HighlightRanges, rebuilt when they change
+	ImVector<int> HighlightRangesOrder; // Indices sorted by From
+	ImVector<ImS64> HighlightRangesMaxTo; // Max To of every implicit subtree, rooted at the middle of the sorted order
+	ImU64 HighlightRangesHash = 0;
+	int HighlightRangesIndexedVersion = -1;
+
 	ImGuiHexEditorHighlightFlags SelectionHighlightFlags = ImGuiHexEditorHighlightFlags_FullSized | ImGuiHexEditorHighlightFlags_Ascii;
+
+	int DisplayBytesPerLine = 0; // Bytes per line of the last BeginHexEditor() call, BytesPerLine or the automatic count
+	ImS64 DisplayStartByte = 0; // Visible bytes [DisplayStartByte, DisplayEndByte) of the last BeginHexEditor() call
+	ImS64 DisplayEndByte = 0;
 };
 
 namespace ImGui
@@ -75,5 +333,155 @@ namespace ImGui
 
 	// Helpers
 
-	bool CalcHexEditorRowRange(int row_offset, int row_bytes_count, int range_min, int range_max, int* out_min, int* out_max);
+	bool CalcHexEditorRowRange(ImS64 row_offset, int row_bytes_count, ImS64 range_min, ImS64 range_max, int* out_min, int* out_max);
+	void ShowHexEditorStatsWindow(ImGuiHexEditorState* state, bool* p_open = nullptr);
+
+	// Page cache, reference counted so the states of several editors viewing the same source can share it and read
+	// every page once. Blocking reads of any of them are served from the resident pages first
+
+	ImGuiHexEditorPageCache* CreateHexEditorPageCache(const ImGuiHexEditorPageCacheConfig& config); // Holds one reference
+	void DestroyHexEditorPageCache(ImGuiHexEditorPageCache* cache); // Releases one reference, the last one destroys the cache
+	ImGuiHexEditorPageCache* AddHexEditorPageCacheRef(ImGuiHexEditorPageCache* cache); // Returns cache
+	void SetHexEditorPageCache(ImGuiHexEditorState* state, ImGuiHexEditorPageCache* cache); // Takes a reference of cache and releases the one of the previous cache, nullptr to detach
+	void InvalidateHexEditorPageCache(ImGuiHexEditorPageCache* cache, ImS64 offset = 0, ImS64 size = -1); // size -1 drops every page
+
+	// Row cache, keeps the vertices and text of up to max_rows rows between frames. Rows under the mouse or the cursor and
+	// rows of states with a SingleHighlightCallback are always rebuilt. Use one cache per editor
+
+	ImGuiHexEditorRowCache* CreateHexEditorRowCache(int max_rows = 256);
+	void DestroyHexEditorRowCache(ImGuiHexEditorRowCache* cache);
+	void InvalidateHexEditorRowCache(ImGuiHexEditorRowCache* cache, ImS64 offset = 0, ImS64 size = -1); // size -1 drops every row
+
+	// Memory mapped files, mapped in windows of window_size bytes so files larger than the address space can be viewed
+
+	ImGuiHexEditorFile* OpenHexEditorFile(const char* filename, ImGuiHexEditorFileFlags flags = 0, ImS64 window_size = 64 * 1024 * 1024); // Returns nullptr on failure
+	void CloseHexEditorFile(ImGuiHexEditorFile* file);
+	ImS64 GetHexEditorFileSize(ImGuiHexEditorFile* file);
+
+	// Edit buffer, a piece table over the source with unlimited undo/redo. Every edit is its own undo step unless
+	// it's made between BeginHexEditorEditGroup()/EndHexEditorEditGroup()
+
+	ImGuiHexEditorEditBuffer* CreateHexEditorEditBuffer(ImS64 original_size);
+	void DestroyHexEditorEditBuffer(ImGuiHexEditorEditBuffer* buffer);
+	ImS64 GetHexEditorEditBufferSize(ImGuiHexEditorEditBuffer* buffer);
+	void InsertHexEditorBytes(ImGuiHexEditorEditBuffer* buffer, ImS64 offset, const void* data, ImS64 size);
+	void DeleteHexEditorBytes(ImGuiHexEditorEditBuffer* buffer, ImS64 offset, ImS64 size);
+	void OverwriteHexEditorBytes(ImGuiHexEditorEditBuffer* buffer, ImS64 offset, const void* data, ImS64 size);
+	void BeginHexEditorEditGroup(ImGuiHexEditorEditBuffer* buffer);
+	void EndHexEditorEditGroup(ImGuiHexEditorEditBuffer* buffer);
+	bool UndoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer);
+	bool RedoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer);
+	bool CanUndoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer);
+	bool CanRedoHexEditorEdit(ImGuiHexEditorEditBuffer* buffer);
+	bool CommitHexEditorEdits(ImGuiHexEditorState* state, ImS64 batch_size = 1024 * 1024); // Writes the changes to the source in batches of up to batch_size bytes and clears the history. Returns false on failure: the buffer still shows the same bytes and calling again writes the rest, the history is cleared once anything was written
+
+	// Search and statistics, processed in chunks by JobThreads threads which read the source (and ReadCallback) concurrently
+	// with rendering. F3/Shift+F3 in the editor select the next/previous match.
+	// ClearHexEditorSearch() and ClearHexEditorStatistics() must be called before the state is destroyed
+
+	bool ParseHexEditorSearchPattern(ImGuiHexEditorSearchPattern* out_pattern, ImGuiHexEditorSearchType type, const char* text, ImGuiHexEditorSearchFlags flags = 0); // Returns false if text can't be parsed as type
+	void StartHexEditorSearch(ImGuiHexEditorState* state, const ImGuiHexEditorSearchPattern& pattern, ImS64 from = 0, ImS64 to = -1, int max_results = 1024 * 1024); // to -1 searches up to MaxBytes
+	void CancelHexEditorSearch(ImGuiHexEditorState* state); // Stops the search, keeping the results found so far
+	void ClearHexEditorSearch(ImGuiHexEditorState* state);
+	bool IsHexEditorSearchRunning(ImGuiHexEditorState* state);
+	float GetHexEditorSearchProgress(ImGuiHexEditorState* state);
+	bool SelectNextHexEditorSearchResult(ImGuiHexEditorState* state, bool backwards = false); // Selects the match after (or before) the cursor and scrolls to it
+	void StartHexEditorStatistics(ImGuiHexEditorState* state, ImS64 from = 0, ImS64 to = -1);
+	void ClearHexEditorStatistics(ImGuiHexEditorState* state);
+	bool IsHexEditorStatisticsRunning(ImGuiHexEditorState* state);
+	float GetHexEditorStatisticsProgress(ImGuiHexEditorState* state);
+	void GetHexEditorByteHistogram(ImGuiHexEditorState* state, ImU64 out_histogram[256]); // Occurrences of every byte value counted so far
+
+	// Watch mode, for sources changing on their own such as process memory. A thread polls the visible lines and the added
+	// ranges of the source every PollInterval, visible lines are drawn from the polled copy and bytes which changed fade out
+	// over FadeTime. Edits of an EditBuffer aren't watched. StopHexEditorWatch() must be called before the state is destroyed
+
+	void StartHexEditorWatch(ImGuiHexEditorState* state, const ImGuiHexEditorWatchConfig& config = ImGuiHexEditorWatchConfig());
+	void StopHexEditorWatch(ImGuiHexEditorState* state);
+	void AddHexEditorWatchRange(ImGuiHexEditorState* state, ImS64 from, ImS64 to); // Bytes [from, to], watched even when not visible
+	void ClearHexEditorWatchRanges(ImGuiHexEditorState* state);
+
+	// Write queue, for sources with slow writes such as process memory. Bytes written through the editor are merged into
+	// ranges, read back from the queue and written by a thread every FlushInterval. Ranges still failing after MaxRetries
+	// flushes keep their bytes and stay highlighted until retried or cleared. Edits of an EditBuffer aren't queued, and
+	// neither are writes to Bytes or mapped files, which are read in place while rendering.
+	// StopHexEditorWriteQueue() must be called before the state is destroyed
+
+	void StartHexEditorWriteQueue(ImGuiHexEditorState* state, const ImGuiHexEditorWriteQueueConfig& config = ImGuiHexEditorWriteQueueConfig());
+	void StopHexEditorWriteQueue(ImGuiHexEditorState* state); // Flushes the queued writes first
+	void FlushHexEditorWriteQueue(ImGuiHexEditorState* state, bool wait = false); // wait blocks until every queued range is written or failed
+	ImS64 GetHexEditorQueuedWriteBytes(ImGuiHexEditorState* state); // Bytes waiting to be written, failed ranges excluded
+	void GetHexEditorWriteFailures(ImGuiHexEditorState* state, ImVector<ImGuiHexEditorWriteFailure>* out_failures);
+	void RetryHexEditorWriteFailures(ImGuiHexEditorState* state); // Queues the failed ranges again
+	void ClearHexEditorWriteFailures(ImGuiHexEditorState* state); // Drops the failed ranges, their bytes are read from the source again
+
+	// Diff of the sources of two states, computed by a background thread reading both in large chunks. Hunks are published
+	// as they are found, ShowHexEditorDiff() draws both editors side by side with their scrolling lined up, F7/Shift+F7
+	// select the next/previous hunk. Edits of an EditBuffer aren't compared. DestroyHexEditorDiff() must be called before
+	// either state is destroyed
+
+	ImGuiHexEditorDiff* StartHexEditorDiff(ImGuiHexEditorState* state_a, ImGuiHexEditorState* state_b, ImGuiHexEditorDiffFlags flags = ImGuiHexEditorDiffFlags_Align,
+		int block_size = 32, ImS64 lookahead = 1024 * 1024); // Inserted or deleted runs are found when they are shorter than lookahead
+	void DestroyHexEditorDiff(ImGuiHexEditorDiff* diff);
+	bool IsHexEditorDiffRunning(ImGuiHexEditorDiff* diff);
+	float GetHexEditorDiffProgress(ImGuiHexEditorDiff* diff);
+	const ImVector<ImGuiHexEditorDiffHunk>& GetHexEditorDiffHunks(ImGuiHexEditorDiff* diff); // Found so far, ascending in both sources
+	bool SelectNextHexEditorDiffHunk(ImGuiHexEditorDiff* diff, bool backwards = false); // Selects the hunk after (or before) the cursor in both states
+	void ShowHexEditorDiff(const char* str_id, ImGuiHexEditorDiff* diff, const ImVec2& size = { 0.f, 0.f });
+
+	// Templates describe structs as fields laid out one after another in the order they're added. Compiling places a type
+	// at an offset of the source and expands it into a flat table of every field instance sorted by offset, which the
+	// editor, the inspector and GetHexEditorTemplateFieldName() binary search. Pointers are followed while compiling:
+	// their value minus pointer_base is the offset of their target, read from the source. Recompile after the layout
+	// or the pointed bytes change
+
+	ImGuiHexEditorTemplate* CreateHexEditorTemplate();
+	void DestroyHexEditorTemplate(ImGuiHexEditorTemplate* tpl);
+	ImGuiHexEditorFieldType AddHexEditorTemplateStruct(ImGuiHexEditorTemplate* tpl, const char* name); // Returns the type of the new empty struct
+	void AddHexEditorTemplateField(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType struct_type, const char* name, ImGuiHexEditorFieldType type, int count = 1,
+		ImGuiHexEditorFieldFlags flags = 0, ImU32 color = 0); // name nullptr for padding, color 0 picks one
+	void AddHexEditorTemplatePointer(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorFieldType struct_type, const char* name, ImGuiHexEditorFieldType pointer_type,
+		ImGuiHexEditorFieldType target_type, int count = 1, ImGuiHexEditorFieldFlags flags = 0, ImU32 color = 0); // Null pointers and targets outside of the source aren't followed
+	int CompileHexEditorTemplate(ImGuiHexEditorTemplate* tpl, ImGuiHexEditorState* state, ImGuiHexEditorFieldType type, ImS64 offset, int count = 1,
+		ImS64 pointer_base = 0, int max_fields = 1 << 22); // Returns the number of field instances, -1 if a struct contains itself
+	bool GetHexEditorTemplateFieldName(ImGuiHexEditorTemplate* tpl, ImS64 offset, char* buf, int size); // Path of the innermost field at offset: "header.entries[3].size+2"
+	void ShowHexEditorTemplateInspector(ImGuiHexEditorState* state); // Decoded fields of the struct around the cursor, clicking one selects it
+
+	// Data inspector, decodes the bytes at LastSelectedByte as integers and floats of both byte orders, time_t, GUID, LEB128
+	// and UTF-8/UTF-16 text. They are read at once and decoded again only after the cursor moves, the editor writes, the
+	// edit buffer or the watched bytes change, or every refresh_interval seconds unless it's 0. Reads never wait for the
+	// page cache, bytes of pages still loading are read again on the next frame
+
+	ImGuiHexEditorDataInspector* CreateHexEditorDataInspector(float refresh_interval = 0.f);
+	void DestroyHexEditorDataInspector(ImGuiHexEditorDataInspector* inspector);
+	void InvalidateHexEditorDataInspector(ImGuiHexEditorDataInspector* inspector); // Call after changing the source outside of the editor
+	void ShowHexEditorDataInspector(ImGuiHexEditorState* state); // Needs a DataInspector
+
+	// Minimap of the whole source: every block of block_size bytes is summarized by its entropy and its share of zeros and
+	// text, scanned in the background by JobThreads threads and merged pairwise into coarser levels, so any height is
+	// drawn from a few cells per pixel. Blocks written by the editor are scanned again, as is the whole source after it's
+	// resized or its edit buffer changes otherwise. Highlight ranges, search results and diff hunks are marked on the
+	// side, clicking or dragging scrolls the editor there. StopHexEditorMinimap() must be called before the state is destroyed
+
+	void StartHexEditorMinimap(ImGuiHexEditorState* state, int block_size = 4096); // Rounded up to a power of two of at least 256, larger for sources of more than 2M blocks
+	void StopHexEditorMinimap(ImGuiHexEditorState* state);
+	void InvalidateHexEditorMinimap(ImGuiHexEditorState* state, ImS64 offset = 0, ImS64 size = -1); // Call after changing the source outside of the editor, size -1 rescans everything
+	bool IsHexEditorMinimapRunning(ImGuiHexEditorState* state);
+	float GetHexEditorMinimapProgress(ImGuiHexEditorState* state);
+	void ShowHexEditorMinimap(const char* str_id, ImGuiHexEditorState* state, const ImVec2& size = { 0.f, 0.f }); // Next to the editor with SameLine(), a width of 0 is 3 characters and a height of 0 fills the window
+
+	// Export of the bytes [from, to], read and formatted in chunks so the range is never held in memory at once.
+	// Multiline output is split every bytes_per_line bytes. Return false if reading the source or writing failed
+
+	bool ExportHexEditorBytes(ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImGuiHexEditorExportFormat format, ImGuiHexEditorExportCallback callback, void* user_data,
+		ImGuiHexEditorClipboardFlags flags = ImGuiHexEditorClipboardFlags_Multiline, int bytes_per_line = 16);
+	bool ExportHexEditorBytesToFile(ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImGuiHexEditorExportFormat format, const char* filename,
+		ImGuiHexEditorClipboardFlags flags = ImGuiHexEditorClipboardFlags_Multiline, int bytes_per_line = 16);
+	bool CopyHexEditorBytes(ImGuiHexEditorState* state, ImS64 from, ImS64 to, ImGuiHexEditorExportFormat format,
+		ImGuiHexEditorClipboardFlags flags = ImGuiHexEditorClipboardFlags_Multiline, int bytes_per_line = 16); // To the clipboard
+
+	// Paste, decoded in a single pass and applied with a single write (or insert into the edit buffer)
+
+	bool DecodeHexEditorPasteText(ImVector<unsigned char>* out_bytes, ImGuiHexEditorPasteFormat format, const char* text, int text_size = -1); // Returns false if text isn't valid in format
+	ImS64 PasteHexEditorBytes(ImGuiHexEditorState* state, ImS64 offset, const char* text, ImGuiHexEditorPasteFormat format, bool insert = false); // Returns the number of bytes written, -1 if text can't be decoded
 }
\ No newline at end of file